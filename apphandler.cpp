@@ -23,6 +23,7 @@
 
 #include <phosphor-logging/log.hpp>
 #include <phosphor-logging/elog-errors.hpp>
+#include <sdbusplus/bus/match.hpp>
 #include "xyz/openbmc_project/Common/error.hpp"
 #include "xyz/openbmc_project/Software/Version/server.hpp"
 #include "xyz/openbmc_project/Software/Activation/server.hpp"
@@ -50,6 +51,11 @@ using Version = sdbusplus::xyz::openbmc_project::Software::server::Version;
 using Activation =
     sdbusplus::xyz::openbmc_project::Software::server::Activation;
 namespace fs = std::experimental::filesystem;
+namespace sdbusRule = sdbusplus::bus::match::rules;
+
+// Drop the cached GUID responses when the UUIDs they are made from change
+std::unique_ptr<sdbusplus::bus::match_t> deviceGuidMatch = nullptr;
+std::unique_ptr<sdbusplus::bus::match_t> systemGuidMatch = nullptr;
 
 // Offset in get device id command.
 typedef struct
@@ -93,7 +99,8 @@ std::string getActiveSoftwareVersionInfo()
     for (auto& softObject : objectTree)
     {
         auto service = ipmi::getService(bus, redundancyIntf, softObject.first);
-        auto objValueTree = ipmi::getManagedObjects(bus, service, softwareRoot);
+        auto objValueTree = ipmi::ManagedObjects::instance().objects(
+                                bus, service, softwareRoot);
 
         auto minPriority = 0xFF;
         for (const auto& objIter : objValueTree)
@@ -578,11 +585,12 @@ ipmi_ret_t ipmi_app_get_sys_guid(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
 void register_netfn_app_functions()
 {
     // <Get BT Interface Capabilities>
-    ipmi_register_callback(NETFUN_APP,
-                           IPMI_CMD_GET_CAP_BIT,
-                           NULL,
-                           ipmi_app_get_bt_capabilities,
-                           PRIVILEGE_USER);
+    ipmi_register_callback_flags(NETFUN_APP,
+                                 IPMI_CMD_GET_CAP_BIT,
+                                 NULL,
+                                 ipmi_app_get_bt_capabilities,
+                                 PRIVILEGE_USER,
+                                 IPMI_CMD_FLAG_CACHEABLE);
 
     // <Wildcard Command>
     ipmi_register_callback(NETFUN_APP,
@@ -592,11 +600,12 @@ void register_netfn_app_functions()
                            PRIVILEGE_USER);
 
     // <Reset Watchdog Timer>
-    ipmi_register_callback(NETFUN_APP,
-                           IPMI_CMD_RESET_WD,
-                           NULL,
-                           ipmi_app_watchdog_reset,
-                           PRIVILEGE_OPERATOR);
+    ipmi_register_callback_flags(NETFUN_APP,
+                                 IPMI_CMD_RESET_WD,
+                                 NULL,
+                                 ipmi_app_watchdog_reset,
+                                 PRIVILEGE_OPERATOR,
+                                 IPMI_CMD_FLAG_PRIORITY_CRITICAL);
 
     // <Set Watchdog Timer>
     ipmi_register_callback(NETFUN_APP,
@@ -613,11 +622,12 @@ void register_netfn_app_functions()
                            PRIVILEGE_OPERATOR);
 
     // <Get Device ID>
-    ipmi_register_callback(NETFUN_APP,
-                           IPMI_CMD_GET_DEVICE_ID,
-                           NULL,
-                           ipmi_app_get_device_id,
-                           PRIVILEGE_USER);
+    ipmi_register_callback_flags(NETFUN_APP,
+                                 IPMI_CMD_GET_DEVICE_ID,
+                                 NULL,
+                                 ipmi_app_get_device_id,
+                                 PRIVILEGE_USER,
+                                 IPMI_CMD_FLAG_CACHEABLE);
 
     // <Get Self Test Results>
     ipmi_register_callback(NETFUN_APP,
@@ -627,11 +637,12 @@ void register_netfn_app_functions()
                            PRIVILEGE_USER);
 
     // <Get Device GUID>
-    ipmi_register_callback(NETFUN_APP,
-                           IPMI_CMD_GET_DEVICE_GUID,
-                           NULL,
-                           ipmi_app_get_device_guid,
-                           PRIVILEGE_USER);
+    ipmi_register_callback_flags(NETFUN_APP,
+                                 IPMI_CMD_GET_DEVICE_GUID,
+                                 NULL,
+                                 ipmi_app_get_device_guid,
+                                 PRIVILEGE_USER,
+                                 IPMI_CMD_FLAG_CACHEABLE);
 
     // <Set ACPI Power State>
     ipmi_register_callback(NETFUN_APP,
@@ -655,18 +666,42 @@ void register_netfn_app_functions()
                            PRIVILEGE_USER);
 
     // <Get System GUID Command>
-    ipmi_register_callback(NETFUN_APP,
-                           IPMI_CMD_GET_SYS_GUID,
-                           NULL,
-                           ipmi_app_get_sys_guid,
-                           PRIVILEGE_USER);
+    ipmi_register_callback_flags(NETFUN_APP,
+                                 IPMI_CMD_GET_SYS_GUID,
+                                 NULL,
+                                 ipmi_app_get_sys_guid,
+                                 PRIVILEGE_USER,
+                                 IPMI_CMD_FLAG_CACHEABLE);
 
     // <Get Channel Cipher Suites Command>
-    ipmi_register_callback(NETFUN_APP,
-                           IPMI_CMD_GET_CHAN_CIPHER_SUITES,
-                           NULL,
-                           getChannelCipherSuites,
-                           PRIVILEGE_CALLBACK);
+    ipmi_register_callback_flags(NETFUN_APP,
+                                 IPMI_CMD_GET_CHAN_CIPHER_SUITES,
+                                 NULL,
+                                 getChannelCipherSuites,
+                                 PRIVILEGE_CALLBACK,
+                                 IPMI_CMD_FLAG_CACHEABLE);
+
+    sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
+    deviceGuidMatch = std::make_unique<sdbusplus::bus::match_t>(
+        bus,
+        sdbusRule::propertiesChanged("/org/openbmc/control/chassis0",
+                                     "org.openbmc.control.Chassis"),
+        [](sdbusplus::message::message& msg)
+        {
+            ipmi_invalidate_cached_responses(NETFUN_APP,
+                                             IPMI_CMD_GET_DEVICE_GUID);
+        });
+    systemGuidMatch = std::make_unique<sdbusplus::bus::match_t>(
+        bus,
+        sdbusRule::type::signal() +
+        sdbusRule::member("PropertiesChanged") +
+        sdbusRule::interface("org.freedesktop.DBus.Properties") +
+        sdbusRule::argN(0, bmc_guid_interface),
+        [](sdbusplus::message::message& msg)
+        {
+            ipmi_invalidate_cached_responses(NETFUN_APP,
+                                             IPMI_CMD_GET_SYS_GUID);
+        });
     return;
 }
 
@@ -0,0 +1,116 @@
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include "capture-file.hpp"
+
+namespace phosphor
+{
+namespace ipmi
+{
+namespace capture
+{
+
+static constexpr char magic[4] = {'I', 'P', 'M', 'C'};
+static constexpr uint16_t version = 1;
+
+Writer::~Writer()
+{
+    if (file)
+    {
+        fclose(file);
+    }
+}
+
+int Writer::open(const std::string& path)
+{
+    file = fopen(path.c_str(), "we");
+    if (file == nullptr)
+    {
+        return -errno;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    start = ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+
+    FileHeader header = {{magic[0], magic[1], magic[2], magic[3]},
+                         version, sizeof(RecordHeader)};
+    if (fwrite(&header, sizeof(header), 1, file) != 1 || fflush(file) != 0)
+    {
+        int r = -errno;
+        fclose(file);
+        file = nullptr;
+        return r;
+    }
+    return 0;
+}
+
+int Writer::write(RecordHeader record,
+                  const void* request, size_t requestLen,
+                  const void* response, size_t responseLen)
+{
+    if (file == nullptr)
+    {
+        return -EBADF;
+    }
+
+    record.requestLen = std::min<size_t>(requestLen, UINT8_MAX);
+    record.responseLen = std::min<size_t>(responseLen, UINT8_MAX);
+
+    if (fwrite(&record, sizeof(record), 1, file) != 1 ||
+        fwrite(request, 1, record.requestLen, file) != record.requestLen ||
+        fwrite(response, 1, record.responseLen, file) != record.responseLen ||
+        fflush(file) != 0)
+    {
+        return -errno;
+    }
+    return 0;
+}
+
+Reader::~Reader()
+{
+    if (file)
+    {
+        fclose(file);
+    }
+}
+
+int Reader::open(const std::string& path)
+{
+    file = fopen(path.c_str(), "re");
+    if (file == nullptr)
+    {
+        return -errno;
+    }
+
+    FileHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, magic, sizeof(magic)) != 0 ||
+        header.version != version ||
+        header.recordSize != sizeof(RecordHeader))
+    {
+        fclose(file);
+        file = nullptr;
+        return -EINVAL;
+    }
+    return 0;
+}
+
+bool Reader::next(RecordHeader& record, std::vector<uint8_t>& request,
+                  std::vector<uint8_t>& response)
+{
+    if (file == nullptr || fread(&record, sizeof(record), 1, file) != 1)
+    {
+        return false;
+    }
+
+    request.resize(record.requestLen);
+    response.resize(record.responseLen);
+    return fread(request.data(), 1, request.size(), file) == request.size() &&
+           fread(response.data(), 1, response.size(), file) == response.size();
+}
+
+} // namespace capture
+} // namespace ipmi
+} // namespace phosphor
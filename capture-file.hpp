@@ -0,0 +1,133 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+
+namespace phosphor
+{
+namespace ipmi
+{
+namespace capture
+{
+
+/** @detail A capture file holds the commands served by ipmid, in the order
+ *          their responses were sent, so they can be replayed offline with
+ *          ipmid-replay. It starts with a FileHeader, followed for each
+ *          command by a RecordHeader, the request data and the response
+ *          data. All fields are in host byte order.
+ */
+
+struct FileHeader
+{
+    char magic[4];          //!< "IPMC"
+    uint16_t version;       //!< 1
+    uint16_t recordSize;    //!< sizeof(RecordHeader)
+} __attribute__((packed));
+
+struct RecordHeader
+{
+    uint64_t timestamp;     //!< When the request was received, in
+                            //!< microseconds since the capture started
+    uint32_t handlerTime;   //!< Time spent in the handler, in microseconds
+    uint32_t totalTime;     //!< Time until the response was sent
+    uint8_t seq;            //!< Sequence number of the message
+    uint8_t netfn;
+    uint8_t lun;
+    uint8_t cmd;
+    uint8_t cc;             //!< Completion code of the response
+    uint8_t requestLen;     //!< Request bytes following this header
+    uint8_t responseLen;    //!< Response bytes following the request,
+                            //!< without the completion code
+} __attribute__((packed));
+
+/** @class Writer
+ *  @brief Appends commands to a capture file
+ */
+class Writer
+{
+    public:
+        Writer() = default;
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+        Writer(Writer&&) = delete;
+        Writer& operator=(Writer&&) = delete;
+        ~Writer();
+
+        /** @brief Creates the capture file, replacing any existing one
+         *
+         *  @param[in] path - file to write
+         *
+         *  @return 0 on success, negative errno on failure
+         */
+        int open(const std::string& path);
+
+        /** @brief Appends a command. Each record is flushed to the file
+         *         right away, so the capture survives ipmid being killed.
+         *
+         *  @param[in] record - header; the lengths are set from the data
+         *  @param[in] request - request data
+         *  @param[in] requestLen - request length
+         *  @param[in] response - response data, without completion code
+         *  @param[in] responseLen - response length
+         *
+         *  @return 0 on success, negative errno on failure
+         */
+        int write(RecordHeader record,
+                  const void* request, size_t requestLen,
+                  const void* response, size_t responseLen);
+
+        /** @brief Returns the time the capture started, CLOCK_MONOTONIC in
+         *         microseconds
+         */
+        inline uint64_t started() const
+        {
+            return start;
+        }
+
+    private:
+        FILE* file = nullptr;
+        uint64_t start = 0;
+};
+
+/** @class Reader
+ *  @brief Reads back the commands of a capture file
+ */
+class Reader
+{
+    public:
+        Reader() = default;
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+        Reader(Reader&&) = delete;
+        Reader& operator=(Reader&&) = delete;
+        ~Reader();
+
+        /** @brief Opens a capture file and checks its header
+         *
+         *  @param[in] path - file to read
+         *
+         *  @return 0 on success, negative errno on failure, -EINVAL if the
+         *          file isn't a capture of a supported version
+         */
+        int open(const std::string& path);
+
+        /** @brief Reads the next command
+         *
+         *  @param[out] record - header of the command
+         *  @param[out] request - request data
+         *  @param[out] response - response data, without completion code
+         *
+         *  @return false at the end of the file, or if it is truncated
+         */
+        bool next(RecordHeader& record, std::vector<uint8_t>& request,
+                  std::vector<uint8_t>& response);
+
+    private:
+        FILE* file = nullptr;
+};
+
+} // namespace capture
+} // namespace ipmi
+} // namespace phosphor
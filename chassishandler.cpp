@@ -141,8 +141,22 @@ sdbusplus::bus::bus dbus(ipmid_get_sd_bus_connection());
 namespace cache
 {
 
-settings::Objects objects(dbus,
-                          {bootModeIntf, bootSourceIntf, powerRestoreIntf});
+std::unique_ptr<settings::Objects> objectsPtr = nullptr;
+
+// The settings objects are looked up through the mapper on first use rather
+// than when the provider is loaded, so that loading doesn't block on it.
+settings::Objects& getObjects()
+{
+    if (objectsPtr == nullptr)
+    {
+        objectsPtr = std::make_unique<settings::Objects>(
+                         dbus,
+                         std::vector<settings::Interface>({bootModeIntf,
+                                                           bootSourceIntf,
+                                                           powerRestoreIntf}));
+    }
+    return *objectsPtr;
+}
 
 } // namespace cache
 } // namespace internal
@@ -785,26 +799,36 @@ ipmi_ret_t ipmi_get_chassis_status(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
     using namespace chassis::internal::cache;
     using namespace power_policy;
 
-    const auto& powerRestoreSetting = objects.map.at(powerRestoreIntf).front();
-    auto method =
-        dbus.new_method_call(
-            objects.service(powerRestoreSetting, powerRestoreIntf).c_str(),
-            powerRestoreSetting.c_str(),
-            ipmi::PROP_INTF,
-            "Get");
-    method.append(powerRestoreIntf, "PowerRestorePolicy");
-    auto resp = dbus.call(method);
-    if (resp.is_method_error())
+    settings::Objects* objects = nullptr;
+    try
+    {
+        objects = &getObjects();
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>("Failed to look up the power restore policy setting",
+                        entry("ERROR=%s", e.what()));
+        *data_len = 0;
+        return IPMI_CC_UNSPECIFIED_ERROR;
+    }
+
+    const auto& powerRestoreSetting = objects->map.at(powerRestoreIntf).front();
+    RestorePolicy::Policy powerRestore;
+    try
+    {
+        auto result = objects->get(powerRestoreSetting, powerRestoreIntf,
+                                   "PowerRestorePolicy");
+        powerRestore =
+            RestorePolicy::convertPolicyFromString(result.get<std::string>());
+    }
+    catch (const std::exception& e)
     {
-        log<level::ERR>("Error in PowerRestorePolicy Get");
+        log<level::ERR>("Error in PowerRestorePolicy Get",
+                        entry("ERROR=%s", e.what()));
         report<InternalFailure>();
         *data_len = 0;
         return IPMI_CC_UNSPECIFIED_ERROR;
     }
-    sdbusplus::message::variant<std::string> result;
-    resp.read(result);
-    auto powerRestore =
-        RestorePolicy::convertPolicyFromString(result.get<std::string>());
 
     *data_len = 4;
 
@@ -1255,19 +1279,18 @@ static ipmi_ret_t setBootSource(const Source::Sources& source)
 {
     using namespace chassis::internal;
     using namespace chassis::internal::cache;
-    sdbusplus::message::variant<std::string> property =
-        convertForMessage(source);
+    auto& objects = getObjects();
     auto bootSetting = settings::boot::setting(objects, bootSourceIntf);
     const auto& bootSourceSetting = std::get<settings::Path>(bootSetting);
-    auto method =
-        dbus.new_method_call(
-             objects.service(bootSourceSetting, bootSourceIntf).c_str(),
-             bootSourceSetting.c_str(), ipmi::PROP_INTF, "Set");
-    method.append(bootSourceIntf, "BootSource", property);
-    auto reply = dbus.call(method);
-    if (reply.is_method_error())
+    try
     {
-        log<level::ERR>("Error in BootSource Set");
+        objects.set(bootSourceSetting, bootSourceIntf, "BootSource",
+                    convertForMessage(source));
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>("Error in BootSource Set",
+                        entry("ERROR=%s", e.what()));
         report<InternalFailure>();
         return IPMI_CC_UNSPECIFIED_ERROR;
     }
@@ -1282,19 +1305,18 @@ static ipmi_ret_t setBootMode(const Mode::Modes& mode)
 {
     using namespace chassis::internal;
     using namespace chassis::internal::cache;
-    sdbusplus::message::variant<std::string> property =
-        convertForMessage(mode);
+    auto& objects = getObjects();
     auto bootSetting = settings::boot::setting(objects, bootModeIntf);
     const auto& bootModeSetting = std::get<settings::Path>(bootSetting);
-    auto method =
-        dbus.new_method_call(
-             objects.service(bootModeSetting, bootModeIntf).c_str(),
-             bootModeSetting.c_str(), ipmi::PROP_INTF, "Set");
-    method.append(bootModeIntf, "BootMode", property);
-    auto reply = dbus.call(method);
-    if (reply.is_method_error())
+    try
     {
-        log<level::ERR>("Error in BootMode Set");
+        objects.set(bootModeSetting, bootModeIntf, "BootMode",
+                    convertForMessage(mode));
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>("Error in BootMode Set",
+                        entry("ERROR=%s", e.what()));
         report<InternalFailure>();
         return IPMI_CC_UNSPECIFIED_ERROR;
     }
@@ -1333,49 +1355,20 @@ ipmi_ret_t ipmi_chassis_get_sys_boot_options(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
 
         try
         {
+            auto& objects = getObjects();
             auto bootSetting = settings::boot::setting(objects, bootSourceIntf);
             const auto& bootSourceSetting =
                 std::get<settings::Path>(bootSetting);
             auto oneTimeEnabled =
                 std::get<settings::boot::OneTimeEnabled>(bootSetting);
-            auto method =
-                dbus.new_method_call(
-                     objects.service(bootSourceSetting, bootSourceIntf).c_str(),
-                     bootSourceSetting.c_str(),
-                     ipmi::PROP_INTF,
-                     "Get");
-            method.append(bootSourceIntf, "BootSource");
-            auto reply = dbus.call(method);
-            if (reply.is_method_error())
-            {
-                log<level::ERR>("Error in BootSource Get");
-                report<InternalFailure>();
-                *data_len = 0;
-                return IPMI_CC_UNSPECIFIED_ERROR;
-            }
-            sdbusplus::message::variant<std::string> result;
-            reply.read(result);
+            auto result = objects.get(bootSourceSetting, bootSourceIntf,
+                                      "BootSource");
             auto bootSource =
                 Source::convertSourcesFromString(result.get<std::string>());
 
             bootSetting = settings::boot::setting(objects, bootModeIntf);
             const auto& bootModeSetting = std::get<settings::Path>(bootSetting);
-            method = dbus.new_method_call(
-                          objects.service(bootModeSetting, bootModeIntf).
-                              c_str(),
-                          bootModeSetting.c_str(),
-                          ipmi::PROP_INTF,
-                          "Get");
-            method.append(bootModeIntf, "BootMode");
-            reply = dbus.call(method);
-            if (reply.is_method_error())
-            {
-                log<level::ERR>("Error in BootMode Get");
-                report<InternalFailure>();
-                *data_len = 0;
-                return IPMI_CC_UNSPECIFIED_ERROR;
-            }
-            reply.read(result);
+            result = objects.get(bootModeSetting, bootModeIntf, "BootMode");
             auto bootMode =
                 Mode::convertModesFromString(result.get<std::string>());
 
@@ -1477,7 +1470,7 @@ ipmi_ret_t ipmi_chassis_set_sys_boot_options(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
                 SET_PARM_BOOT_FLAGS_PERMANENT;
 
             auto bootSetting =
-                settings::boot::setting(objects, bootSourceIntf);
+                settings::boot::setting(getObjects(), bootSourceIntf);
 
             oneTimeEnabled =
                 std::get<settings::boot::OneTimeEnabled>(bootSetting);
@@ -1494,14 +1487,10 @@ ipmi_ret_t ipmi_chassis_set_sys_boot_options(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
             if ((permanent && oneTimeEnabled) ||
                 (!permanent && !oneTimeEnabled))
             {
-                auto service = ipmi::getService(dbus, enabledIntf, oneTimePath);
-
-                ipmi::setDbusProperty(dbus,
-                                      service,
-                                      oneTimePath,
-                                      enabledIntf,
-                                      "Enabled",
-                                      !permanent);
+                // Through the mirror, the boot settings below are applied
+                // to the object picked from it
+                getObjects().set(oneTimePath, enabledIntf, "Enabled",
+                                 !permanent);
             }
 
             auto modeItr = modeIpmiToDbus.find(bootOption);
@@ -0,0 +1,64 @@
+#include "command-deadlines.hpp"
+
+namespace phosphor
+{
+namespace ipmi
+{
+
+constexpr unsigned CommandDeadlines::maxNetFn;
+
+size_t CommandDeadlines::parse(const nlohmann::json& data)
+{
+    // Only kept once all of the file is read
+    uint32_t newFallback = data.value("default", 0u);
+    std::map<uint8_t, uint32_t> newNetfns;
+    std::map<uint16_t, uint32_t> newCommands;
+    size_t ignored = 0;
+
+    auto entries = data.value("commands", nlohmann::json::array());
+    for (const auto& entry : entries)
+    {
+        unsigned netfn = entry.at("netfn").get<unsigned>();
+        uint32_t deadline = entry.at("deadline").get<uint32_t>();
+        unsigned cmd = entry.value("cmd", 0u);
+        if (netfn >= maxNetFn || cmd > UINT8_MAX)
+        {
+            ignored++;
+            continue;
+        }
+
+        if (entry.count("cmd") == 0)
+        {
+            newNetfns[netfn] = deadline;
+        }
+        else
+        {
+            newCommands[(netfn << 8) | cmd] = deadline;
+        }
+    }
+
+    fallback = newFallback;
+    netfns = std::move(newNetfns);
+    commands = std::move(newCommands);
+    return ignored;
+}
+
+uint32_t CommandDeadlines::get(uint8_t netfn, uint8_t cmd) const
+{
+    // Per command entries override the NetFn wide ones
+    auto command = commands.find((netfn << 8) | cmd);
+    if (command != commands.end())
+    {
+        return command->second;
+    }
+
+    auto wide = netfns.find(netfn);
+    if (wide != netfns.end())
+    {
+        return wide->second;
+    }
+    return fallback;
+}
+
+} // namespace ipmi
+} // namespace phosphor
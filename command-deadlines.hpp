@@ -0,0 +1,73 @@
+#pragma once
+
+#include <map>
+#include <stddef.h>
+#include <stdint.h>
+#include <nlohmann/json.hpp>
+
+namespace phosphor
+{
+namespace ipmi
+{
+
+/** @class CommandDeadlines
+ *  @brief How long each command may take before the host is answered
+ *         IPMI_CC_TIMEOUT, as configured in the command deadlines file.
+ *
+ *  @details The file gives a default and NetFn wide or per command
+ *           overrides, in ms, see docs/configuration.md. A deadline of 0
+ *           lets the command take as long as it needs.
+ */
+class CommandDeadlines
+{
+    public:
+        /** @brief Most NetFn values, those of the router table */
+        static constexpr unsigned maxNetFn = 64;
+
+        /** @brief Replaces the deadlines with those of a parsed file
+         *
+         *  @param[in] data - the file's JSON
+         *
+         *  @return the number of entries ignored for naming a NetFn or Cmd
+         *          out of range
+         *
+         *  @error nlohmann::json::exception thrown if the file isn't valid,
+         *         the deadlines are left as they were
+         */
+        size_t parse(const nlohmann::json& data);
+
+        /** @brief Returns the deadline of a command in ms, 0 if it has none */
+        uint32_t get(uint8_t netfn, uint8_t cmd) const;
+
+    private:
+        uint32_t fallback = 0;
+        std::map<uint8_t, uint32_t> netfns;
+        //!< Keyed by (NetFn << 8) | Cmd
+        std::map<uint16_t, uint32_t> commands;
+};
+
+/** @brief Returns when a request must be answered by
+ *
+ *  @param[in] deadline - deadline of its command in ms, 0 if none
+ *  @param[in] received - CLOCK_MONOTONIC time in usec it was received at
+ *
+ *  @return CLOCK_MONOTONIC time in usec, 0 if it has no deadline
+ */
+inline uint64_t dueBy(uint32_t deadline, uint64_t received)
+{
+    return deadline ? received + deadline * 1000ULL : 0;
+}
+
+/** @brief Returns whether a request is past its deadline and is answered
+ *         IPMI_CC_TIMEOUT
+ *
+ *  @param[in] due - from dueBy(), 0 if it has no deadline
+ *  @param[in] now - CLOCK_MONOTONIC time in usec
+ */
+inline bool overdue(uint64_t due, uint64_t now)
+{
+    return due != 0 && now >= due;
+}
+
+} // namespace ipmi
+} // namespace phosphor
@@ -0,0 +1,163 @@
+#include <errno.h>
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include "command-stats.hpp"
+
+namespace phosphor
+{
+namespace ipmi
+{
+
+size_t LatencyHistogram::bucketOf(uint64_t usec)
+{
+    if (usec < subBuckets)
+    {
+        return usec;
+    }
+
+    unsigned exp = 63 - __builtin_clzll(usec);
+    if (exp >= 32)
+    {
+        return buckets - 1;
+    }
+    // The top subBits + 1 bits of the value select the bucket
+    return (exp - subBits + 1) * subBuckets +
+           ((usec >> (exp - subBits)) & (subBuckets - 1));
+}
+
+uint64_t LatencyHistogram::upperBound(size_t bucket)
+{
+    if (bucket < subBuckets)
+    {
+        return bucket;
+    }
+
+    unsigned shift = bucket / subBuckets - 1;
+    uint64_t lower = (subBuckets + bucket % subBuckets) << shift;
+    return lower + (1ULL << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t usec)
+{
+    counts[bucketOf(usec)]++;
+    total++;
+    maxValue = std::max(maxValue, usec);
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const
+{
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    auto rank = static_cast<uint64_t>(std::ceil(total * percent / 100));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < buckets; bucket++)
+    {
+        seen += counts[bucket];
+        if (seen >= rank)
+        {
+            return bucket == buckets - 1 ? maxValue :
+                   std::min(upperBound(bucket), maxValue);
+        }
+    }
+    return maxValue;
+}
+
+CommandStats::Entry& CommandStats::entryOf(uint8_t netfn, uint8_t cmd)
+{
+    if (registered && !registered(netfn, cmd))
+    {
+        return unhandled;
+    }
+    return commands[(netfn << 8) | cmd];
+}
+
+void CommandStats::record(uint8_t netfn, uint8_t cmd, uint8_t cc,
+                          uint64_t handlerUsec, uint64_t totalUsec,
+                          uint32_t busCalls)
+{
+    auto& entry = entryOf(netfn, cmd);
+
+    entry.count++;
+    entry.completionCodes[cc]++;
+    entry.handlerTime.record(handlerUsec);
+    entry.totalTime.record(totalUsec);
+    entry.busCalls += busCalls;
+    entry.maxBusCalls = std::max(entry.maxBusCalls, busCalls);
+}
+
+void CommandStats::reject(uint8_t netfn, uint8_t cmd)
+{
+    entryOf(netfn, cmd).rateLimited++;
+}
+
+static void printLatency(FILE* file, const char* name,
+                         const LatencyHistogram& histogram)
+{
+    fprintf(file, " %s=%llu/%llu/%llu/%llu", name,
+            static_cast<unsigned long long>(histogram.percentile(50)),
+            static_cast<unsigned long long>(histogram.percentile(90)),
+            static_cast<unsigned long long>(histogram.percentile(99)),
+            static_cast<unsigned long long>(histogram.max()));
+}
+
+static void printEntry(FILE* file, const CommandStats::Entry& entry)
+{
+    fprintf(file, " %llu bus_calls=%.2f/%u",
+            static_cast<unsigned long long>(entry.count),
+            entry.count ?
+            static_cast<double>(entry.busCalls) / entry.count : 0.0,
+            entry.maxBusCalls);
+    printLatency(file, "handler_us", entry.handlerTime);
+    printLatency(file, "total_us", entry.totalTime);
+    fprintf(file, " limited=%llu",
+            static_cast<unsigned long long>(entry.rateLimited));
+    for (const auto& cc : entry.completionCodes)
+    {
+        fprintf(file, " 0x%02X=%llu", cc.first,
+                static_cast<unsigned long long>(cc.second));
+    }
+    fprintf(file, "\n");
+}
+
+int CommandStats::dump(const std::string& path) const
+{
+    FILE* file = fopen(path.c_str(), "we");
+    if (file == nullptr)
+    {
+        return -errno;
+    }
+
+    fprintf(file, "# netfn cmd count bus_calls=avg/max"
+                  " handler_us=p50/p90/p99/max total_us=p50/p90/p99/max"
+                  " limited=count cc=count...\n"
+                  "# 'unhandled' counts all the commands without a handler"
+                  " of their own\n");
+
+    for (const auto& command : commands)
+    {
+        fprintf(file, "0x%02X 0x%02X", command.first >> 8,
+                command.first & 0xFF);
+        printEntry(file, command.second);
+    }
+    if (unhandled.count != 0 || unhandled.rateLimited != 0)
+    {
+        fprintf(file, "unhandled");
+        printEntry(file, unhandled);
+    }
+
+    int r = ferror(file) ? -EIO : 0;
+    if (fclose(file) != 0 && r == 0)
+    {
+        r = -errno;
+    }
+    return r;
+}
+
+} // namespace ipmi
+} // namespace phosphor
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <string>
+#include <stdint.h>
+
+namespace phosphor
+{
+namespace ipmi
+{
+
+/** @class LatencyHistogram
+ *  @brief Log-linear histogram of durations in microseconds.
+ *
+ *  @details Each power of two is split in subBuckets linear buckets, so any
+ *           value is known to within 1/subBuckets of itself, from 1us up to
+ *           over an hour, in a fixed amount of memory. Longer durations are
+ *           counted in the last bucket.
+ */
+class LatencyHistogram
+{
+    public:
+        /** @brief log2 of the number of buckets per power of two */
+        static constexpr unsigned subBits = 3;
+        static constexpr unsigned subBuckets = 1 << subBits;
+
+        /** @brief Number of buckets, covering values below 2^32 */
+        static constexpr size_t buckets = (32 - subBits + 1) * subBuckets;
+
+        /** @brief Counts one duration */
+        void record(uint64_t usec);
+
+        /** @brief Returns the number of durations counted */
+        inline uint64_t count() const
+        {
+            return total;
+        }
+
+        /** @brief Returns the longest duration counted */
+        inline uint64_t max() const
+        {
+            return maxValue;
+        }
+
+        /** @brief Returns the duration that percent of the counted ones do
+         *         not exceed, rounded up to the bucket's upper bound
+         *
+         *  @param[in] percent - 0 to 100
+         */
+        uint64_t percentile(double percent) const;
+
+    private:
+        static size_t bucketOf(uint64_t usec);
+        static uint64_t upperBound(size_t bucket);
+
+        std::array<uint32_t, buckets> counts{};
+        uint64_t total = 0;
+        uint64_t maxValue = 0;
+};
+
+/** @class CommandStats
+ *  @brief Per [NetFn,Cmd] counters of the commands served by ipmid.
+ *
+ *  @details Only accessed from the event loop thread. Registered commands
+ *           get an entry the first time they are seen. All the others share
+ *           a single entry, so that a host probing the command space can't
+ *           make the counters grow.
+ */
+class CommandStats
+{
+    public:
+        /** @brief Returns true if [NetFn,Cmd] has a handler of its own */
+        using Registered = bool (*)(uint8_t netfn, uint8_t cmd);
+
+        /** @brief Constructor
+         *
+         *  @param[in] registered - tells the commands that get an entry of
+         *                          their own, all do if nullptr
+         */
+        explicit CommandStats(Registered registered = nullptr) :
+            registered(registered)
+        {
+        }
+
+        struct Entry
+        {
+            uint64_t count = 0;
+            //!< Number of responses per completion code
+            std::map<uint8_t, uint64_t> completionCodes;
+            //!< Time spent in the handler
+            LatencyHistogram handlerTime;
+            //!< Time from the request signal to sending the response
+            LatencyHistogram totalTime;
+            //!< Blocking D-Bus calls made by the handler
+            uint64_t busCalls = 0;
+            uint32_t maxBusCalls = 0;
+            //!< Requests refused by the rate limits, not counted above
+            uint64_t rateLimited = 0;
+        };
+
+        /** @brief Accounts for one command
+         *
+         *  @param[in] netfn - Net function
+         *  @param[in] cmd - Command
+         *  @param[in] cc - Completion code of the response
+         *  @param[in] handlerUsec - time spent in the handler
+         *  @param[in] totalUsec - time until the response was sent
+         *  @param[in] busCalls - blocking D-Bus calls made by the handler
+         */
+        void record(uint8_t netfn, uint8_t cmd, uint8_t cc,
+                    uint64_t handlerUsec, uint64_t totalUsec,
+                    uint32_t busCalls);
+
+        /** @brief Accounts for a request refused by the rate limits
+         *
+         *  @param[in] netfn - Net function
+         *  @param[in] cmd - Command
+         */
+        void reject(uint8_t netfn, uint8_t cmd);
+
+        /** @brief Returns the counters of every command seen, keyed by
+         *         (NetFn << 8) | Cmd
+         */
+        inline const std::map<uint16_t, Entry>& entries() const
+        {
+            return commands;
+        }
+
+        /** @brief Returns the counters shared by the commands that aren't
+         *         registered
+         */
+        inline const Entry& unhandledEntry() const
+        {
+            return unhandled;
+        }
+
+        /** @brief Writes the counters to a file as text, one command per
+         *         line
+         *
+         *  @param[in] path - file to write, replaced if it exists
+         *
+         *  @return 0 on success, negative errno on failure
+         */
+        int dump(const std::string& path) const;
+
+    private:
+        /** @brief Returns the entry counting [NetFn,Cmd] */
+        Entry& entryOf(uint8_t netfn, uint8_t cmd);
+
+        Registered registered;
+        std::map<uint16_t, Entry> commands;
+        Entry unhandled;
+};
+
+} // namespace ipmi
+} // namespace phosphor
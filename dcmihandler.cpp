@@ -51,6 +51,8 @@ constexpr auto DHCP_OPT12_ENABLED = "SendHostNameEnabled";
 constexpr auto DCMI_CAP_JSON_FILE = "/usr/share/ipmi-providers/dcmi_cap.json";
 
 constexpr auto SENSOR_VALUE_INTF = "xyz.openbmc_project.Sensor.Value";
+// Where the sensor services keep their ObjectManager
+constexpr auto SENSOR_ROOT = "/xyz/openbmc_project/sensors";
 constexpr auto SENSOR_VALUE_PROP = "Value";
 constexpr auto SENSOR_SCALE_PROP = "Scale";
 
@@ -836,8 +838,9 @@ Temperature readTemp(const std::string& dbusService,
     // with a separate single bit for the sign.
 
     sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
-    auto result = ipmi::getAllDbusProperties(bus, dbusService, dbusPath,
-                                        "xyz.openbmc_project.Sensor.Value");
+    auto result = ipmi::ManagedObjects::instance().properties(
+                      bus, dbusService, SENSOR_ROOT, dbusPath,
+                      SENSOR_VALUE_INTF);
     auto temperature = result.at("Value").get<int64_t>();
     uint64_t absTemp = std::abs(temperature);
 
@@ -1098,8 +1101,9 @@ int64_t getPowerReading(sdbusplus::bus::bus& bus)
         auto service = ipmi::getService(bus, SENSOR_VALUE_INTF, objectPath);
 
         //Read the sensor value and scale properties
-        auto properties = ipmi::getAllDbusProperties(
-                                bus, service, objectPath, SENSOR_VALUE_INTF);
+        auto properties = ipmi::ManagedObjects::instance().properties(
+                              bus, service, SENSOR_ROOT, objectPath,
+                              SENSOR_VALUE_INTF);
         auto value = properties[SENSOR_VALUE_PROP].get<int64_t>();
         auto scale = properties[SENSOR_SCALE_PROP].get<int64_t>();
 
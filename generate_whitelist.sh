@@ -6,22 +6,77 @@ if [ "x$*" == "x" ]; then
     exit -1
 fi
 
-cat << EOF
+cat << EOF_HEADER
 #include <ipmiwhitelist.hpp>
 
-const std::vector<netfncmd_pair> whitelist = {
+// Whitelisted commands:
+EOF_HEADER
 
-EOF
-
-# Output each row of whitelist vector.
 # Concatenate all the passed files.
 # Remove comments and empty lines.
 # Sort the list [numerically].
 # Remove any duplicates.
-# Turn "a:b //<NetFn>:<Command>" -> "{ a, b }, //<NetFn>:<Command>"
-cat $* | sed "s/#.*//" | sed '/^$/d' | sort -n | uniq | sed "s/^/    { /" | \
-    sed "s/\:\(....\)\(.*\)/ , \1 }, \2/"
+entries=$(cat $* | sed "s/#.*//" | sed '/^$/d' | sort -n | uniq)
+
+# Document each row of the whitelist in the generated file.
+# Turn "a:b //<NetFn>:<Command>" -> "// a:b <NetFn>:<Command>"
+echo "$entries" | sed "s/^\([^ \t]*\)[ \t]*\/\/\(.*\)/\/\/ \1 \2/"
+
+cat << EOF_BITMAP
+
+constexpr whitelist_bitmap_t whitelist = {{
+EOF_BITMAP
+
+# Set bit (NetFn << 8 | Cmd) for each row and emit the bitmap bytewise, so
+# the table is fully built at compile time.
+echo "$entries" | awk '
+function hex2dec(h,    i, c, v)
+{
+    h = tolower(h)
+    sub(/^0x/, "", h)
+    v = 0
+    for (i = 1; i <= length(h); i++)
+    {
+        c = index("0123456789abcdef", substr(h, i, 1)) - 1
+        if (c < 0)
+        {
+            return -1
+        }
+        v = v * 16 + c
+    }
+    return v
+}
+{
+    split($1, pair, ":")
+    netfn = hex2dec(pair[1])
+    cmd = hex2dec(pair[2])
+    if (netfn < 0 || netfn > 63 || cmd < 0 || cmd > 255)
+    {
+        print "Invalid whitelist entry: " $1 > "/dev/stderr"
+        exit 1
+    }
+    bit = netfn * 256 + cmd
+    if (!(bit in seen))
+    {
+        seen[bit] = 1
+        bytes[int(bit / 8)] += 2 ^ (bit % 8)
+    }
+}
+END {
+    for (i = 0; i < 2048; i++)
+    {
+        if (i % 16 == 0)
+        {
+            printf "   "
+        }
+        printf " 0x%02x,", bytes[i]
+        if (i % 16 == 15)
+        {
+            printf "\n"
+        }
+    }
+}' || exit 1
 
-cat << EOF
-};
-EOF
+cat << EOF_FOOTER
+}};
+EOF_FOOTER
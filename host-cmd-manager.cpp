@@ -24,8 +24,10 @@ using namespace phosphor::logging;
 using InternalFailure = sdbusplus::xyz::openbmc_project::Common::
                             Error::InternalFailure;
 
-Manager::Manager(sdbusplus::bus::bus& bus, sd_event* event) :
+Manager::Manager(sdbusplus::bus::bus& bus, sd_event* event,
+                 const std::string& path) :
             bus(bus),
+            path(path),
             timer(event, std::bind(&Manager::hostTimeout, this))
 {
     // Nothing to do here.
@@ -97,10 +99,9 @@ void Manager::checkQueueAndAlertHost()
     {
         log<level::DEBUG>("Asserting SMS Attention");
 
-        std::string IPMI_PATH("/org/openbmc/HostIpmi/1");
         std::string IPMI_INTERFACE("org.openbmc.HostIpmi");
 
-        auto host = ::ipmi::getService(this->bus,IPMI_INTERFACE,IPMI_PATH);
+        auto host = ::ipmi::getService(this->bus,IPMI_INTERFACE,this->path);
 
         // Start the timer for this transaction
         auto time = std::chrono::duration_cast<std::chrono::microseconds>(
@@ -114,7 +115,7 @@ void Manager::checkQueueAndAlertHost()
         }
 
         auto method = this->bus.new_method_call(host.c_str(),
-                                                IPMI_PATH.c_str(),
+                                                this->path.c_str(),
                                                 IPMI_INTERFACE.c_str(),
                                                 "setAttention");
         auto reply = this->bus.call(method);
@@ -2,6 +2,7 @@
 
 #include <tuple>
 #include <queue>
+#include <string>
 #include <sdbusplus/bus.hpp>
 #include <timer.hpp>
 #include <host-ipmid/ipmid-host-cmd-utils.hpp>
@@ -30,8 +31,10 @@ class Manager
          *
          *  @param[in] bus   - dbus handler
          *  @param[in] event - pointer to sd_event
+         *  @param[in] path  - object path of the bridge to the host
          */
-        Manager(sdbusplus::bus::bus& bus, sd_event* event);
+        Manager(sdbusplus::bus::bus& bus, sd_event* event,
+                const std::string& path);
 
         /** @brief  Extracts the next entry in the queue and returns
          *          Command and data part of it.
@@ -71,6 +74,9 @@ class Manager
         /** @brief Reference to the dbus handler */
         sdbusplus::bus::bus& bus;
 
+        /** @brief Bridge to alert the host through */
+        std::string path;
+
         /** @brief Queue to store the requested commands */
         std::queue<CommandHandler> workQueue{};
 
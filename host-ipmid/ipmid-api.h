@@ -63,6 +63,35 @@ typedef unsigned char ipmi_ret_t;
 
 typedef enum CommandPrivilege ipmi_cmd_privilege_t;
 
+/*
+ * Optional properties of a command handler, given when registering it.
+ * IPMI_CMD_FLAG_THREAD_SAFE lets ipmid run the handler on one of its worker
+ * threads instead of the event loop. Such a handler must only reach D-Bus
+ * through ipmid_get_sd_bus_connection(), which returns a connection private
+ * to the calling thread, and must not touch state shared with other handlers
+ * or the sd_event loop.
+ * IPMI_CMD_FLAG_CACHEABLE lets ipmid answer a request with the response the
+ * handler last gave to the same request bytes, without calling it. Only
+ * successful responses are kept. The provider must call
+ * ipmi_invalidate_cached_responses() whenever the data behind the command
+ * changes.
+ * IPMI_CMD_FLAG_PRIORITY_CRITICAL and IPMI_CMD_FLAG_PRIORITY_BULK set the
+ * command's scheduling class, normal when neither is given. Whenever
+ * requests have to wait, for the event loop or for a worker thread, critical
+ * ones are run first and bulk ones last. Critical is meant for the commands
+ * a host can't afford to have delayed, such as the watchdog's, bulk for
+ * those that may take long, such as clearing the SEL.
+ */
+enum CommandFlags {
+  IPMI_CMD_FLAG_NONE              = 0x00,
+  IPMI_CMD_FLAG_THREAD_SAFE       = 0x01,
+  IPMI_CMD_FLAG_CACHEABLE         = 0x02,
+  IPMI_CMD_FLAG_PRIORITY_CRITICAL = 0x04,
+  IPMI_CMD_FLAG_PRIORITY_BULK     = 0x08,
+};
+
+typedef unsigned int ipmi_cmd_flags_t;
+
 // This is the callback handler that the plugin registers with IPMID. IPMI
 // function router will then make a call to this callback handler with the
 // necessary arguments of netfn, cmd, request, response, size and context.
@@ -75,8 +104,30 @@ typedef ipmi_ret_t (*ipmid_callback_t)(ipmi_netfn_t, ipmi_cmd_t, ipmi_request_t,
 void ipmi_register_callback(ipmi_netfn_t, ipmi_cmd_t, ipmi_context_t, ipmid_callback_t,
                             ipmi_cmd_privilege_t);
 
+// Same as ipmi_register_callback, with CommandFlags describing the handler.
+void ipmi_register_callback_flags(ipmi_netfn_t, ipmi_cmd_t, ipmi_context_t,
+                                  ipmid_callback_t, ipmi_cmd_privilege_t,
+                                  ipmi_cmd_flags_t);
+
+// Drops the cached responses of a command registered with
+// IPMI_CMD_FLAG_CACHEABLE, IPMI_CMD_WILDCARD drops those of the whole NetFn.
+// Must be called from the sd_event loop thread, e.g. from a D-Bus signal
+// handler.
+void ipmi_invalidate_cached_responses(ipmi_netfn_t, ipmi_cmd_t);
+
+// One ipmid may serve several hosts, numbered from 0 in the order they are
+// first heard from. Host 0 is the one behind the /org/openbmc/HostIpmi/1
+// bridge.
+typedef unsigned int ipmi_host_t;
+
+// Returns the host the request being handled comes from. Only meaningful
+// while a handler runs, 0 elsewhere.
+ipmi_host_t ipmid_get_request_host(void);
 
+// The SEL reservation of the host the request being handled comes from, and
+// a new reservation for it, cancelling the previous one.
 unsigned short get_sel_reserve_id(void);
+unsigned short new_sel_reserve_id(void);
 
 // These are the command network functions, the response
 // network functions are the function + 1. So to determine
@@ -114,6 +165,7 @@ enum ipmi_return_codes
     IPMI_WDOG_CC_NOT_INIT = 0x80,
     IPMI_CC_BUSY = 0xC0,
     IPMI_CC_INVALID = 0xC1,
+    IPMI_CC_TIMEOUT = 0xC3,
     IPMI_CC_INVALID_RESERVATION_ID = 0xC5,
     IPMI_CC_REQ_DATA_LEN_INVALID = 0xC7,
     IPMI_CC_PARM_OUT_OF_RANGE = 0xC9,
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <sdbusplus/bus.hpp>
+#include <host-ipmid/ipmid-api.h>
+
+namespace ipmi
+{
+namespace async
+{
+
+/** @detail Asynchronous command handlers don't return their response, they
+ *          hand it to a Responder once it is available. This lets a handler
+ *          wait on D-Bus replies through callMethod() instead of blocking
+ *          the event loop in bus.call(), so other commands keep being served
+ *          in the meantime.
+ *
+ *          Handlers and Responders are only ever run on the event loop
+ *          thread.
+ */
+
+/** @brief Payload of a request or response, without completion code */
+using Payload = std::vector<uint8_t>;
+
+/** @brief Sends the response of an asynchronous command. Only the first call
+ *         is honoured; if every copy is dropped without being called, the
+ *         host gets IPMI_CC_UNSPECIFIED_ERROR.
+ *
+ *  @param[in] cc - completion code
+ *  @param[in] data - response data following the completion code
+ */
+using Responder = std::function<void(ipmi_ret_t cc, const Payload& data)>;
+
+/** @brief Asynchronous command handler
+ *
+ *  @param[in] netfn - Net function of the request
+ *  @param[in] cmd - Command of the request
+ *  @param[in] request - Request data
+ *  @param[in] respond - Responder for this request
+ */
+using Handler = std::function<void(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
+                                   const Payload& request,
+                                   Responder respond)>;
+
+/** @brief Registers an asynchronous command handler, next to the
+ *         ipmid_callback_t ones registered by ipmi_register_callback().
+ *
+ *  @param[in] netfn - Net function
+ *  @param[in] cmd - Command, or IPMI_CMD_WILDCARD
+ *  @param[in] handler - Handler to invoke
+ *  @param[in] priv - Privilege required to execute the command
+ */
+void registerHandler(ipmi_netfn_t netfn, ipmi_cmd_t cmd, Handler&& handler,
+                     ipmi_cmd_privilege_t priv);
+
+/** @brief Callback receiving the reply, or error reply, of callMethod() */
+using ReplyHandler = std::function<void(sdbusplus::message::message& reply)>;
+
+/** @brief Calls a D-Bus method on ipmid's connection without waiting for the
+ *         reply. The reply is passed to the callback from the event loop;
+ *         failures to reach the peer are delivered as an error reply, so
+ *         callers check reply.is_method_error() as with bus.call().
+ *
+ *  @param[in] method - Method call, created with new_method_call() on the
+ *                      bus returned by ipmid_get_sd_bus_connection()
+ *  @param[in] callback - Invoked with the reply
+ *
+ *  @return 0 on success, negative errno if the call could not be queued,
+ *          in which case callback is not invoked.
+ */
+int callMethod(sdbusplus::message::message& method, ReplyHandler&& callback);
+
+} // namespace async
+} // namespace ipmi
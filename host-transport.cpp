@@ -0,0 +1,209 @@
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include "host-transport.hpp"
+
+namespace phosphor
+{
+namespace ipmi
+{
+
+// Frame length byte, then netfn/lun, seq and cmd
+constexpr size_t headerLen = 4;
+
+// Most reads per receive()
+constexpr size_t maxReads = 16;
+
+HostTransport::HostTransport(int fd, const std::string& name) :
+    fd(fd),
+    name(name)
+{
+    struct stat st;
+    isSocket = (fstat(fd, &st) == 0 && S_ISSOCK(st.st_mode));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+HostTransport::~HostTransport()
+{
+    close(fd);
+}
+
+std::unique_ptr<HostTransport> HostTransport::open(const std::string& path)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) < 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "Opening the host transport " + path);
+    }
+
+    if (!S_ISSOCK(st.st_mode))
+    {
+        int fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(),
+                                    "Opening the host transport " + path);
+        }
+        return std::make_unique<HostTransport>(fd, path);
+    }
+
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+    {
+        throw std::system_error(ENAMETOOLONG, std::generic_category(),
+                                "Opening the host transport " + path);
+    }
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 ||
+        connect(fd, reinterpret_cast<struct sockaddr*>(&addr),
+                sizeof(addr)) < 0)
+    {
+        auto error = errno;
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        throw std::system_error(error, std::generic_category(),
+                                "Connecting the host transport " + path);
+    }
+    return std::make_unique<HostTransport>(fd, path);
+}
+
+int HostTransport::receive(std::vector<HostRequest>& requests)
+{
+    int r = 0;
+    uint8_t buf[4096];
+
+    // Bounded, so that a flooding host doesn't keep the event loop here
+    for (size_t reads = 0; reads < maxReads; reads++)
+    {
+        // A device node returns one whole message per read, which buf is
+        // large enough for
+        auto n = read(fd, buf, sizeof(buf));
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            r = (errno == EAGAIN) ? 0 : -errno;
+            break;
+        }
+        if (n == 0)
+        {
+            r = -EPIPE;
+            break;
+        }
+        partial.insert(partial.end(), buf, buf + n);
+    }
+
+    size_t pos = 0;
+    while (pos < partial.size() &&
+           partial.size() - pos > static_cast<size_t>(partial[pos]))
+    {
+        size_t len = partial[pos];
+        if (len < headerLen - 1)
+        {
+            malformed++;
+            pos += 1 + len;
+            continue;
+        }
+
+        const uint8_t* frame = &partial[pos];
+        HostRequest request;
+        request.netfn = frame[1] >> 2;
+        request.lun = frame[1] & 0x03;
+        request.seq = frame[2];
+        request.cmd = frame[3];
+        request.data.assign(frame + headerLen, frame + 1 + len);
+        requests.push_back(std::move(request));
+        pos += 1 + len;
+    }
+    partial.erase(partial.begin(), partial.begin() + pos);
+
+    return r;
+}
+
+int HostTransport::send(uint8_t seq, uint8_t netfn, uint8_t lun, uint8_t cmd,
+                        uint8_t cc, const uint8_t* data, size_t len)
+{
+    if (len > maxResponseData)
+    {
+        return -EMSGSIZE;
+    }
+    if (queued.size() >= maxQueued)
+    {
+        return -ENOBUFS;
+    }
+
+    // Responses in IPMI require the low NetFn bit set
+    std::vector<uint8_t> frame(headerLen + 1 + len);
+    frame[0] = frame.size() - 1;
+    frame[1] = ((netfn | 0x01) << 2) | (lun & 0x03);
+    frame[2] = seq;
+    frame[3] = cmd;
+    frame[4] = cc;
+    if (len)
+    {
+        memcpy(&frame[headerLen + 1], data, len);
+    }
+    queued.push_back(std::move(frame));
+
+    return flush();
+}
+
+int HostTransport::flush()
+{
+    while (!queued.empty())
+    {
+        const auto& frame = queued.front();
+        ssize_t n;
+        if (isSocket)
+        {
+            n = ::send(fd, frame.data() + written, frame.size() - written,
+                       MSG_NOSIGNAL);
+        }
+        else
+        {
+            n = write(fd, frame.data() + written, frame.size() - written);
+        }
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN)
+            {
+                return 0;
+            }
+            // Whatever is queued can't be delivered anymore
+            int r = -errno;
+            queued.clear();
+            written = 0;
+            return r;
+        }
+
+        // Device nodes take whole messages, sockets may take part of one
+        written += n;
+        if (written == frame.size())
+        {
+            queued.pop_front();
+            written = 0;
+        }
+    }
+    return 0;
+}
+
+} // namespace ipmi
+} // namespace phosphor
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace phosphor
+{
+namespace ipmi
+{
+
+/** @brief A request as read from a host transport */
+struct HostRequest
+{
+    uint8_t seq;
+    uint8_t netfn;
+    uint8_t lun;
+    uint8_t cmd;
+    std::vector<uint8_t> data;
+};
+
+/** @class HostTransport
+ *  @brief Exchanges IPMI messages with the host over a file descriptor,
+ *         without going through a bridge daemon.
+ *
+ *  @details Messages are framed the way the BT host interface device nodes
+ *           frame them:
+ *
+ *             request:  len, netfn << 2 | lun, seq, cmd, data...
+ *             response: len, netfn << 2 | lun, seq, cmd, cc, data...
+ *
+ *           where len counts the bytes that follow it. The same framing is
+ *           used on Unix stream sockets, where a read may return part of a
+ *           message or several of them.
+ *
+ *           The fd is non-blocking. Responses that can't be written right
+ *           away are queued, and written by flush() once the fd is
+ *           writable again.
+ */
+class HostTransport
+{
+    public:
+        /** @brief Most responses queued before send() refuses more */
+        static constexpr size_t maxQueued = 64;
+
+        /** @brief Most data bytes in a response, past the completion code */
+        static constexpr size_t maxResponseData = 255 - 4;
+
+        HostTransport() = delete;
+        HostTransport(const HostTransport&) = delete;
+        HostTransport& operator=(const HostTransport&) = delete;
+        HostTransport(HostTransport&&) = delete;
+        HostTransport& operator=(HostTransport&&) = delete;
+
+        /** @brief Takes over an open fd
+         *
+         *  @param[in] fd - character device or connected stream socket
+         *  @param[in] name - identifies the transport in logs and limits
+         */
+        HostTransport(int fd, const std::string& name);
+
+        /** @brief Closes the fd */
+        ~HostTransport();
+
+        /** @brief Opens a host interface character device, or connects to
+         *         a Unix socket
+         *
+         *  @param[in] path - device node or socket path
+         *
+         *  @error std::system_error thrown if path can't be opened
+         */
+        static std::unique_ptr<HostTransport> open(const std::string& path);
+
+        inline int getFd() const
+        {
+            return fd;
+        }
+
+        inline const std::string& getName() const
+        {
+            return name;
+        }
+
+        /** @brief Reads the requests available
+         *
+         *  @param[out] requests - complete requests are appended to it
+         *
+         *  @return 0 once nothing more can be read for now, -EPIPE once the
+         *          peer has closed, other negative errno on failure
+         */
+        int receive(std::vector<HostRequest>& requests);
+
+        /** @brief Sends a response, or queues it if the fd isn't writable
+         *
+         *  @param[in] seq - sequence number of the request
+         *  @param[in] netfn - Net function of the request
+         *  @param[in] lun - LUN of the request
+         *  @param[in] cmd - Command
+         *  @param[in] cc - Completion code
+         *  @param[in] data - response data, past the completion code
+         *  @param[in] len - length of data, at most maxResponseData
+         *
+         *  @return 0 on success, -ENOBUFS if the queue is full, other
+         *          negative errno on failure
+         */
+        int send(uint8_t seq, uint8_t netfn, uint8_t lun, uint8_t cmd,
+                 uint8_t cc, const uint8_t* data, size_t len);
+
+        /** @brief Writes the queued responses the fd takes
+         *
+         *  @return 0 on success, negative errno on failure
+         */
+        int flush();
+
+        /** @brief Returns whether responses are waiting for the fd to be
+         *         writable
+         */
+        inline bool pending() const
+        {
+            return !queued.empty();
+        }
+
+        /** @brief Returns the number of malformed requests skipped */
+        inline uint64_t dropped() const
+        {
+            return malformed;
+        }
+
+    private:
+        int fd;
+        std::string name;
+        bool isSocket = false;
+
+        /** @brief Bytes read past the last complete request */
+        std::vector<uint8_t> partial;
+
+        /** @brief Framed responses not written yet, and how much of the
+         *         first one has been
+         */
+        std::deque<std::vector<uint8_t>> queued;
+        size_t written = 0;
+
+        uint64_t malformed = 0;
+};
+
+} // namespace ipmi
+} // namespace phosphor
@@ -4,19 +4,30 @@
 #include <unistd.h>
 #include <assert.h>
 #include <dirent.h>
+#include <signal.h>
 #include <systemd/sd-bus.h>
+#include <systemd/sd-daemon.h>
 #include <string.h>
 #include <stdlib.h>
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <fstream>
+#include <list>
 #include <map>
 #include <memory>
 #include <phosphor-logging/log.hpp>
+#include <sys/epoll.h>
+#include <sys/socket.h>
 #include <sys/time.h>
+#include <time.h>
 #include <errno.h>
 #include <mapper.h>
+#include <nlohmann/json.hpp>
 #include "sensorhandler.h"
 #include <vector>
-#include <algorithm>
 #include <iterator>
+#include <tuple>
 #include <ipmiwhitelist.hpp>
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/bus/match.hpp>
@@ -24,11 +35,22 @@
 #include "sensorhandler.h"
 #include "ipmid.hpp"
 #include "settings.hpp"
+#include "utils.hpp"
+#include <capture-file.hpp>
+#include <command-deadlines.hpp>
+#include <command-stats.hpp>
 #include <host-cmd-manager.hpp>
+#include <host-transport.hpp>
+#include <host-ipmid/ipmid-async.hpp>
 #include <host-ipmid/ipmid-host-cmd.hpp>
+#include <rate-limiter.hpp>
+#include <response-cache.hpp>
 #include <timer.hpp>
+#include <trace-ring.hpp>
+#include <worker-pool.hpp>
 
 using namespace phosphor::logging;
+using phosphor::ipmi::Priority;
 namespace sdbusRule = sdbusplus::bus::match::rules;
 
 sd_bus *bus = NULL;
@@ -38,9 +60,8 @@ sd_event *events = nullptr;
 // Need this to use new sdbusplus compatible interfaces
 sdbusPtr sdbusp;
 
-// Global Host Bound Command manager
+// Host Bound Command managers, one per host, see ipmi_host_context_t
 using cmdManagerPtr = std::unique_ptr<phosphor::host::command::Manager>;
-cmdManagerPtr cmdManager;
 
 // Global timer for network changes
 std::unique_ptr<phosphor::ipmi::Timer> networkTimer = nullptr;
@@ -52,32 +73,390 @@ using CommandHandler = phosphor::host::command::CommandHandler;
 // Initialise restricted mode to true
 bool restricted_mode = true;
 
+// Worker threads running the handlers registered as thread safe
+std::unique_ptr<phosphor::ipmi::WorkerPool> workerPool = nullptr;
+sd_event_source *workerSource = nullptr;
+
+// D-Bus connection private to a worker thread
+thread_local sd_bus *workerBus = nullptr;
+thread_local bool isWorkerThread = false;
+
+// Default number of worker threads and of requests waiting for them
+constexpr size_t IPMI_WORKER_THREADS = 2;
+constexpr size_t IPMI_WORKER_QUEUE_DEPTH = 16;
+
 FILE *ipmiio, *ipmidbus, *ipmicmddetails;
 
+// History of the last requests and responses, toggled with SIGUSR1 and
+// written to traceFile on SIGUSR2
+phosphor::ipmi::TraceRing ipmiTrace;
+std::string traceFile = "/tmp/ipmid-trace.bin";
+sd_event_source *traceToggleSource = nullptr;
+sd_event_source *traceDumpSource = nullptr;
+
+// Per command counters, written to statsFile on SIGUSR2. Only registered
+// commands get counters of their own, see ipmi_command_registered().
+static bool ipmi_command_registered(uint8_t netfn, uint8_t cmd);
+phosphor::ipmi::CommandStats commandStats(ipmi_command_registered);
+std::string statsFile = "/tmp/ipmid-stats.txt";
+
+// Per command deadlines, see ipmi_init_router_deadlines()
+std::string deadlinesFile = COMMAND_DEADLINES_FILE;
+
+// Requests admitted per NetFn, command and bridge, see ipmi_init_rate_limits()
+phosphor::ipmi::RateLimiter rateLimiter;
+std::string rateLimitsFile = RATE_LIMITS_FILE;
+
+// Commands served are appended to the capture file given with -c, if any
+std::unique_ptr<phosphor::ipmi::capture::Writer> captureWriter = nullptr;
+
+// Responses of the commands registered with IPMI_CMD_FLAG_CACHEABLE
+phosphor::ipmi::ResponseCache responseCache;
+
+struct ipmi_host_context_t;
+
+// A host transport served directly rather than through a bridge, the
+// device nodes and sockets given with -H or handed over by systemd
+struct ipmi_host_link_t : std::enable_shared_from_this<ipmi_host_link_t>
+{
+    explicit ipmi_host_link_t(
+        std::unique_ptr<phosphor::ipmi::HostTransport> transport) :
+        transport(std::move(transport))
+    {
+    }
+
+    ~ipmi_host_link_t();
+
+    std::unique_ptr<phosphor::ipmi::HostTransport> transport;
+    // Watches the fd, released once the link is closed
+    sd_event_source *source = nullptr;
+    // Each link is a host of its own, keyed by the transport name
+    ipmi_host_context_t *host = nullptr;
+};
+
+std::vector<std::string> hostTransports;
+std::vector<std::shared_ptr<ipmi_host_link_t>> hostLinks;
+std::vector<sd_event_source*> hostListeners;
+
+// Where a request came from and its response goes back to: the bridge that
+// sent its ReceivedMessage signal, or the host link it was read from, and
+// the host either serves.
+struct ipmi_origin_t
+{
+    sd_bus_message *m;
+    std::shared_ptr<ipmi_host_link_t> link;
+    ipmi_host_context_t *host;
+};
+
+// A request waiting to be processed. Those read from a host link carry
+// their message, the others are read from their signal, which is referenced
+// while the request is queued.
+struct ipmi_pending_request_t
+{
+    ipmi_origin_t origin;
+    phosphor::ipmi::HostRequest message;
+    uint64_t received;
+    Priority priority;
+    // How many requests of the same host are ahead of it in its batch
+    size_t turn;
+};
+
+// State kept per host, for sleds where one BMC serves several of them. A
+// host is told apart by the object path its bridge signals requests from, or
+// by the host link they are read from. The contexts of bridges live as long
+// as ipmid. Those of host links are reclaimed once their last link is gone,
+// which is once no request of theirs is pending either, as requests hold
+// their link: a connection accepted later on the same fd starts afresh.
+struct ipmi_host_context_t
+{
+    ipmi_host_t id;
+    std::string key;
+    // Host links serving the host, see ipmi_add_host_link()
+    size_t links = 0;
+    bool linked = false;
+    // Reservation ID of the SEL, see get_sel_reserve_id()
+    unsigned short selReserve = 0xFFFF;
+    // Commands queued for the host to read once alerted
+    cmdManagerPtr cmdManager;
+    // Bulk requests waiting for the event loop to be idle, see handle_bulk()
+    std::deque<ipmi_pending_request_t> bulkQueue;
+    // Requests handed to the worker threads and not responded to yet
+    size_t inWorkers = 0;
+};
+
+// The bridge object path of host 0, the one the BMC's own commands for the
+// host go to, see ipmid_send_cmd_to_host()
+constexpr auto defaultHostPath = "/org/openbmc/HostIpmi/1";
+
+// Most hosts told apart, any more are refused, see ipmi_get_host()
+constexpr size_t maxHosts = 16;
+
+// Whether a host was refused since a host context was last reclaimed, so
+// that the refusals are only logged once
+static bool hostsRefused = false;
+
+// Indexed by host id, nullptr where a host was reclaimed
+std::vector<std::unique_ptr<ipmi_host_context_t>> hostContexts;
+
+// The host whose request the current thread is handling, nullptr outside of
+// a handler
+thread_local ipmi_host_context_t *requestHost = nullptr;
+
+// Maximum number of requests processed per event loop pass when batching
+// with -b, 0 processes each one as its signal is dispatched
+size_t batchLimit = 0;
+sd_event_source *batchSource = nullptr;
+std::vector<ipmi_pending_request_t> batchQueue;
+
+// Requests of commands registered with IPMI_CMD_FLAG_PRIORITY_BULK are left
+// for when the event loop is otherwise idle, in the queue of their host.
+// The hosts with some queued take turns, in this order.
+sd_event_source *bulkSource = nullptr;
+std::deque<ipmi_host_context_t*> bulkHosts;
+
+// A bulk request that has waited this long, in usec, is processed as a
+// normal one, so that a busy event loop doesn't starve it. bulkTimer fires
+// at the latest when the oldest queued one is due.
+constexpr uint64_t maxBulkWait = 1000000;
+sd_event_source *bulkTimer = nullptr;
+
+// Blocking D-Bus calls made by the current thread, see sd_bus_call() below
+thread_local uint32_t busCalls = 0;
+
+// When the handler running on the current thread must be done by, in
+// CLOCK_MONOTONIC usec, 0 if it has no deadline
+thread_local uint64_t callDeadline = 0;
+
+static uint64_t monotonic_usec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+// Counts the blocking D-Bus round trips made by command handlers, and cuts
+// their timeout short to what is left of the handler's deadline. ipmid is
+// linked with -export-dynamic, so this definition takes precedence over
+// libsystemd's for the providers, sdbusplus and libmapper alike.
+extern "C" int sd_bus_call(sd_bus *b, sd_bus_message *m, uint64_t usec,
+                           sd_bus_error *ret_error, sd_bus_message **reply)
+{
+    using sd_bus_call_t = int (*)(sd_bus*, sd_bus_message*, uint64_t,
+                                  sd_bus_error*, sd_bus_message**);
+    static auto real_sd_bus_call =
+        reinterpret_cast<sd_bus_call_t>(dlsym(RTLD_NEXT, "sd_bus_call"));
+
+    if (real_sd_bus_call == nullptr)
+    {
+        return -ENOSYS;
+    }
+    busCalls++;
+
+    if (callDeadline != 0)
+    {
+        auto now = monotonic_usec();
+        if (now >= callDeadline)
+        {
+            return sd_bus_error_set_errno(ret_error, ETIMEDOUT);
+        }
+        // 0 stands for the sd-bus default of 25s
+        if (usec == 0 || usec > callDeadline - now)
+        {
+            usec = callDeadline - now;
+        }
+    }
+    return real_sd_bus_call(b, m, usec, ret_error, reply);
+}
+
 void print_usage(void) {
-  fprintf(stderr, "Options:  [-d mask]\n");
-  fprintf(stderr, "    mask : 0x01 - Print ipmi packets\n");
+  fprintf(stderr, "Options:  [-d mask] [-t file] [-s file] [-c file]"
+                  " [-D file] [-r file] [-H path]... [-w threads]"
+                  " [-b count]\n");
+  fprintf(stderr, "    mask : 0x01 - Trace ipmi packets\n");
   fprintf(stderr, "    mask : 0x02 - Print DBUS operations\n");
   fprintf(stderr, "    mask : 0x04 - Print ipmi command details\n");
   fprintf(stderr, "    mask : 0xFF - Print all trace\n");
+  fprintf(stderr, "    file : Where SIGUSR2 writes the packet trace"
+                  " (default %s)\n", traceFile.c_str());
+  fprintf(stderr, "    file : Where SIGUSR2 writes the command statistics"
+                  " (default %s)\n", statsFile.c_str());
+  fprintf(stderr, "    file : Capture the commands served, for ipmid-replay\n");
+  fprintf(stderr, "    file : Per command deadlines (default %s)\n",
+                  deadlinesFile.c_str());
+  fprintf(stderr, "    file : Request rate limits (default %s)\n",
+                  rateLimitsFile.c_str());
+  fprintf(stderr, "    path : Also serve the host interface device node or"
+                  " Unix socket at path\n");
+  fprintf(stderr, "    SIGUSR1 toggles the packet trace, SIGUSR2 writes the"
+                  " trace and statistics\n");
+  fprintf(stderr, "    threads : Worker threads for thread safe commands"
+                  " (default %zu, 0 runs them inline)\n", IPMI_WORKER_THREADS);
+  fprintf(stderr, "    count : Process up to count queued requests per"
+                  " event loop pass (default 0, one at a time)\n");
 }
 
 const char * DBUS_INTF = "org.openbmc.HostIpmi";
 
 const char * FILTER = "type='signal',interface='org.openbmc.HostIpmi',member='ReceivedMessage'";
 
-typedef std::pair<ipmi_netfn_t, ipmi_cmd_t> ipmi_fn_cmd_t;
-typedef std::pair<ipmid_callback_t, ipmi_context_t> ipmi_fn_context_t;
+// Set in the router table for handlers registered through
+// ipmi::async::registerHandler(), their context is the ipmi::async::Handler.
+constexpr ipmi_cmd_flags_t IPMI_CMD_FLAG_ASYNC = 0x80000000;
+
+// Router table slot for a single [NetFn,Cmd] tuple.
+struct ipmi_fn_entry_t
+{
+    ipmid_callback_t handler;
+    ipmi_context_t context;
+    ipmi_cmd_privilege_t priv;
+    ipmi_cmd_flags_t flags;
+    // True when the slot was filled in from the NetFn's wildcard registration
+    // and can still be claimed by a specific command registration.
+    bool wildcard;
+    // True when the command may be executed while in restricted mode.
+    bool whitelisted;
+    // Milliseconds the command may take before the host is answered
+    // IPMI_CC_TIMEOUT, 0 when it may take as long as it needs.
+    uint32_t deadline;
+};
 
 // Global data structure that contains the IPMI command handler's registrations.
-std::map<ipmi_fn_cmd_t, ipmi_fn_context_t> g_ipmid_router_map;
+// It is indexed directly by [NetFn][Cmd]; slots without a handler are
+// unregistered commands.
+std::array<std::array<ipmi_fn_entry_t, MAX_IPMI_CMD>, MAX_IPMI_NETFN>
+    g_ipmid_router_table{};
+
+// Number of hosts served
+static size_t ipmi_host_count()
+{
+    return std::count_if(hostContexts.begin(), hostContexts.end(),
+                         [](const std::unique_ptr<ipmi_host_context_t>& host)
+                         {
+                             return host != nullptr;
+                         });
+}
+
+// Finds the context of a host, set up the first time the host is heard from.
+// Returns nullptr for a new host once maxHosts are served: serving it as
+// another host would have it take that host's SEL reservation and queued
+// commands.
+static ipmi_host_context_t *ipmi_get_host(const std::string& key)
+{
+    // Host links that are gone free their slot, and their key for another
+    // link to be a new host under
+    for (auto& host : hostContexts)
+    {
+        if (host && host->id != 0 && host->linked && host->links == 0)
+        {
+            log<level::INFO>("No longer serving IPMI host",
+                             entry("HOST=%s", host->key.c_str()),
+                             entry("ID=%u", host->id));
+            host.reset();
+            hostsRefused = false;
+        }
+    }
+
+    for (auto& host : hostContexts)
+    {
+        if (host && host->key == key)
+        {
+            return host.get();
+        }
+    }
+
+    auto slot = std::find(hostContexts.begin(), hostContexts.end(), nullptr);
+    if (slot == hostContexts.end() && hostContexts.size() >= maxHosts)
+    {
+        if (!hostsRefused)
+        {
+            log<level::ERR>("Too many hosts, refusing the new ones",
+                            entry("HOST=%s", key.c_str()),
+                            entry("MAX=%zu", maxHosts));
+            hostsRefused = true;
+        }
+        return nullptr;
+    }
+    if (slot == hostContexts.end())
+    {
+        slot = hostContexts.insert(slot, nullptr);
+    }
+
+    auto host = std::make_unique<ipmi_host_context_t>();
+    host->id = slot - hostContexts.begin();
+    host->key = key;
+    host->cmdManager = std::make_unique<phosphor::host::command::Manager>(
+                           *sdbusp, events, key);
+    log<level::INFO>("Serving IPMI host",
+                     entry("HOST=%s", key.c_str()),
+                     entry("ID=%u", host->id));
+    *slot = std::move(host);
+    return slot->get();
+}
+
+// Sets up host 0, before any request is served
+void ipmi_init_hosts()
+{
+    ipmi_get_host(defaultHostPath);
+}
+
+void ipmi_release_hosts()
+{
+    // The requests left hold links, which let go of their host as they go,
+    // and the bridge ones a reference to their signal
+    for (auto& host : hostContexts)
+    {
+        if (host)
+        {
+            for (auto& request : host->bulkQueue)
+            {
+                sd_bus_message_unref(request.origin.m);
+            }
+            host->bulkQueue.clear();
+        }
+    }
+    hostContexts.clear();
+}
+
+// Only ever released from the event loop thread, like the requests holding
+// it. The host is reclaimed by the next ipmi_get_host().
+ipmi_host_link_t::~ipmi_host_link_t()
+{
+    sd_event_source_unref(source);
+    if (host)
+    {
+        host->links--;
+    }
+}
 
-// IPMI Spec, shared Reservation ID.
-unsigned short g_sel_reserve = 0xFFFF;
+// The host of the request being handled, host 0 outside of a handler
+static ipmi_host_context_t& ipmi_request_host()
+{
+    return requestHost ? *requestHost : *hostContexts.front();
+}
+
+ipmi_host_t ipmid_get_request_host(void)
+{
+    return ipmi_request_host().id;
+}
 
+// Each host has its own SEL reservation, so that one host reserving the SEL
+// doesn't cancel what another is in the middle of
 unsigned short get_sel_reserve_id(void)
 {
-    return g_sel_reserve;
+    return ipmi_request_host().selReserve;
+}
+
+unsigned short new_sel_reserve_id(void)
+{
+    auto& reserve = ipmi_request_host().selReserve;
+
+    // IPMI spec, Reservation ID, the value simply increases against each
+    // execution of reserve_sel command.
+    if (++reserve == 0)
+    {
+        reserve = 1;
+    }
+    return reserve;
 }
 
 namespace internal
@@ -94,337 +473,1731 @@ std::unique_ptr<settings::Objects> objects = nullptr;
 } // namespace cache
 } // namespace internal
 
-#ifndef HEXDUMP_COLS
-#define HEXDUMP_COLS 16
-#endif
+// Startup profile of the provider library being loaded, filled in by its
+// registrations. See ipmi_register_callback_handlers().
+struct ipmi_provider_profile_t
+{
+    uint64_t start = 0;
+    uint64_t firstRegistration = 0;
+    uint64_t lastRegistration = 0;
+    size_t commands = 0;
+};
+
+static ipmi_provider_profile_t *loadingProvider = nullptr;
+
+// True when [NetFn,Cmd] can still be registered, logs why it can't otherwise
+static bool ipmi_registration_allowed(ipmi_netfn_t netfn, ipmi_cmd_t cmd)
+{
+    if(netfn >= MAX_IPMI_NETFN)
+    {
+        log<level::ERR>("Invalid NetFn registration",
+                        entry("NETFN=0x%X", netfn),
+                        entry("CMD=0x%X", cmd));
+        return false;
+    }
+
+    // Check if the registration has already been made..
+    const auto& slot = g_ipmid_router_table[netfn][cmd];
+    if(slot.handler != nullptr && !slot.wildcard)
+    {
+        log<level::ERR>("Duplicate registration",
+                        entry("NETFN=0x%X", netfn),
+                        entry("CMD=0x%X", cmd));
+        return false;
+    }
+    return true;
+}
 
-void hexdump(FILE *s, void *mem, size_t len)
+// Method that gets called by shared libraries to get their command handlers registered
+void ipmi_register_callback(ipmi_netfn_t netfn, ipmi_cmd_t cmd, ipmi_context_t context,
+                            ipmid_callback_t handler, ipmi_cmd_privilege_t priv)
 {
-        unsigned int i, j;
+    ipmi_register_callback_flags(netfn, cmd, context, handler, priv,
+                                 IPMI_CMD_FLAG_NONE);
+}
 
-        for(i = 0; i < len + ((len % HEXDUMP_COLS) ? (HEXDUMP_COLS - len % HEXDUMP_COLS) : 0); i++)
+void ipmi_register_callback_flags(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
+                                  ipmi_context_t context,
+                                  ipmid_callback_t handler,
+                                  ipmi_cmd_privilege_t priv,
+                                  ipmi_cmd_flags_t flags)
+{
+    if(loadingProvider != nullptr)
+    {
+        auto now = monotonic_usec();
+        if(loadingProvider->commands++ == 0)
         {
-                /* print offset */
-                if(i % HEXDUMP_COLS == 0)
-                {
-                        fprintf(s,"0x%06x: ", i);
-                }
+            loadingProvider->firstRegistration = now;
+        }
+        loadingProvider->lastRegistration = now;
+    }
 
-                /* print hex data */
-                if(i < len)
-                {
-                        fprintf(s,"%02x ", 0xFF & ((char*)mem)[i]);
-                }
-                else /* end of block, just aligning for ASCII dump */
-                {
-                        fprintf(s,"   ");
-                }
+    if(!ipmi_registration_allowed(netfn, cmd))
+    {
+        return;
+    }
 
-                /* print ASCII dump */
-                if(i % HEXDUMP_COLS == (HEXDUMP_COLS - 1))
-                {
-                        for(j = i - (HEXDUMP_COLS - 1); j <= i; j++)
-                        {
-                                if(j >= len) /* end of block, not really printing */
-                                {
-                                        fputc(' ', s);
-                                }
-                                else if(isprint(((char*)mem)[j])) /* printable char */
-                                {
-                                        fputc(0xFF & ((char*)mem)[j], s);
-                                }
-                                else /* other char */
-                                {
-                                        fputc('.',s);
-                                }
-                        }
-                        fputc('\n',s);
-                }
+    auto& netfn_table = g_ipmid_router_table[netfn];
+
+    if(cmd == IPMI_CMD_WILDCARD)
+    {
+        // Resolve the wildcard now into every command of this NetFn that has
+        // no specific handler, so that routing never needs a second lookup.
+        for(auto& slot : netfn_table)
+        {
+            if(slot.handler == nullptr || slot.wildcard)
+            {
+                slot.handler = handler;
+                slot.context = context;
+                slot.priv = priv;
+                slot.flags = flags;
+                slot.wildcard = true;
+            }
         }
+    }
+
+    // This is a fresh registration.. Add it to the table. A specific command
+    // registration takes precedence over a previously resolved wildcard.
+    netfn_table[cmd].handler = handler;
+    netfn_table[cmd].context = context;
+    netfn_table[cmd].priv = priv;
+    netfn_table[cmd].flags = flags;
+    netfn_table[cmd].wildcard = false;
+
+    return;
 }
 
+void ipmi_invalidate_cached_responses(ipmi_netfn_t netfn, ipmi_cmd_t cmd)
+{
+    responseCache.invalidate(netfn, cmd);
+}
 
-// Method that gets called by shared libraries to get their command handlers registered
-void ipmi_register_callback(ipmi_netfn_t netfn, ipmi_cmd_t cmd, ipmi_context_t context,
-                            ipmid_callback_t handler, ipmi_cmd_privilege_t priv)
+namespace ipmi
+{
+namespace async
 {
-    // Pack NetFn and Command in one.
-    auto netfn_and_cmd = std::make_pair(netfn, cmd);
 
-    // Pack Function handler and Data in another.
-    auto handler_and_context = std::make_pair(handler, context);
+// Handlers registered through registerHandler(), the router table slots
+// point at them.
+std::list<Handler> handlers;
 
-    // Check if the registration has already been made..
-    auto iter = g_ipmid_router_map.find(netfn_and_cmd);
-    if(iter != g_ipmid_router_map.end())
+// Router table stand-in for asynchronous handlers, which can't produce their
+// response within a plain ipmi_netfn_router() call.
+static ipmi_ret_t unsupported(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
+                              ipmi_request_t request, ipmi_response_t response,
+                              ipmi_data_len_t data_len, ipmi_context_t context)
+{
+    *data_len = 0;
+    return IPMI_CC_UNSPECIFIED_ERROR;
+}
+
+void registerHandler(ipmi_netfn_t netfn, ipmi_cmd_t cmd, Handler&& handler,
+                     ipmi_cmd_privilege_t priv)
+{
+    // A refused registration must not keep its handler, nothing would ever
+    // release it
+    if(!ipmi_registration_allowed(netfn, cmd))
+    {
+        return;
+    }
+
+    handlers.push_back(std::move(handler));
+    ipmi_register_callback_flags(netfn, cmd, &handlers.back(), unsupported,
+                                 priv, IPMI_CMD_FLAG_ASYNC);
+}
+
+static int handleMethodReply(sd_bus_message *m, void *userdata,
+                             sd_bus_error *ret_error)
+{
+    std::unique_ptr<ReplyHandler> callback(
+        static_cast<ReplyHandler*>(userdata));
+    sdbusplus::message::message reply(m);
+
+    try
+    {
+        (*callback)(reply);
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>("Exception in D-Bus reply handler",
+                        entry("ERROR=%s", e.what()));
+    }
+    return 0;
+}
+
+int callMethod(sdbusplus::message::message& method, ReplyHandler&& callback)
+{
+    auto userdata = new ReplyHandler(std::move(callback));
+
+    int r = sd_bus_call_async(bus, NULL, method.get(), handleMethodReply,
+                              userdata, 0);
+    if (r < 0)
+    {
+        log<level::ERR>("Failed to queue D-Bus method call",
+                        entry("ERRNO=0x%X", -r));
+        delete userdata;
+    }
+    return r;
+}
+
+} // namespace async
+} // namespace ipmi
+
+// Folds the compiled in whitelist into the router table, so the restricted
+// mode check is answered by the same slot that holds the handler.
+void ipmi_init_router_whitelist()
+{
+    for(size_t netfn = 0; netfn < MAX_IPMI_NETFN; netfn++)
+    {
+        for(size_t cmd = 0; cmd < MAX_IPMI_CMD; cmd++)
+        {
+            g_ipmid_router_table[netfn][cmd].whitelisted =
+                ipmi_is_whitelisted(netfn, cmd);
+        }
+    }
+}
+
+// Folds the command deadlines configured in path into the router table, see
+// phosphor::ipmi::CommandDeadlines. Without the file no command has a
+// deadline.
+void ipmi_init_router_deadlines(const std::string& path)
+{
+    std::ifstream file(path);
+    if(!file.is_open())
+    {
+        return;
+    }
+
+    auto data = nlohmann::json::parse(file, nullptr, false);
+    if(data.is_discarded())
+    {
+        log<level::ERR>("Command deadlines JSON parser failure",
+                        entry("FILE=%s", path.c_str()));
+        return;
+    }
+
+    phosphor::ipmi::CommandDeadlines deadlines;
+    try
+    {
+        auto ignored = deadlines.parse(data);
+        if(ignored != 0)
+        {
+            log<level::ERR>("Invalid NetFn or Cmd in the command deadlines",
+                            entry("FILE=%s", path.c_str()),
+                            entry("ENTRIES=%zu", ignored));
+        }
+    }
+    catch(const nlohmann::json::exception& e)
+    {
+        log<level::ERR>("Invalid command deadlines",
+                        entry("FILE=%s", path.c_str()),
+                        entry("ERROR=%s", e.what()));
+        return;
+    }
+
+    for(size_t netfn = 0; netfn < MAX_IPMI_NETFN; netfn++)
+    {
+        for(size_t cmd = 0; cmd < MAX_IPMI_CMD; cmd++)
+        {
+            g_ipmid_router_table[netfn][cmd].deadline =
+                deadlines.get(netfn, cmd);
+        }
+    }
+}
+
+// Loads the request rate limits configured in path. Rates are in requests per
+// second, with bursts of up to burst requests, which defaults to the rate:
+//   {"bridge": {"rate": 200, "burst": 50},
+//    "commands": [{"netfn": 4, "rate": 50, "burst": 10},
+//                 {"netfn": 10, "cmd": 68, "rate": 0}]}
+// The bridge limit applies to each bridge on its own. An entry without "cmd"
+// limits the whole NetFn, a per command entry with a rate of 0 exempts the
+// command from the other limits. Without the file nothing is limited.
+void ipmi_init_rate_limits(const std::string& path)
+{
+    using Limit = phosphor::ipmi::RateLimiter::Limit;
+
+    std::ifstream file(path);
+    if(!file.is_open())
+    {
+        return;
+    }
+
+    auto data = nlohmann::json::parse(file, nullptr, false);
+    if(data.is_discarded())
+    {
+        log<level::ERR>("Rate limits JSON parser failure",
+                        entry("FILE=%s", path.c_str()));
+        return;
+    }
+
+    auto limitOf = [](const nlohmann::json& limit)
+    {
+        auto rate = limit.at("rate").get<uint32_t>();
+        return Limit{rate, limit.value("burst", rate)};
+    };
+
+    try
+    {
+        if(data.count("bridge"))
+        {
+            rateLimiter.limitBridges(limitOf(data["bridge"]));
+        }
+
+        for(const auto& command : data.value("commands",
+                                             nlohmann::json::array()))
+        {
+            unsigned netfn = command.at("netfn").get<unsigned>();
+            if(netfn >= MAX_IPMI_NETFN)
+            {
+                log<level::ERR>("Invalid NetFn in the rate limits",
+                                entry("NETFN=0x%X", netfn));
+                continue;
+            }
+            if(!command.count("cmd"))
+            {
+                rateLimiter.limitNetFn(netfn, limitOf(command));
+                continue;
+            }
+            unsigned cmd = command.at("cmd").get<unsigned>();
+            if(cmd >= MAX_IPMI_CMD)
+            {
+                log<level::ERR>("Invalid Cmd in the rate limits",
+                                entry("NETFN=0x%X", netfn),
+                                entry("CMD=0x%X", cmd));
+                continue;
+            }
+            rateLimiter.limitCommand(netfn, cmd, limitOf(command));
+        }
+    }
+    catch(const nlohmann::json::exception& e)
+    {
+        log<level::ERR>("Invalid rate limits",
+                        entry("FILE=%s", path.c_str()),
+                        entry("ERROR=%s", e.what()));
+    }
+}
+
+// Applies the rate limits to a request. Commands scheduled as critical are
+// only held to their own limit, a flood of other commands must not starve
+// them.
+static bool ipmi_admit(const ipmi_origin_t& origin, ipmi_netfn_t netfn,
+                       ipmi_cmd_t cmd,
+                       const ipmi_fn_entry_t& handler_and_context,
+                       uint64_t now)
+{
+    if(!rateLimiter.enabled())
+    {
+        return true;
+    }
+
+    auto sender = origin.link ? origin.link->transport->getName().c_str() :
+                                sd_bus_message_get_sender(origin.m);
+    return rateLimiter.admit(sender ? sender : "", netfn, cmd,
+                             handler_and_context.flags &
+                             IPMI_CMD_FLAG_PRIORITY_CRITICAL,
+                             now);
+}
+
+// True when [NetFn,Cmd] has a handler registered for it specifically, rather
+// than none or the NetFn's wildcard handler
+static bool ipmi_command_registered(uint8_t netfn, uint8_t cmd)
+{
+    if(netfn >= MAX_IPMI_NETFN)
+    {
+        return false;
+    }
+    const auto& slot = g_ipmid_router_table[netfn][cmd];
+    return slot.handler != nullptr && !slot.wildcard;
+}
+
+// Finds the router table slot handling [NetFn,Cmd]. Returns the completion
+// code to respond with when the command must not be executed.
+static ipmi_ret_t ipmi_netfn_lookup(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
+                                    const ipmi_fn_entry_t **slot)
+{
+    if(netfn >= MAX_IPMI_NETFN)
+    {
+        // No NetFn this wide can be whitelisted or registered.
+        return restricted_mode ? IPMI_CC_INSUFFICIENT_PRIVILEGE :
+                                 IPMI_CC_INVALID;
+    }
+
+    const auto& handler_and_context = g_ipmid_router_table[netfn][cmd];
+
+    // If restricted mode is true and command is not whitelisted, don't
+    // execute the command
+    if(restricted_mode && !handler_and_context.whitelisted)
+    {
+        log<level::ERR>("Net function not whitelisted",
+                        entry("NETFN=0x%X", netfn),
+                        entry("CMD=0x%X", cmd));
+        return IPMI_CC_INSUFFICIENT_PRIVILEGE;
+    }
+
+    // Wildcard registrations have already been resolved into the table, so a
+    // single lookup finds either the specific handler, the NetFn's wildcard
+    // handler or nothing at all.
+    if(handler_and_context.handler == nullptr)
+    {
+        /* Probing for unsupported commands is routine for hosts, so only
+         * report it in debug builds. */
+#ifdef __IPMI_DEBUG__
+        log<level::ERR>("No Registered handlers for NetFn",
+                        entry("NET_FUN=0x%X", netfn),
+                        entry("CMD=0x%X", cmd));
+#endif
+
+        // Respond with a 0xC1
+        return IPMI_CC_INVALID;
+    }
+
+    *slot = &handler_and_context;
+    return IPMI_CC_OK;
+}
+
+// Calls the handler of a router table slot and packs the response.
+static ipmi_ret_t ipmi_netfn_call(const ipmi_fn_entry_t& handler_and_context,
+                                  ipmi_netfn_t netfn, ipmi_cmd_t cmd,
+                                  ipmi_request_t request,
+                                  ipmi_response_t response,
+                                  ipmi_data_len_t data_len)
+{
+#ifdef __IPMI_DEBUG__
+    // We have either a perfect match -OR- a wild card atleast,
+    log<level::ERR>("Calling Net function",
+                    entry("NET_FUN=0x%X", netfn)
+                    entry("CMD=0x%X", cmd));
+#endif
+
+    // Creating a pointer type casted to char* to make sure we advance 1 byte
+    // when we advance pointer to next's address. advancing void * would not
+    // make sense.
+    char *respo = &((char *)response)[IPMI_CC_LEN];
+
+    // Response message from the plugin goes into a byte post the base response
+    ipmi_ret_t rc = (handler_and_context.handler) (netfn, cmd, request, respo,
+                                                   data_len,
+                                                   handler_and_context.context);
+
+    // Now copy the return code that we got from handler and pack it in first
+    // byte.
+    memcpy(response, &rc, IPMI_CC_LEN);
+
+    // Data length is now actual data + completion code.
+    *data_len = *data_len + IPMI_CC_LEN;
+
+    return rc;
+}
+
+// Packs the cached response to the request, if the command is cacheable and
+// there is one. Returns whether it did.
+static bool ipmi_cache_lookup(const ipmi_fn_entry_t& handler_and_context,
+                              ipmi_netfn_t netfn, ipmi_cmd_t cmd,
+                              const void *request, size_t sz,
+                              unsigned char *response, size_t *resplen)
+{
+    if(!(handler_and_context.flags & IPMI_CMD_FLAG_CACHEABLE))
+    {
+        return false;
+    }
+
+    auto cached = responseCache.find(netfn, cmd, request, sz);
+    if(cached == nullptr)
+    {
+        return false;
+    }
+
+    // Cached responses are only ever successful ones
+    memcpy(response, cached->data(), cached->size());
+    *resplen = cached->size();
+    return true;
+}
+
+// Keeps the packed response of a cacheable command. generation is the
+// cache's when the handler was called.
+static void ipmi_cache_store(const ipmi_fn_entry_t& handler_and_context,
+                             ipmi_netfn_t netfn, ipmi_cmd_t cmd,
+                             const void *request, size_t sz, ipmi_ret_t rc,
+                             const unsigned char *response, size_t resplen,
+                             uint64_t generation)
+{
+    if((handler_and_context.flags & IPMI_CMD_FLAG_CACHEABLE) &&
+       rc == IPMI_CC_OK)
+    {
+        responseCache.store(netfn, cmd, request, sz, response, resplen,
+                            generation);
+    }
+}
+
+// Looks at the table and calls corresponding handler functions.
+ipmi_ret_t ipmi_netfn_router(ipmi_netfn_t netfn, ipmi_cmd_t cmd, ipmi_request_t request,
+                      ipmi_response_t response, ipmi_data_len_t data_len)
+{
+    const ipmi_fn_entry_t *handler_and_context = nullptr;
+
+    ipmi_ret_t rc = ipmi_netfn_lookup(netfn, cmd, &handler_and_context);
+    if(rc != IPMI_CC_OK)
+    {
+        memcpy(response, &rc, IPMI_CC_LEN);
+        *data_len = IPMI_CC_LEN;
+        return rc;
+    }
+
+    size_t sz = *data_len;
+    if(ipmi_cache_lookup(*handler_and_context, netfn, cmd, request, sz,
+                         static_cast<unsigned char*>(response), data_len))
+    {
+        return IPMI_CC_OK;
+    }
+
+    auto generation = responseCache.generation();
+    rc = ipmi_netfn_call(*handler_and_context, netfn, cmd, request,
+                         response, data_len);
+    ipmi_cache_store(*handler_and_context, netfn, cmd, request, sz, rc,
+                     static_cast<unsigned char*>(response), *data_len,
+                     generation);
+    return rc;
+}
+
+
+
+
+// Completes the asynchronous sendMessage call made by send_ipmi_message(),
+// once the bridge has handed the response over to the host.
+static int handle_send_message_reply(sd_bus_message *reply, void *userdata,
+                                     sd_bus_error *ret_error)
+{
+    int r, pty;
+
+    if (sd_bus_message_is_method_error(reply, NULL)) {
+        const sd_bus_error *error = sd_bus_message_get_error(reply);
+        log<level::ERR>("Failed to call the method",
+                        entry("ERROR=%s", error->name),
+                        entry("ERRNO=0x%X",
+                              sd_bus_message_get_errno(reply)));
+        return 0;
+    }
+
+    r = sd_bus_message_read(reply, "x", &pty);
+    if (r < 0) {
+       log<level::ERR>("Failed to get a reply from the method",
+                        entry("ERRNO=0x%X", -r));
+    }
+
+    return 0;
+}
+
+static int send_ipmi_message(sd_bus_message *req, unsigned char seq, unsigned char netfn, unsigned char lun, unsigned char cmd, unsigned char cc, unsigned char *buf, unsigned char len) {
+
+    sd_bus_message *m=NULL;
+    const char *dest, *path;
+    int r;
+
+    dest = sd_bus_message_get_sender(req);
+    path = sd_bus_message_get_path(req);
+
+    r = sd_bus_message_new_method_call(bus,&m,dest,path,
+                                       DBUS_INTF,
+                                       "sendMessage");
+    if (r < 0) {
+        log<level::ERR>("Failed to add the method object",
+                        entry("ERRNO=0x%X", -r));
+        return -1;
+    }
+
+
+    // Responses in IPMI require a bit set.  So there ya go...
+    netfn |= 0x01;
+
+
+    // Add the bytes needed for the methods to be called
+    r = sd_bus_message_append(m, "yyyyy", seq, netfn, lun, cmd, cc);
+    if (r < 0) {
+        log<level::ERR>("Failed add the netfn and others",
+                        entry("ERRNO=0x%X", -r));
+        goto final;
+    }
+
+    r = sd_bus_message_append_array(m, 'y', buf, len);
+    if (r < 0) {
+        log<level::ERR>("Failed to add the string of response bytes",
+                        entry("ERRNO=0x%X", -r));
+        goto final;
+    }
+
+
+
+    // Call the IPMI responder on the bus so the message can be sent to the
+    // CEC. The reply is handled from the event loop, so that the next request
+    // can be processed while the bridge is still busy with this one.
+    r = sd_bus_call_async(bus, NULL, m, handle_send_message_reply, NULL, 0);
+    if (r < 0) {
+        log<level::ERR>("Failed to call the method",
+                        entry("DEST=%s", dest),
+                        entry("PATH=%s", path),
+                        entry("ERRNO=0x%X", -r));
+    }
+
+final:
+    m = sd_bus_message_unref(m);
+
+    return r < 0 ? -1 : 0;
+}
+
+// Whether the host is held to the whitelist under a RestrictionMode value
+static bool ipmi_restricted(const std::string& mode)
+{
+    using namespace sdbusplus::xyz::openbmc_project::Control::Security::server;
+    return RestrictionMode::convertModesFromString(mode) ==
+           RestrictionMode::Modes::Whitelist;
+}
+
+void cache_restricted_mode()
+{
+    using namespace internal;
+    using namespace internal::cache;
+    const auto& restrictionModeSetting =
+        objects->map.at(restrictionModeIntf).front();
+    try
+    {
+        auto mode = objects->get(restrictionModeSetting, restrictionModeIntf,
+                                 "RestrictionMode");
+        restricted_mode = ipmi_restricted(mode.get<std::string>());
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>("Error in RestrictionMode Get",
+                        entry("ERROR=%s", e.what()));
+        // Fail-safe to true.
+        restricted_mode = true;
+    }
+}
+
+// The new mode is taken from the signal itself, the settings mirror may not
+// have been handed the signal yet
+static int handle_restricted_mode_change(sd_bus_message *m, void *user_data,
+                                                    sd_bus_error *ret_error)
+{
+    sdbusplus::message::message msg(m);
+    std::string interface;
+    ipmi::PropertyMap changed;
+    try
+    {
+        msg.read(interface, changed);
+        auto mode = changed.find("RestrictionMode");
+        if (mode != changed.end())
+        {
+            restricted_mode = ipmi_restricted(mode->second.get<std::string>());
+        }
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>("Error in RestrictionMode change",
+                        entry("ERROR=%s", e.what()));
+        // Fail-safe to true.
+        restricted_mode = true;
+    }
+    return 0;
+}
+
+// Sends a response down a host link, the fd is watched for writability
+// while the transport has responses queued
+static int send_host_message(ipmi_host_link_t& link, unsigned char seq,
+                             unsigned char netfn, unsigned char lun,
+                             unsigned char cmd, unsigned char cc,
+                             const unsigned char *buf, size_t len)
+{
+    int r = link.transport->send(seq, netfn, lun, cmd, cc, buf, len);
+    if (r < 0)
+    {
+        log<level::ERR>("Failed to send the response to the host",
+                        entry("TRANSPORT=%s",
+                              link.transport->getName().c_str()),
+                        entry("ERRNO=0x%X", -r));
+        return -1;
+    }
+
+    if (link.transport->pending() && link.source != nullptr)
+    {
+        sd_event_source_set_io_events(link.source, EPOLLIN | EPOLLOUT);
+    }
+    return 0;
+}
+
+// Sends the packed response of a routed command back to where the request
+// came from
+static int send_ipmi_response(const ipmi_origin_t& origin,
+                              unsigned char sequence,
+                              unsigned char netfn, unsigned char lun,
+                              unsigned char cmd, ipmi_ret_t rc,
+                              unsigned char *response, size_t resplen)
+{
+    int r = 0;
+
+    if(rc != 0)
+    {
+#ifdef __IPMI_DEBUG__
+        log<level::ERR>("ERROR in handling NetFn",
+                        entry("ERRNO=0x%X", -rc),
+                        entry("NET_FUN=0x%X", netfn),
+                        entry("CMD=0x%X", cmd));
+#endif
+        resplen = 0;
+    }
+    else
+    {
+        resplen = resplen - 1; // first byte is for return code.
+    }
+
+    if (ipmiTrace.enabled())
+    {
+        ipmiTrace.record(phosphor::ipmi::TraceRing::Direction::response,
+                         sequence, netfn, lun, cmd, response[0],
+                         response + 1, resplen);
+    }
+
+    // Send the response buffer from the ipmi command
+    if (origin.link)
+    {
+        r = send_host_message(*origin.link, sequence, netfn, lun, cmd,
+                              response[0], response + 1, resplen);
+    }
+    else
+    {
+        r = send_ipmi_message(origin.m, sequence, netfn, lun, cmd,
+                              response[0], response + 1, resplen);
+    }
+    if (r < 0) {
+        log<level::ERR>("Failed to send the response message");
+        return -1;
+    }
+
+    return 0;
+}
+
+// Accounts for a command once its response has been sent
+static void ipmi_account_command(unsigned char sequence, unsigned char netfn,
+                                 unsigned char lun, unsigned char cmd,
+                                 const void *request, size_t sz,
+                                 const unsigned char *response,
+                                 size_t resplen, uint64_t received,
+                                 uint64_t handlerTime, uint32_t calls)
+{
+    auto totalTime = monotonic_usec() - received;
+
+    commandStats.record(netfn, cmd, response[0], handlerTime, totalTime,
+                        calls);
+
+    if (captureWriter)
+    {
+        phosphor::ipmi::capture::RecordHeader record{};
+        record.timestamp = received - captureWriter->started();
+        record.handlerTime = std::min<uint64_t>(handlerTime, UINT32_MAX);
+        record.totalTime = std::min<uint64_t>(totalTime, UINT32_MAX);
+        record.seq = sequence;
+        record.netfn = netfn;
+        record.lun = lun;
+        record.cmd = cmd;
+        record.cc = response[0];
+
+        // Only successful responses carry data past the completion code
+        size_t datalen = (record.cc == IPMI_CC_OK && resplen > IPMI_CC_LEN) ?
+                         resplen - IPMI_CC_LEN : 0;
+        int r = captureWriter->write(record, request, sz,
+                                     response + IPMI_CC_LEN, datalen);
+        if (r < 0)
+        {
+            log<level::ERR>("Failed to capture the command, stopping",
+                            entry("ERRNO=0x%X", -r));
+            captureWriter.reset();
+        }
+    }
+}
+
+// A request whose response is produced after it has been routed, by a
+// worker thread or an asynchronous handler.
+struct ipmi_deferred_request_t
+{
+    ipmi_deferred_request_t(const ipmi_origin_t& origin,
+                            unsigned char sequence, unsigned char netfn,
+                            unsigned char lun, unsigned char cmd,
+                            const void *request, size_t sz) :
+        origin{sd_bus_message_ref(origin.m), origin.link, origin.host},
+        sequence(sequence), netfn(netfn), lun(lun), cmd(cmd),
+        request(static_cast<const uint8_t*>(request),
+                static_cast<const uint8_t*>(request) + sz),
+        resplen(sz), received(monotonic_usec())
+    {
+    }
+
+    ipmi_deferred_request_t(const ipmi_deferred_request_t&) = delete;
+    ipmi_deferred_request_t& operator=(const ipmi_deferred_request_t&) =
+        delete;
+
+    // Only ever released from the event loop thread. The host is owed a
+    // response even when whoever was to produce it has given up.
+    ~ipmi_deferred_request_t()
+    {
+        if (!responded)
+        {
+            log<level::ERR>("Request dropped without a response",
+                            entry("NETFN=0x%X", netfn),
+                            entry("CMD=0x%X", cmd));
+            pack(IPMI_CC_UNSPECIFIED_ERROR, nullptr, 0);
+            respond();
+        }
+        sd_event_source_unref(deadlineSource);
+        sd_bus_message_unref(origin.m);
+    }
+
+    // Has the event loop answer IPMI_CC_TIMEOUT if no response was sent by
+    // when, in CLOCK_MONOTONIC usec. 0 leaves the request without deadline.
+    void arm(uint64_t when)
+    {
+        deadline = when;
+        if (when == 0)
+        {
+            return;
+        }
+        int r = sd_event_add_time(
+                    events, &deadlineSource, CLOCK_MONOTONIC, when, 0,
+                    [](sd_event_source *es, uint64_t usec, void *userdata)
+                    {
+                        static_cast<ipmi_deferred_request_t*>(userdata)->
+                            expire();
+                        return 0;
+                    }, this);
+        if (r < 0)
+        {
+            log<level::ERR>("Failed to arm the command deadline",
+                            entry("NETFN=0x%X", netfn),
+                            entry("CMD=0x%X", cmd),
+                            entry("ERRNO=0x%X", -r));
+        }
+    }
+
+    // Answers IPMI_CC_TIMEOUT in place of the response still being produced.
+    // The response buffer is left alone, a worker may still be writing it,
+    // and whatever ends up in it is discarded.
+    void expire()
+    {
+        if (responded)
+        {
+            return;
+        }
+        responded = true;
+        expired = true;
+        log<level::ERR>("Command missed its deadline",
+                        entry("NETFN=0x%X", netfn),
+                        entry("CMD=0x%X", cmd));
+        unsigned char timeout = IPMI_CC_TIMEOUT;
+        send_ipmi_response(origin, sequence, netfn, lun, cmd, timeout,
+                           &timeout, IPMI_CC_LEN);
+        ipmi_account_command(sequence, netfn, lun, cmd, request.data(),
+                             request.size(), &timeout, IPMI_CC_LEN, received,
+                             monotonic_usec() - received, 0);
+    }
+
+    // Packs the completion code and data into the response buffer
+    void pack(ipmi_ret_t cc, const uint8_t *data, size_t len)
+    {
+        len = std::min(len, sizeof(response) - IPMI_CC_LEN);
+        rc = cc;
+        response[0] = cc;
+        if (len)
+        {
+            memcpy(&response[IPMI_CC_LEN], data, len);
+        }
+        resplen = len + IPMI_CC_LEN;
+    }
+
+    // Sends the response, once
+    void respond()
+    {
+        if (responded)
+        {
+            return;
+        }
+        responded = true;
+        deadlineSource = sd_event_source_unref(deadlineSource);
+        send_ipmi_response(origin, sequence, netfn, lun, cmd, rc, response,
+                           resplen);
+        if (cacheable && rc == IPMI_CC_OK)
+        {
+            responseCache.store(netfn, cmd, request.data(), request.size(),
+                                response, resplen, cacheGeneration);
+        }
+        ipmi_account_command(sequence, netfn, lun, cmd, request.data(),
+                             request.size(), response, resplen, received,
+                             handlerTime, calls);
+    }
+
+    // Where the response goes, its signal referenced
+    ipmi_origin_t origin;
+    unsigned char sequence, netfn, lun, cmd;
+    std::vector<uint8_t> request;
+    unsigned char response[MAX_IPMI_BUFFER] = {0};
+    size_t resplen;
+    ipmi_ret_t rc = IPMI_CC_OK;
+    bool responded = false;
+    // When the signal was handled, and the handler's cost
+    uint64_t received;
+    uint64_t handlerTime = 0;
+    uint32_t calls = 0;
+    // Set when the response is to be cached, and the cache's generation
+    // when the request was dispatched
+    bool cacheable = false;
+    uint64_t cacheGeneration = 0;
+    // When the response is due, 0 if it has no deadline, and the timer
+    // answering for the handler when it is late. Set once expire() did.
+    uint64_t deadline = 0;
+    sd_event_source *deadlineSource = nullptr;
+    bool expired = false;
+};
+
+static int handle_worker_completions(sd_event_source *es, int fd,
+                                     uint32_t revents, void *userdata)
+{
+    workerPool->runCompletions();
+    return 0;
+}
+
+// Scheduling class of a command registered with flags
+static Priority ipmi_flags_priority(ipmi_cmd_flags_t flags)
+{
+    if (flags & IPMI_CMD_FLAG_PRIORITY_CRITICAL)
+    {
+        return Priority::critical;
+    }
+    if (flags & IPMI_CMD_FLAG_PRIORITY_BULK)
+    {
+        return Priority::bulk;
+    }
+    return Priority::normal;
+}
+
+// Runs a thread safe handler on a worker thread, the response is sent once
+// the event loop picks up the completion.
+static int dispatch_to_worker(const ipmi_origin_t& origin,
+                              unsigned char sequence, unsigned char netfn,
+                              unsigned char lun, unsigned char cmd,
+                              const ipmi_fn_entry_t& handler_and_context,
+                              const void *request, size_t sz,
+                              uint64_t deadline, Priority priority)
+{
+    auto req = std::make_shared<ipmi_deferred_request_t>(origin, sequence,
+                                                         netfn, lun, cmd,
+                                                         request, sz);
+    auto host = origin.host;
+
+    // Once several hosts are served, each only gets its share of the queue,
+    // so a host flooding slow commands doesn't keep the others' waiting
+    auto hosts = ipmi_host_count();
+    if (hosts > 1 && priority != Priority::critical &&
+        host->inWorkers >= std::max<size_t>(IPMI_WORKER_QUEUE_DEPTH / hosts,
+                                            1))
+    {
+        req->pack(IPMI_CC_BUSY, nullptr, 0);
+        req->respond();
+        return 0;
+    }
+
+    req->arm(deadline);
+    req->cacheable = handler_and_context.flags & IPMI_CMD_FLAG_CACHEABLE;
+    req->cacheGeneration = responseCache.generation();
+
+    auto work = [req, &handler_and_context]()
+    {
+        if (workerBus == nullptr)
+        {
+            req->pack(IPMI_CC_BUSY, nullptr, 0);
+            return;
+        }
+        auto start = monotonic_usec();
+        if (phosphor::ipmi::overdue(req->deadline, start))
+        {
+            // Waited out its deadline in the queue
+            req->pack(IPMI_CC_TIMEOUT, nullptr, 0);
+            return;
+        }
+        busCalls = 0;
+        callDeadline = req->deadline;
+        requestHost = req->origin.host;
+        try
+        {
+            req->rc = ipmi_netfn_call(handler_and_context, req->netfn,
+                                      req->cmd, req->request.data(),
+                                      req->response, &req->resplen);
+        }
+        catch (const std::exception& e)
+        {
+            log<level::ERR>("Exception in worker handler",
+                            entry("NETFN=0x%X", req->netfn),
+                            entry("CMD=0x%X", req->cmd),
+                            entry("ERROR=%s", e.what()));
+            req->pack(IPMI_CC_UNSPECIFIED_ERROR, nullptr, 0);
+        }
+        callDeadline = 0;
+        requestHost = nullptr;
+        auto end = monotonic_usec();
+        if (phosphor::ipmi::overdue(req->deadline, end))
+        {
+            // The event loop may not have got to answer for it yet
+            req->pack(IPMI_CC_TIMEOUT, nullptr, 0);
+        }
+        req->handlerTime = end - start;
+        req->calls = busCalls;
+    };
+
+    auto completion = [req, host]()
+    {
+        host->inWorkers--;
+        req->respond();
+    };
+
+    host->inWorkers++;
+    if (!workerPool->submit(std::move(work), std::move(completion),
+                            priority))
+    {
+        // All the workers are busy and the queue is full, let the host retry
+        host->inWorkers--;
+        req->pack(IPMI_CC_BUSY, nullptr, 0);
+        req->respond();
+    }
+
+    return 0;
+}
+
+// Hands the request to an asynchronous handler, which responds whenever it
+// is done.
+static int dispatch_async(const ipmi_origin_t& origin,
+                          unsigned char sequence, unsigned char netfn,
+                          unsigned char lun, unsigned char cmd,
+                          const ipmi_fn_entry_t& handler_and_context,
+                          const void *request, size_t sz, uint64_t deadline)
+{
+    auto req = std::make_shared<ipmi_deferred_request_t>(origin, sequence,
+                                                         netfn, lun, cmd,
+                                                         request, sz);
+    req->arm(deadline);
+    auto handler = static_cast<const ipmi::async::Handler*>(
+                       handler_and_context.context);
+
+    ipmi::async::Responder respond =
+        [req](ipmi_ret_t cc, const ipmi::async::Payload& data)
+        {
+            if (req->expired)
+            {
+                // Already answered IPMI_CC_TIMEOUT
+                return;
+            }
+            if (req->responded)
+            {
+                log<level::ERR>("Asynchronous handler responded twice",
+                                entry("NETFN=0x%X", req->netfn),
+                                entry("CMD=0x%X", req->cmd));
+                return;
+            }
+            // Asynchronous handlers are accounted until they respond
+            req->handlerTime = monotonic_usec() - req->received;
+            req->pack(cc, data.data(), data.size());
+            req->respond();
+        };
+
+    callDeadline = deadline;
+    requestHost = origin.host;
+    try
+    {
+        (*handler)(netfn, cmd, req->request, std::move(respond));
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>("Exception in asynchronous handler",
+                        entry("NETFN=0x%X", netfn),
+                        entry("CMD=0x%X", cmd),
+                        entry("ERROR=%s", e.what()));
+        if (!req->responded)
+        {
+            req->handlerTime = monotonic_usec() - req->received;
+            req->pack(IPMI_CC_UNSPECIFIED_ERROR, nullptr, 0);
+            req->respond();
+        }
+    }
+    callDeadline = 0;
+    requestHost = nullptr;
+    req->calls += busCalls;
+
+    return 0;
+}
+
+// Routes a request and responds to it, unless it has been handed to a worker
+// or an asynchronous handler.
+static int ipmi_process_request(const ipmi_pending_request_t& pending)
+{
+    const auto& origin = pending.origin;
+    auto received = pending.received;
+    int r = 0;
+    unsigned char sequence, netfn, lun, cmd;
+    const void *request;
+    size_t sz;
+    size_t resplen =MAX_IPMI_BUFFER;
+    unsigned char response[MAX_IPMI_BUFFER];
+    const ipmi_fn_entry_t *handler_and_context = nullptr;
+    ipmi_ret_t rc;
+    uint64_t handlerTime = 0;
+    uint64_t deadline = 0;
+
+    memset(response, 0, MAX_IPMI_BUFFER);
+
+    if (origin.link)
+    {
+        sequence = pending.message.seq;
+        netfn = pending.message.netfn;
+        lun = pending.message.lun;
+        cmd = pending.message.cmd;
+        request = pending.message.data.data();
+        sz = pending.message.data.size();
+    }
+    else
+    {
+        r = sd_bus_message_read(origin.m, "yyyy",  &sequence, &netfn, &lun,
+                                &cmd);
+        if (r < 0) {
+            log<level::ERR>("Failed to parse signal message",
+                            entry("ERRNO=0x%X", -r));
+            return -1;
+        }
+
+        r = sd_bus_message_read_array(origin.m, 'y',  &request, &sz );
+        if (r < 0) {
+            log<level::ERR>("Failed to parse signal message",
+                            entry("ERRNO=0x%X", -r));
+            return -1;
+        }
+    }
+
+    if (ipmiTrace.enabled())
+    {
+        ipmiTrace.record(phosphor::ipmi::TraceRing::Direction::request,
+                         sequence, netfn, lun, cmd, 0, request, sz);
+    }
+
+    // Allow the length field to be used for both input and output of the
+    // ipmi call
+    resplen = sz;
+    busCalls = 0;
+
+    // Now that we have parsed the entire byte array from the caller
+    // we can call the ipmi router to do the work...
+    rc = ipmi_netfn_lookup(netfn, cmd, &handler_and_context);
+    if(rc == IPMI_CC_OK)
+    {
+        // The deadline runs from when the signal was received, so time
+        // spent waiting in the batch or bulk queues counts against it
+        deadline = phosphor::ipmi::dueBy(handler_and_context->deadline,
+                                         received);
+    }
+
+    if(rc != IPMI_CC_OK)
+    {
+        memcpy(response, &rc, IPMI_CC_LEN);
+        resplen = IPMI_CC_LEN;
+    }
+    else if(!ipmi_admit(origin, netfn, cmd, *handler_and_context, received))
+    {
+        // Over a rate limit, the host is to retry later. Only counted as
+        // refused, so the flood doesn't skew the latency statistics.
+        rc = IPMI_CC_BUSY;
+        memcpy(response, &rc, IPMI_CC_LEN);
+        commandStats.reject(netfn, cmd);
+        return send_ipmi_response(origin, sequence, netfn, lun, cmd, rc,
+                                  response, IPMI_CC_LEN);
+    }
+    else if(ipmi_cache_lookup(*handler_and_context, netfn, cmd, request, sz,
+                              response, &resplen))
+    {
+        // Served without calling the handler
+    }
+    else if(phosphor::ipmi::overdue(deadline, monotonic_usec()))
+    {
+        rc = IPMI_CC_TIMEOUT;
+        memcpy(response, &rc, IPMI_CC_LEN);
+        resplen = IPMI_CC_LEN;
+    }
+    else if(handler_and_context->flags & IPMI_CMD_FLAG_ASYNC)
+    {
+        return dispatch_async(origin, sequence, netfn, lun, cmd,
+                              *handler_and_context, request, sz, deadline);
+    }
+    else if(workerPool &&
+            (handler_and_context->flags & IPMI_CMD_FLAG_THREAD_SAFE))
+    {
+        return dispatch_to_worker(origin, sequence, netfn, lun, cmd,
+                                  *handler_and_context, request, sz,
+                                  deadline, pending.priority);
+    }
+    else
+    {
+        auto generation = responseCache.generation();
+        callDeadline = deadline;
+        requestHost = origin.host;
+        rc = ipmi_netfn_call(*handler_and_context, netfn, cmd,
+                             (void *)request, (void *)response, &resplen);
+        callDeadline = 0;
+        requestHost = nullptr;
+        auto end = monotonic_usec();
+        handlerTime = end - received;
+        if(phosphor::ipmi::overdue(deadline, end))
+        {
+            // The host has likely given up on it. The late response isn't
+            // cached, so a retry calls the handler again.
+            log<level::ERR>("Command missed its deadline",
+                            entry("NETFN=0x%X", netfn),
+                            entry("CMD=0x%X", cmd));
+            rc = IPMI_CC_TIMEOUT;
+            memcpy(response, &rc, IPMI_CC_LEN);
+            resplen = IPMI_CC_LEN;
+        }
+        else
+        {
+            ipmi_cache_store(*handler_and_context, netfn, cmd, request, sz,
+                             rc, response, resplen, generation);
+        }
+    }
+
+    r = send_ipmi_response(origin, sequence, netfn, lun, cmd, rc, response,
+                           resplen);
+    ipmi_account_command(sequence, netfn, lun, cmd, request, sz, response,
+                         resplen, received, handlerTime, busCalls);
+    return r;
+}
+
+// Scheduling class of a command, from the flags of its router table slot
+static Priority ipmi_command_priority(unsigned char netfn, unsigned char cmd)
+{
+    if (netfn >= MAX_IPMI_NETFN)
+    {
+        return Priority::normal;
+    }
+
+    return ipmi_flags_priority(g_ipmid_router_table[netfn][cmd].flags);
+}
+
+// Scheduling class of the request of a ReceivedMessage signal
+static Priority ipmi_request_priority(sd_bus_message *m)
+{
+    unsigned char sequence, netfn, lun, cmd;
+
+    int r = sd_bus_message_read(m, "yyyy", &sequence, &netfn, &lun, &cmd);
+    sd_bus_message_rewind(m, true);
+    if (r < 0)
+    {
+        return Priority::normal;
+    }
+
+    return ipmi_command_priority(netfn, cmd);
+}
+
+// Queues a bulk request, to be processed once nothing more urgent is pending
+static void ipmi_queue_bulk(ipmi_pending_request_t&& request)
+{
+    auto host = request.origin.host;
+    if (bulkHosts.empty())
+    {
+        sd_event_source_set_enabled(bulkSource, SD_EVENT_ONESHOT);
+    }
+    if (host->bulkQueue.empty())
+    {
+        bulkHosts.push_back(host);
+    }
+
+    // Armed, the timer is already due before any queued request
+    int enabled = SD_EVENT_OFF;
+    sd_event_source_get_enabled(bulkTimer, &enabled);
+    if (enabled == SD_EVENT_OFF)
+    {
+        sd_event_source_set_time(bulkTimer, request.received + maxBulkWait);
+        sd_event_source_set_enabled(bulkTimer, SD_EVENT_ONESHOT);
+    }
+    host->bulkQueue.push_back(std::move(request));
+}
+
+// Runs at idle priority, so the event loop only gets here when no request
+// signal or worker completion is pending. Bulk requests are processed one
+// per pass for the same reason, taking one from each host in turn.
+static int handle_bulk(sd_event_source *es, void *userdata)
+{
+    // handle_bulk_overdue() may have taken them all
+    if (bulkHosts.empty())
+    {
+        return 0;
+    }
+
+    auto host = bulkHosts.front();
+    bulkHosts.pop_front();
+    auto request = std::move(host->bulkQueue.front());
+    host->bulkQueue.pop_front();
+    if (!host->bulkQueue.empty())
+    {
+        bulkHosts.push_back(host);
+    }
+    if (!bulkHosts.empty())
+    {
+        sd_event_source_set_enabled(bulkSource, SD_EVENT_ONESHOT);
+    }
+
+    ipmi_process_request(request);
+    sd_bus_message_unref(request.origin.m);
+    return 0;
+}
+
+// Processes the bulk requests that have waited maxBulkWait as normal ones,
+// then arms the timer for the oldest of those left
+static int handle_bulk_overdue(sd_event_source *es, uint64_t usec,
+                               void *userdata)
+{
+    auto now = monotonic_usec();
+    uint64_t next = 0;
+
+    // Taken out first, the queues are each oldest first
+    std::vector<ipmi_pending_request_t> overdue;
+    for (auto it = bulkHosts.begin(); it != bulkHosts.end();)
+    {
+        auto& queue = (*it)->bulkQueue;
+        while (!queue.empty() && queue.front().received + maxBulkWait <= now)
+        {
+            overdue.push_back(std::move(queue.front()));
+            queue.pop_front();
+        }
+        if (queue.empty())
+        {
+            it = bulkHosts.erase(it);
+            continue;
+        }
+
+        auto due = queue.front().received + maxBulkWait;
+        next = (next == 0) ? due : std::min(next, due);
+        ++it;
+    }
+    if (next != 0)
+    {
+        sd_event_source_set_time(es, next);
+        sd_event_source_set_enabled(es, SD_EVENT_ONESHOT);
+    }
+
+    for (auto& request : overdue)
+    {
+        request.priority = Priority::normal;
+        ipmi_process_request(request);
+        sd_bus_message_unref(request.origin.m);
+    }
+    return 0;
+}
+
+// Processes a request as it is received, unless it is to be batched or is a
+// bulk request
+static int ipmi_receive_request(ipmi_pending_request_t&& request)
+{
+    if (batchLimit == 0)
+    {
+        if (request.priority == Priority::bulk)
+        {
+            sd_bus_message_ref(request.origin.m);
+            ipmi_queue_bulk(std::move(request));
+            return 0;
+        }
+        return ipmi_process_request(request);
+    }
+
+    // The batch is processed by a deferred event, once the current dispatch
+    // has returned.
+    if (batchQueue.empty())
+    {
+        sd_event_source_set_enabled(batchSource, SD_EVENT_ONESHOT);
+    }
+    sd_bus_message_ref(request.origin.m);
+    batchQueue.push_back(std::move(request));
+    return 0;
+}
+
+// Answers IPMI_CC_BUSY to the request of a bridge whose host isn't served,
+// see ipmi_get_host()
+static int ipmi_refuse_request(sd_bus_message *m)
+{
+    unsigned char sequence, netfn, lun, cmd;
+
+    int r = sd_bus_message_read(m, "yyyy", &sequence, &netfn, &lun, &cmd);
+    if (r < 0)
+    {
+        log<level::ERR>("Failed to parse signal message",
+                        entry("ERRNO=0x%X", -r));
+        return -1;
+    }
+
+    unsigned char rc = IPMI_CC_BUSY;
+    return send_ipmi_response({m, nullptr, nullptr}, sequence, netfn, lun,
+                              cmd, rc, &rc, IPMI_CC_LEN);
+}
+
+static int handle_ipmi_command(sd_bus_message *m, void *user_data, sd_bus_error
+                         *ret_error) {
+    // Each bridge path is a host of its own
+    auto path = sd_bus_message_get_path(m);
+    auto host = ipmi_get_host(path ? path : defaultHostPath);
+    if (host == nullptr)
+    {
+        return ipmi_refuse_request(m);
+    }
+    return ipmi_receive_request({{m, nullptr, host}, {}, monotonic_usec(),
+                                 ipmi_request_priority(m), 0});
+}
+
+// Stops serving a host link. Requests still being handled keep it until
+// they have responded, their responses are dropped.
+static void ipmi_close_host_link(ipmi_host_link_t& link)
+{
+    link.source = sd_event_source_unref(link.source);
+    auto it = std::find_if(hostLinks.begin(), hostLinks.end(),
+                           [&link](const std::shared_ptr<ipmi_host_link_t>& l)
+                           {
+                               return l.get() == &link;
+                           });
+    if (it != hostLinks.end())
+    {
+        hostLinks.erase(it);
+    }
+}
+
+// Reads the requests of a host link, and writes its queued responses once
+// the fd is writable
+static int handle_host_link(sd_event_source *es, int fd, uint32_t revents,
+                            void *userdata)
+{
+    auto link = static_cast<ipmi_host_link_t*>(userdata)->shared_from_this();
+    auto& transport = *link->transport;
+    int r = 0;
+
+    if (revents & EPOLLOUT)
+    {
+        r = transport.flush();
+        if (r >= 0 && !transport.pending())
+        {
+            sd_event_source_set_io_events(es, EPOLLIN);
+        }
+    }
+
+    if (r >= 0 && (revents & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+    {
+        std::vector<phosphor::ipmi::HostRequest> requests;
+        r = transport.receive(requests);
+        auto received = monotonic_usec();
+        for (auto& message : requests)
+        {
+            auto priority = ipmi_command_priority(message.netfn, message.cmd);
+            ipmi_receive_request({{nullptr, link, link->host},
+                                  std::move(message), received, priority,
+                                  0});
+        }
+    }
+
+    if (r == -EPIPE)
+    {
+        log<level::INFO>("Host transport closed",
+                         entry("TRANSPORT=%s", transport.getName().c_str()));
+        ipmi_close_host_link(*link);
+    }
+    else if (r < 0)
+    {
+        log<level::ERR>("Host transport failed, closing it",
+                        entry("TRANSPORT=%s", transport.getName().c_str()),
+                        entry("ERRNO=0x%X", -r));
+        ipmi_close_host_link(*link);
+    }
+    return 0;
+}
+
+// Starts serving requests from a host transport
+static int ipmi_add_host_link(
+    std::unique_ptr<phosphor::ipmi::HostTransport> transport)
+{
+    auto link = std::make_shared<ipmi_host_link_t>(std::move(transport));
+    link->host = ipmi_get_host(link->transport->getName());
+    if (link->host == nullptr)
     {
-        log<level::ERR>("Duplicate registration",
-                        entry("NETFN=0x%X", netfn),
-                        entry("CMD=0x%X", cmd));
+        // Closed along with the link
+        return -EBUSY;
     }
-    else
+    link->host->links++;
+    link->host->linked = true;
+    int r = sd_event_add_io(events, &link->source,
+                            link->transport->getFd(), EPOLLIN,
+                            handle_host_link, link.get());
+    if (r < 0)
     {
-        // This is a fresh registration.. Add it to the map.
-        g_ipmid_router_map.emplace(netfn_and_cmd, handler_and_context);
+        log<level::ERR>("Failed to watch the host transport",
+                        entry("TRANSPORT=%s",
+                              link->transport->getName().c_str()),
+                        entry("ERRNO=0x%X", -r));
+        return r;
     }
 
-    return;
+    log<level::INFO>("Serving IPMI host transport",
+                     entry("TRANSPORT=%s",
+                           link->transport->getName().c_str()));
+    hostLinks.push_back(std::move(link));
+    return 0;
 }
 
-// Looks at the map and calls corresponding handler functions.
-ipmi_ret_t ipmi_netfn_router(ipmi_netfn_t netfn, ipmi_cmd_t cmd, ipmi_request_t request,
-                      ipmi_response_t response, ipmi_data_len_t data_len)
+// Serves each connection to a listening socket handed over by systemd as a
+// host link of its own
+static int handle_host_listener(sd_event_source *es, int fd,
+                                uint32_t revents, void *userdata)
 {
-    // return from the Command handlers.
-    ipmi_ret_t rc = IPMI_CC_INVALID;
-
-    // If restricted mode is true and command is not whitelisted, don't
-    // execute the command
-    if(restricted_mode)
+    int conn = accept4(fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (conn < 0)
     {
-        if (!std::binary_search(whitelist.cbegin(), whitelist.cend(),
-                                        std::make_pair(netfn, cmd)))
+        if (errno != EAGAIN && errno != EINTR)
         {
-            log<level::ERR>("Net function not whitelisted",
-                            entry("NETFN=0x%X", netfn),
-                            entry("CMD=0x%X", cmd));
-            rc = IPMI_CC_INSUFFICIENT_PRIVILEGE;
-            memcpy(response, &rc, IPMI_CC_LEN);
-            *data_len = IPMI_CC_LEN;
-            return rc;
+            log<level::ERR>("Failed to accept a host transport connection",
+                            entry("ERRNO=0x%X", errno));
         }
+        return 0;
     }
 
-    // Walk the map that has the registered handlers and invoke the approprite
-    // handlers for matching commands.
-    auto iter = g_ipmid_router_map.find(std::make_pair(netfn, cmd));
-    if(iter == g_ipmid_router_map.end())
-    {
-        /* By default should only print on failure to find wildcard command. */
-#ifdef __IPMI_DEBUG__
-        log<level::ERR>(
-              "No registered handlers for NetFn, trying Wilcard implementation",
-              entry("NET_FUN=0x%X", netfn)
-              entry("CMD=0x%X", IPMI_CMD_WILDCARD));
-#endif
+    ipmi_add_host_link(std::make_unique<phosphor::ipmi::HostTransport>(
+                           conn, "connection:" + std::to_string(conn)));
+    return 0;
+}
 
-        // Now that we did not find any specific [NetFn,Cmd], tuple, check for
-        // NetFn, WildCard command present.
-        iter = g_ipmid_router_map.find(std::make_pair(netfn, IPMI_CMD_WILDCARD));
-        if(iter == g_ipmid_router_map.end())
+// Opens the host transports given with -H, and serves the fds handed over
+// by systemd: listening sockets have their connections served, other fds
+// are served as they are.
+static int ipmi_open_host_links()
+{
+    for (const auto& path : hostTransports)
+    {
+        try
         {
-            log<level::ERR>("No Registered handlers for NetFn",
-                            entry("NET_FUN=0x%X", netfn),
-                            entry("CMD=0x%X", IPMI_CMD_WILDCARD));
-
-            // Respond with a 0xC1
-            memcpy(response, &rc, IPMI_CC_LEN);
-            *data_len = IPMI_CC_LEN;
-            return rc;
+            int r = ipmi_add_host_link(
+                        phosphor::ipmi::HostTransport::open(path));
+            if (r < 0 && r != -EBUSY)
+            {
+                return r;
+            }
+        }
+        catch (const std::system_error& e)
+        {
+            log<level::ERR>("Failed to open the host transport",
+                            entry("TRANSPORT=%s", path.c_str()),
+                            entry("ERROR=%s", e.what()));
+            return -e.code().value();
         }
     }
 
-#ifdef __IPMI_DEBUG__
-    // We have either a perfect match -OR- a wild card atleast,
-    log<level::ERR>("Calling Net function",
-                    entry("NET_FUN=0x%X", netfn)
-                    entry("CMD=0x%X", cmd));
-#endif
-
-    // Extract the map data onto appropriate containers
-    auto handler_and_context = iter->second;
-
-    // Creating a pointer type casted to char* to make sure we advance 1 byte
-    // when we advance pointer to next's address. advancing void * would not
-    // make sense.
-    char *respo = &((char *)response)[IPMI_CC_LEN];
-
-    // Response message from the plugin goes into a byte post the base response
-    rc = (handler_and_context.first) (netfn, cmd, request, respo,
-                                      data_len, handler_and_context.second);
-
-    // Now copy the return code that we got from handler and pack it in first
-    // byte.
-    memcpy(response, &rc, IPMI_CC_LEN);
-
-    // Data length is now actual data + completion code.
-    *data_len = *data_len + IPMI_CC_LEN;
+    int fds = sd_listen_fds(1);
+    for (int fd = SD_LISTEN_FDS_START; fd < SD_LISTEN_FDS_START + fds; fd++)
+    {
+        int r;
+        if (sd_is_socket(fd, AF_UNIX, SOCK_STREAM, 1) > 0)
+        {
+            sd_event_source *source = nullptr;
+            r = sd_event_add_io(events, &source, fd, EPOLLIN,
+                                handle_host_listener, nullptr);
+            if (r >= 0)
+            {
+                hostListeners.push_back(source);
+            }
+        }
+        else
+        {
+            r = ipmi_add_host_link(
+                    std::make_unique<phosphor::ipmi::HostTransport>(
+                        fd, "fd:" + std::to_string(fd)));
+        }
 
-    return rc;
+        // A refused host is left out, the others are still served
+        if (r < 0 && r != -EBUSY)
+        {
+            log<level::ERR>("Failed to serve the host transport fd",
+                            entry("FD=%d", fd),
+                            entry("ERRNO=0x%X", -r));
+            return r;
+        }
+    }
+    return 0;
 }
 
-
-
-
-static int send_ipmi_message(sd_bus_message *req, unsigned char seq, unsigned char netfn, unsigned char lun, unsigned char cmd, unsigned char cc, unsigned char *buf, unsigned char len) {
-
-    sd_bus_error error = SD_BUS_ERROR_NULL;
-    sd_bus_message *reply = NULL, *m=NULL;
-    const char *dest, *path;
-    int r, pty;
-
-    dest = sd_bus_message_get_sender(req);
-    path = sd_bus_message_get_path(req);
-
-    r = sd_bus_message_new_method_call(bus,&m,dest,path,
-                                       DBUS_INTF,
-                                       "sendMessage");
-    if (r < 0) {
-        log<level::ERR>("Failed to add the method object",
+// Pulls the signals already queued on the bus, up to batchLimit requests,
+// then processes the critical ones and the normal ones in this one event
+// loop pass, and queues the bulk ones. Their responses are sent as they are
+// produced, as sending doesn't wait for the bridge.
+static int handle_batch(sd_event_source *es, void *userdata)
+{
+    int r = 0;
+    while (batchQueue.size() < batchLimit &&
+           (r = sd_bus_process(bus, NULL)) > 0)
+    {
+    }
+    if (r < 0)
+    {
+        log<level::ERR>("Failed to drain the bus",
                         entry("ERRNO=0x%X", -r));
-        return -1;
     }
 
+    auto batch = std::move(batchQueue);
+    batchQueue.clear();
 
-    // Responses in IPMI require a bit set.  So there ya go...
-    netfn |= 0x01;
-
-
-    // Add the bytes needed for the methods to be called
-    r = sd_bus_message_append(m, "yyyyy", seq, netfn, lun, cmd, cc);
-    if (r < 0) {
-        log<level::ERR>("Failed add the netfn and others",
-                        entry("ERRNO=0x%X", -r));
-        goto final;
+    // Within a priority class, the hosts take turns, so one that sent many
+    // requests doesn't hold back the others' behind its own
+    std::map<ipmi_host_context_t*, size_t> turns;
+    for (auto& request : batch)
+    {
+        request.turn = turns[request.origin.host]++;
     }
-
-    r = sd_bus_message_append_array(m, 'y', buf, len);
-    if (r < 0) {
-        log<level::ERR>("Failed to add the string of response bytes",
-                        entry("ERRNO=0x%X", -r));
-        goto final;
+    std::stable_sort(batch.begin(), batch.end(),
+                     [](const ipmi_pending_request_t& a,
+                        const ipmi_pending_request_t& b)
+                     {
+                         return std::tie(a.priority, a.turn) <
+                                std::tie(b.priority, b.turn);
+                     });
+    for (auto& request : batch)
+    {
+        if (request.priority == Priority::bulk)
+        {
+            ipmi_queue_bulk(std::move(request));
+            continue;
+        }
+        ipmi_process_request(request);
+        sd_bus_message_unref(request.origin.m);
     }
+    return 0;
+}
 
+static int handle_trace_toggle(sd_event_source *es,
+                               const struct signalfd_siginfo *si,
+                               void *userdata)
+{
+    ipmiTrace.enable(!ipmiTrace.enabled());
+    log<level::INFO>("IPMI packet trace toggled",
+                     entry("ENABLED=%d", ipmiTrace.enabled()));
+    return 0;
+}
 
-
-    // Call the IPMI responder on the bus so the message can be sent to the CEC
-    r = sd_bus_call(bus, m, 0, &error, &reply);
-    if (r < 0) {
-        log<level::ERR>("Failed to call the method",
-                        entry("DEST=%s", dest),
-                        entry("PATH=%s", path),
+static int handle_diag_dump(sd_event_source *es,
+                            const struct signalfd_siginfo *si,
+                            void *userdata)
+{
+    int r = ipmiTrace.dump(traceFile);
+    if (r < 0)
+    {
+        log<level::ERR>("Failed to write the IPMI packet trace",
+                        entry("FILE=%s", traceFile.c_str()),
                         entry("ERRNO=0x%X", -r));
-        goto final;
     }
 
-    r = sd_bus_message_read(reply, "x", &pty);
-    if (r < 0) {
-       log<level::ERR>("Failed to get a reply from the method",
+    r = commandStats.dump(statsFile);
+    if (r < 0)
+    {
+        log<level::ERR>("Failed to write the IPMI command statistics",
+                        entry("FILE=%s", statsFile.c_str()),
                         entry("ERRNO=0x%X", -r));
     }
 
-final:
-    sd_bus_error_free(&error);
-    m = sd_bus_message_unref(m);
-    reply = sd_bus_message_unref(reply);
-
-    return r < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    log<level::INFO>("IPMI response cache",
+                     entry("HITS=%llu",
+                           static_cast<unsigned long long>(
+                               responseCache.hits())),
+                     entry("MISSES=%llu",
+                           static_cast<unsigned long long>(
+                               responseCache.misses())));
+
+    auto& mapperCache = ipmi::MapperCache::instance();
+    log<level::INFO>("Object mapper cache",
+                     entry("HITS=%llu",
+                           static_cast<unsigned long long>(
+                               mapperCache.hits())),
+                     entry("MISSES=%llu",
+                           static_cast<unsigned long long>(
+                               mapperCache.misses())),
+                     entry("DROPPED=%llu",
+                           static_cast<unsigned long long>(
+                               mapperCache.dropped())));
+
+    auto& managedObjects = ipmi::ManagedObjects::instance();
+    log<level::INFO>("Managed object snapshots",
+                     entry("HITS=%llu",
+                           static_cast<unsigned long long>(
+                               managedObjects.hits())),
+                     entry("MISSES=%llu",
+                           static_cast<unsigned long long>(
+                               managedObjects.misses())),
+                     entry("DROPPED=%llu",
+                           static_cast<unsigned long long>(
+                               managedObjects.dropped())));
+
+    for (const auto& bridge : rateLimiter.rejected())
+    {
+        log<level::INFO>("IPMI requests refused by the rate limits",
+                         entry("BRIDGE=%s", bridge.first.c_str()),
+                         entry("REQUESTS=%llu",
+                               static_cast<unsigned long long>(
+                                   bridge.second)));
+    }
+    return 0;
 }
 
-void cache_restricted_mode()
+// Gives each worker thread its own D-Bus connection, sd-bus connections
+// must not be shared between threads.
+static void worker_thread_init()
 {
-    restricted_mode = false;
-    using namespace sdbusplus::xyz::openbmc_project::Control::Security::server;
-    using namespace internal;
-    using namespace internal::cache;
-    sdbusplus::bus::bus dbus(ipmid_get_sd_bus_connection());
-    const auto& restrictionModeSetting =
-        objects->map.at(restrictionModeIntf).front();
-    auto method = dbus.new_method_call(
-                      objects->service(restrictionModeSetting,
-                          restrictionModeIntf).c_str(),
-                      restrictionModeSetting.c_str(),
-                      "org.freedesktop.DBus.Properties",
-                      "Get");
-    method.append(restrictionModeIntf, "RestrictionMode");
-    auto resp = dbus.call(method);
-    if (resp.is_method_error())
-    {
-        log<level::ERR>("Error in RestrictionMode Get");
-        // Fail-safe to true.
-        restricted_mode = true;
-        return;
-    }
-    sdbusplus::message::variant<std::string> result;
-    resp.read(result);
-    auto restrictionMode =
-        RestrictionMode::convertModesFromString(result.get<std::string>());
-    if(RestrictionMode::Modes::Whitelist == restrictionMode)
+    isWorkerThread = true;
+    int r = sd_bus_open_system(&workerBus);
+    if (r < 0)
     {
-        restricted_mode = true;
+        log<level::ERR>("Failed to connect worker to system bus",
+                        entry("ERRNO=0x%X", -r));
+        workerBus = nullptr;
     }
 }
 
-static int handle_restricted_mode_change(sd_bus_message *m, void *user_data,
-                                                    sd_bus_error *ret_error)
+static void worker_thread_exit()
 {
-    cache_restricted_mode();
-    return 0;
+    workerBus = sd_bus_flush_close_unref(workerBus);
 }
 
-static int handle_ipmi_command(sd_bus_message *m, void *user_data, sd_bus_error
-                         *ret_error) {
-    int r = 0;
-    unsigned char sequence, netfn, lun, cmd;
-    const void *request;
-    size_t sz;
-    size_t resplen =MAX_IPMI_BUFFER;
-    unsigned char response[MAX_IPMI_BUFFER];
-
-    memset(response, 0, MAX_IPMI_BUFFER);
-
-    r = sd_bus_message_read(m, "yyyy",  &sequence, &netfn, &lun, &cmd);
-    if (r < 0) {
-        log<level::ERR>("Failed to parse signal message",
-                        entry("ERRNO=0x%X", -r));
-        return -1;
-    }
-
-    r = sd_bus_message_read_array(m, 'y',  &request, &sz );
-    if (r < 0) {
-        log<level::ERR>("Failed to parse signal message",
-                        entry("ERRNO=0x%X", -r));
-        return -1;
+// Starts the worker threads and hooks their completions into the event loop
+static int start_worker_pool(size_t threads)
+{
+    if (threads == 0)
+    {
+        return 0;
     }
 
-    fprintf(ipmiio, "IPMI Incoming: Seq 0x%02x, NetFn 0x%02x, CMD: 0x%02x \n", sequence, netfn, cmd);
-    hexdump(ipmiio, (void*)request, sz);
-
-    // Allow the length field to be used for both input and output of the
-    // ipmi call
-    resplen = sz;
-
-    // Now that we have parsed the entire byte array from the caller
-    // we can call the ipmi router to do the work...
-    r = ipmi_netfn_router(netfn, cmd, (void *)request, (void *)response, &resplen);
-    if(r != 0)
+    try
     {
-#ifdef __IPMI_DEBUG__
-        log<level::ERR>("ERROR in handling NetFn",
-                        entry("ERRNO=0x%X", -r),
-                        entry("NET_FUN=0x%X", netfn),
-                        entry("CMD=0x%X", cmd));
-#endif
-        resplen = 0;
+        workerPool = std::make_unique<phosphor::ipmi::WorkerPool>(
+                         threads, IPMI_WORKER_QUEUE_DEPTH,
+                         worker_thread_init, worker_thread_exit);
     }
-    else
+    catch (const std::exception& e)
     {
-        resplen = resplen - 1; // first byte is for return code.
-    }
-
-    fprintf(ipmiio, "IPMI Response:\n");
-    hexdump(ipmiio,  (void*)response, resplen);
-
-    // Send the response buffer from the ipmi command
-    r = send_ipmi_message(m, sequence, netfn, lun, cmd, response[0],
-		    ((unsigned char *)response) + 1, resplen);
-    if (r < 0) {
-        log<level::ERR>("Failed to send the response message");
+        log<level::ERR>("Failed to start the worker threads",
+                        entry("ERROR=%s", e.what()));
         return -1;
     }
 
-
-    return 0;
+    int r = sd_event_add_io(events, &workerSource,
+                            workerPool->getCompletionFd(), EPOLLIN,
+                            handle_worker_completions, nullptr);
+    if (r < 0)
+    {
+        log<level::ERR>("Failed to watch the worker completions",
+                        entry("ERRNO=0x%X", -r));
+        workerPool.reset();
+    }
+    return r;
 }
 
 
@@ -502,7 +2275,14 @@ void ipmi_register_callback_handlers(const char* ipmi_lib_path)
                               entry("HANDLER=%s", handler_fqdn.c_str()));
 #endif
 
+            // Symbols are all bound here, so that a provider missing one
+            // fails to load rather than aborting ipmid once a handler first
+            // calls it.
+            ipmi_provider_profile_t profile;
+            profile.start = monotonic_usec();
+            loadingProvider = &profile;
             lib_handler = dlopen(handler_fqdn.c_str(), RTLD_NOW);
+            loadingProvider = nullptr;
 
             if(lib_handler == NULL)
             {
@@ -510,6 +2290,32 @@ void ipmi_register_callback_handlers(const char* ipmi_lib_path)
                                 entry("HANDLER=%s", handler_fqdn.c_str()),
                                 entry("ERROR=%s", dlerror()));
             }
+            else
+            {
+                // Loading covers mapping the library and its static
+                // initializers, up to the first registration. Whatever the
+                // constructors do after the last one is reported as init.
+                auto end = monotonic_usec();
+                if(profile.commands == 0)
+                {
+                    profile.firstRegistration = end;
+                    profile.lastRegistration = end;
+                }
+                log<level::INFO>("Loaded IPMI provider",
+                                 entry("HANDLER=%s", handler_fqdn.c_str()),
+                                 entry("COMMANDS=%zu", profile.commands),
+                                 entry("LOAD_USEC=%llu",
+                                       static_cast<unsigned long long>(
+                                           profile.firstRegistration -
+                                           profile.start)),
+                                 entry("REGISTER_USEC=%llu",
+                                       static_cast<unsigned long long>(
+                                           profile.lastRegistration -
+                                           profile.firstRegistration)),
+                                 entry("INIT_USEC=%llu",
+                                       static_cast<unsigned long long>(
+                                           end - profile.lastRegistration)));
+            }
             // Wipe the memory allocated for this particular entry.
             free(handler_list[num_handlers]);
         }
@@ -523,7 +2329,8 @@ void ipmi_register_callback_handlers(const char* ipmi_lib_path)
 }
 
 sd_bus *ipmid_get_sd_bus_connection(void) {
-    return bus;
+    // Worker threads must stick to their own connection
+    return isWorkerThread ? workerBus : bus;
 }
 
 sd_event *ipmid_get_sd_event_connection(void) {
@@ -534,24 +2341,31 @@ sd_bus_slot *ipmid_get_sd_bus_slot(void) {
     return ipmid_slot;
 }
 
-// Calls host command manager to do the right thing for the command
+// Calls host command manager to do the right thing for the command. The
+// BMC's own commands go to host 0.
 void ipmid_send_cmd_to_host(CommandHandler&& cmd) {
-     return cmdManager->execute(std::move(cmd));
+     return hostContexts.front()->cmdManager->execute(std::move(cmd));
 }
 
+// The command manager of the host being served, so a host reading its
+// message buffer gets the commands queued for it
 cmdManagerPtr& ipmid_get_host_cmd_manager() {
-     return cmdManager;
+     return ipmi_request_host().cmdManager;
 }
 
 sdbusPtr& ipmid_get_sdbus_plus_handler() {
      return sdbusp;
 }
 
+#ifndef IPMID_REPLAY
 int main(int argc, char *argv[])
 {
     int r;
     unsigned long tvalue;
     int c;
+    size_t workerThreads = IPMI_WORKER_THREADS;
+    sigset_t traceSignals;
+    uint64_t startup = monotonic_usec();
 
 
 
@@ -559,12 +2373,12 @@ int main(int argc, char *argv[])
     // of trace
     ipmicmddetails = ipmiio = ipmidbus =  fopen("/dev/null", "w");
 
-    while ((c = getopt (argc, argv, "h:d:")) != -1)
+    while ((c = getopt (argc, argv, "h:d:t:s:c:D:r:H:w:b:")) != -1)
         switch (c) {
             case 'd':
                 tvalue =  strtoul(optarg, NULL, 16);
                 if (1&tvalue) {
-                    ipmiio = stdout;
+                    ipmiTrace.enable(true);
                 }
                 if (2&tvalue) {
                     ipmidbus = stdout;
@@ -573,6 +2387,39 @@ int main(int argc, char *argv[])
                     ipmicmddetails = stdout;
                 }
                 break;
+            case 't':
+                traceFile = optarg;
+                break;
+            case 's':
+                statsFile = optarg;
+                break;
+            case 'c':
+                captureWriter =
+                    std::make_unique<phosphor::ipmi::capture::Writer>();
+                r = captureWriter->open(optarg);
+                if (r < 0)
+                {
+                    log<level::ERR>("Failed to create the capture file",
+                                    entry("FILE=%s", optarg),
+                                    entry("ERRNO=0x%X", -r));
+                    return 1;
+                }
+                break;
+            case 'D':
+                deadlinesFile = optarg;
+                break;
+            case 'r':
+                rateLimitsFile = optarg;
+                break;
+            case 'H':
+                hostTransports.push_back(optarg);
+                break;
+            case 'w':
+                workerThreads = strtoul(optarg, NULL, 10);
+                break;
+            case 'b':
+                batchLimit = strtoul(optarg, NULL, 10);
+                break;
           case 'h':
           case '?':
                 print_usage();
@@ -580,6 +2427,13 @@ int main(int argc, char *argv[])
         }
 
 
+    // The trace signals are delivered through sd_event, block them before
+    // any thread is started so that none of them handles them instead.
+    sigemptyset(&traceSignals);
+    sigaddset(&traceSignals, SIGUSR1);
+    sigaddset(&traceSignals, SIGUSR2);
+    sigprocmask(SIG_BLOCK, &traceSignals, NULL);
+
     /* Connect to system bus */
     r = sd_bus_open_system(&bus);
     if (r < 0) {
@@ -597,11 +2451,20 @@ int main(int argc, char *argv[])
         goto finish;
     }
 
-    // Now create the Host Bound Command manager. Need sdbusplus
+    // Now create the Host Bound Command manager of host 0. Need sdbusplus
     // to use the generated bindings
     sdbusp = std::make_unique<sdbusplus::bus::bus>(bus);
-    cmdManager = std::make_unique<phosphor::host::command::Manager>(
-                            *sdbusp, events);
+    ipmi_init_hosts();
+
+    // Keep the mapper's answers and the services' objects from here on, the
+    // providers look up their objects as they load
+    ipmi::MapperCache::instance().watch(*sdbusp);
+    ipmi::ManagedObjects::instance().watch(*sdbusp);
+
+    // Resolve the restricted mode whitelist into the router table.
+    ipmi_init_router_whitelist();
+    ipmi_init_router_deadlines(deadlinesFile);
+    ipmi_init_rate_limits(rateLimitsFile);
 
     // Register all the handlers that provider implementation to IPMI commands.
     ipmi_register_callback_handlers(HOST_IPMI_LIB_PATH);
@@ -618,6 +2481,74 @@ int main(int argc, char *argv[])
     // Attach the bus to sd_event to service user requests
     sd_bus_attach_event(bus, events, SD_EVENT_PRIORITY_NORMAL);
 
+    r = sd_event_add_signal(events, &traceToggleSource, SIGUSR1,
+                            handle_trace_toggle, nullptr);
+    if (r >= 0)
+    {
+        r = sd_event_add_signal(events, &traceDumpSource, SIGUSR2,
+                                handle_diag_dump, nullptr);
+    }
+    if (r < 0)
+    {
+        log<level::ERR>("Failed to watch the trace signals",
+                        entry("ERRNO=0x%X", -r));
+        goto finish;
+    }
+
+    r = sd_event_add_defer(events, &bulkSource, handle_bulk, nullptr);
+    if (r >= 0)
+    {
+        r = sd_event_source_set_priority(bulkSource, SD_EVENT_PRIORITY_IDLE);
+    }
+    if (r >= 0)
+    {
+        r = sd_event_source_set_enabled(bulkSource, SD_EVENT_OFF);
+    }
+    if (r >= 0)
+    {
+        r = sd_event_add_time(events, &bulkTimer, CLOCK_MONOTONIC, 0, 0,
+                              handle_bulk_overdue, nullptr);
+    }
+    if (r >= 0)
+    {
+        r = sd_event_source_set_enabled(bulkTimer, SD_EVENT_OFF);
+    }
+    if (r < 0)
+    {
+        log<level::ERR>("Failed to set up bulk request scheduling",
+                        entry("ERRNO=0x%X", -r));
+        goto finish;
+    }
+
+    if (batchLimit > 0)
+    {
+        r = sd_event_add_defer(events, &batchSource, handle_batch, nullptr);
+        if (r >= 0)
+        {
+            r = sd_event_source_set_enabled(batchSource, SD_EVENT_OFF);
+        }
+        if (r < 0)
+        {
+            log<level::ERR>("Failed to set up request batching",
+                            entry("ERRNO=0x%X", -r));
+            goto finish;
+        }
+    }
+
+    // Thread safe handlers are run by the workers when there are any
+    r = start_worker_pool(workerThreads);
+    if (r < 0)
+    {
+        goto finish;
+    }
+
+    // Requests may also come straight from the host, besides the bridges
+    r = ipmi_open_host_links();
+    if (r < 0)
+    {
+        goto finish;
+    }
+
     {
         using namespace internal;
         using namespace internal::cache;
@@ -635,6 +2566,11 @@ int main(int argc, char *argv[])
                 restrictionModeIntf),
             handle_restricted_mode_change);
 
+        log<level::INFO>("Serving IPMI commands",
+                         entry("STARTUP_USEC=%llu",
+                               static_cast<unsigned long long>(
+                                   monotonic_usec() - startup)));
+
         for (;;) {
             /* Process requests */
             r = sd_event_run(events, (uint64_t)-1);
@@ -648,6 +2584,19 @@ int main(int argc, char *argv[])
     }
 
 finish:
+    traceToggleSource = sd_event_source_unref(traceToggleSource);
+    traceDumpSource = sd_event_source_unref(traceDumpSource);
+    workerSource = sd_event_source_unref(workerSource);
+    batchSource = sd_event_source_unref(batchSource);
+    bulkSource = sd_event_source_unref(bulkSource);
+    bulkTimer = sd_event_source_unref(bulkTimer);
+    for (auto& listener : hostListeners)
+    {
+        sd_event_source_unref(listener);
+    }
+    hostLinks.clear();
+    workerPool.reset();
+    ipmi_release_hosts();
     sd_event_unref(events);
     sd_bus_detach_event(bus);
     sd_bus_slot_unref(ipmid_slot);
@@ -655,3 +2604,4 @@ finish:
     return r < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
 
 }
+#endif // IPMID_REPLAY
@@ -7,7 +7,7 @@
 // function will look for registered handlers that will handle that [netfn,cmd]
 // and will make a call to that plugin implementation and send back the response.
 ipmi_ret_t ipmi_netfn_router(const ipmi_netfn_t, const ipmi_cmd_t, ipmi_request_t,
-                             ipmi_response_t, unsigned int *data_len);
+                             ipmi_response_t, ipmi_data_len_t data_len);
 
 // Plugin libraries need to _end_ with .so
 #define IPMI_PLUGIN_EXTN ".so"
@@ -19,6 +19,11 @@ ipmi_ret_t ipmi_netfn_router(const ipmi_netfn_t, const ipmi_cmd_t, ipmi_request_
 // needs 1 byte for the length field.
 #define MAX_IPMI_BUFFER 64
 
+// NetFn is a 6 bit field and Cmd an 8 bit field in IPMI messages, so the
+// router can keep a slot for every possible [NetFn,Cmd] tuple.
+#define MAX_IPMI_NETFN 64
+#define MAX_IPMI_CMD 256
+
 extern FILE *ipmiio, *ipmidbus, *ipmicmddetails;
 
 #endif
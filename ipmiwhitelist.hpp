@@ -1,11 +1,18 @@
 #ifndef __HOST_IPMID_IPMI_WHITELIST_H__
 #define __HOST_IPMID_IPMI_WHITELIST_H_
 
-#include <vector>
-#include <utility>
+#include <array>
+#include <stdint.h>
 
-using netfncmd_pair = std::pair<unsigned char, unsigned char>;
+// One bit per [NetFn,Cmd] tuple, bit number (NetFn << 8 | Cmd).
+using whitelist_bitmap_t = std::array<uint8_t, (64 * 256) / 8>;
 
-extern const std::vector<netfncmd_pair> whitelist;
+extern const whitelist_bitmap_t whitelist;
+
+inline bool ipmi_is_whitelisted(unsigned char netfn, unsigned char cmd)
+{
+    const unsigned int bit = (netfn << 8) | cmd;
+    return netfn < 64 && (whitelist[bit / 8] & (1 << (bit % 8)));
+}
 
 #endif
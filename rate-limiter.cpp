@@ -0,0 +1,144 @@
+#include <algorithm>
+#include "rate-limiter.hpp"
+
+namespace phosphor
+{
+namespace ipmi
+{
+
+constexpr size_t RateLimiter::maxBridges;
+constexpr const char* RateLimiter::otherBridges;
+
+TokenBucket::TokenBucket(uint32_t rate, uint32_t burst) :
+    rate(rate),
+    capacity(std::max<uint64_t>(burst, 1) * scale),
+    tokens(capacity)
+{
+}
+
+bool TokenBucket::available(uint64_t now)
+{
+    // Requests aren't always checked in the order they were received
+    if (now > refilled)
+    {
+        if (refilled != 0)
+        {
+            auto room = capacity - tokens;
+            auto elapsed = now - refilled;
+            tokens += (elapsed >= room / rate) ? room : elapsed * rate;
+        }
+        refilled = now;
+    }
+    return tokens >= scale;
+}
+
+void RateLimiter::limitNetFn(uint8_t netfn, const Limit& limit)
+{
+    netfns.erase(netfn);
+    if (limit.rate)
+    {
+        netfns.emplace(netfn, TokenBucket(limit.rate, limit.burst));
+    }
+}
+
+void RateLimiter::limitCommand(uint8_t netfn, uint8_t cmd, const Limit& limit)
+{
+    uint16_t key = (netfn << 8) | cmd;
+    commands.erase(key);
+    exempted.erase(key);
+    if (limit.rate)
+    {
+        commands.emplace(key, TokenBucket(limit.rate, limit.burst));
+    }
+    else
+    {
+        exempted.insert(key);
+    }
+}
+
+void RateLimiter::limitBridges(const Limit& limit)
+{
+    bridgeLimit = limit;
+    bridges.clear();
+}
+
+bool RateLimiter::admit(const std::string& bridge, uint8_t netfn,
+                        uint8_t cmd, bool exempt, uint64_t now)
+{
+    uint16_t key = (netfn << 8) | cmd;
+    if (exempted.count(key))
+    {
+        return true;
+    }
+
+    TokenBucket* buckets[3] = {};
+    size_t count = 0;
+
+    auto command = commands.find(key);
+    if (command != commands.end())
+    {
+        buckets[count++] = &command->second;
+    }
+
+    if (!exempt)
+    {
+        auto limit = netfns.find(netfn);
+        if (limit != netfns.end())
+        {
+            buckets[count++] = &limit->second;
+        }
+
+        if (bridgeLimit.rate)
+        {
+            auto it = bridges.find(bridge);
+            if (it == bridges.end())
+            {
+                if (bridges.size() >= maxBridges)
+                {
+                    // Bridges that reconnected left their old bucket behind
+                    for (auto old = bridges.begin(); old != bridges.end();)
+                    {
+                        old->second.available(now);
+                        if (old->second.full())
+                        {
+                            old = bridges.erase(old);
+                        }
+                        else
+                        {
+                            ++old;
+                        }
+                    }
+                }
+                it = bridges.emplace(bridge, TokenBucket(bridgeLimit.rate,
+                                                         bridgeLimit.burst))
+                     .first;
+            }
+            buckets[count++] = &it->second;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!buckets[i]->available(now))
+        {
+            // Bridges come and go, their counts aren't kept without bound
+            auto counted = rejectedBridges.find(bridge);
+            if (counted == rejectedBridges.end())
+            {
+                counted = rejectedBridges.emplace(
+                              (rejectedBridges.size() < maxBridges) ?
+                              bridge : otherBridges, 0).first;
+            }
+            counted->second++;
+            return false;
+        }
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        buckets[i]->take();
+    }
+    return true;
+}
+
+} // namespace ipmi
+} // namespace phosphor
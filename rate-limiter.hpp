@@ -0,0 +1,141 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace phosphor
+{
+namespace ipmi
+{
+
+/** @class TokenBucket
+ *  @brief Admits rate requests per second on average, and bursts of up to
+ *         burst requests.
+ *
+ *  @details Tokens are counted in millionths, so that refilling rate tokens
+ *           per second is adding rate per microsecond.
+ */
+class TokenBucket
+{
+    public:
+        /** @brief Starts full
+         *
+         *  @param[in] rate - tokens added per second
+         *  @param[in] burst - most tokens held at once
+         */
+        TokenBucket(uint32_t rate, uint32_t burst);
+
+        /** @brief Refills for the time elapsed and returns whether a token
+         *         can be taken
+         *
+         *  @param[in] now - CLOCK_MONOTONIC time in usec
+         */
+        bool available(uint64_t now);
+
+        /** @brief Takes a token, available() must have returned true */
+        inline void take()
+        {
+            tokens -= scale;
+        }
+
+        /** @brief Returns whether the bucket is back to full, as of the
+         *         last available()
+         */
+        inline bool full() const
+        {
+            return tokens == capacity;
+        }
+
+    private:
+        static constexpr uint64_t scale = 1000000;
+
+        uint64_t rate;
+        uint64_t capacity;
+        uint64_t tokens;
+        uint64_t refilled = 0;
+};
+
+/** @class RateLimiter
+ *  @brief Token bucket limits on the requests admitted per NetFn, per
+ *         [NetFn,Cmd] and per requesting bridge.
+ *
+ *  @details Only accessed from the event loop thread. A request is admitted
+ *           only if every bucket it falls in has a token, and then takes one
+ *           from each, so rejected requests don't drain the other buckets.
+ *           Each bridge gets its own bucket, created the first time it is
+ *           seen.
+ */
+class RateLimiter
+{
+    public:
+        /** @brief Most bridge buckets kept, the full ones are dropped once
+         *         there are more.
+         */
+        static constexpr size_t maxBridges = 16;
+
+        /** @brief Key the requests refused are counted under once
+         *         maxBridges bridges have had theirs counted
+         */
+        static constexpr auto otherBridges = "(others)";
+
+        struct Limit
+        {
+            //!< Requests per second, 0 for no limit
+            uint32_t rate;
+            //!< Requests admitted back to back
+            uint32_t burst;
+        };
+
+        /** @brief Limits the requests of a NetFn, all commands together */
+        void limitNetFn(uint8_t netfn, const Limit& limit);
+
+        /** @brief Limits the requests of a command. A rate of 0 exempts the
+         *         command from the NetFn and bridge limits instead.
+         */
+        void limitCommand(uint8_t netfn, uint8_t cmd, const Limit& limit);
+
+        /** @brief Limits the requests of each bridge */
+        void limitBridges(const Limit& limit);
+
+        /** @brief Returns whether any limit is configured */
+        inline bool enabled() const
+        {
+            return !netfns.empty() || !commands.empty() || bridgeLimit.rate;
+        }
+
+        /** @brief Decides whether to serve a request
+         *
+         *  @param[in] bridge - unique bus name of the requesting bridge
+         *  @param[in] netfn - Net function
+         *  @param[in] cmd - Command
+         *  @param[in] exempt - only apply the command's own limit
+         *  @param[in] now - CLOCK_MONOTONIC time in usec
+         *
+         *  @return false if the request is over a limit and must be refused
+         */
+        bool admit(const std::string& bridge, uint8_t netfn, uint8_t cmd,
+                   bool exempt, uint64_t now);
+
+        /** @brief Returns the number of requests refused per bridge, for
+         *         up to maxBridges bridges and otherBridges
+         */
+        inline const std::map<std::string, uint64_t>& rejected() const
+        {
+            return rejectedBridges;
+        }
+
+    private:
+        std::map<uint8_t, TokenBucket> netfns;
+        //!< Keyed by (NetFn << 8) | Cmd
+        std::map<uint16_t, TokenBucket> commands;
+        std::set<uint16_t> exempted;
+        Limit bridgeLimit{0, 0};
+        std::map<std::string, TokenBucket> bridges;
+        std::map<std::string, uint64_t> rejectedBridges;
+};
+
+} // namespace ipmi
+} // namespace phosphor
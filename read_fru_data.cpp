@@ -45,21 +45,19 @@ ipmi::PropertyMap readAllProperties(const std::string& intf,
     sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
     auto service = ipmi::getService(bus, INV_INTF, OBJ_PATH);
     std::string objPath = OBJ_PATH + path;
-    auto method = bus.new_method_call(service.c_str(),
-                                      objPath.c_str(),
-                                      PROP_INTF,
-                                      "GetAll");
-    method.append(intf);
-    auto reply = bus.call(method);
-    if (reply.is_method_error())
+    try
+    {
+        // The inventory manager holds every FRU, read from its snapshot
+        properties = ipmi::ManagedObjects::instance().properties(
+                         bus, service, OBJ_PATH, objPath, intf);
+    }
+    catch (InternalFailure& e)
     {
         //If property is not found simply return empty value
         log<level::ERR>("Error in reading property values from inventory",
                         entry("INTERFACE=%s", intf.c_str()),
                         entry("PATH=%s", objPath.c_str()));
-        return properties;
     }
-    reply.read(properties);
     return properties;
 }
 
@@ -0,0 +1,214 @@
+#include "reading-cache.hpp"
+#include "utils.hpp"
+
+namespace ipmi
+{
+namespace sensor
+{
+
+namespace sdbusRule = sdbusplus::bus::match::rules;
+
+/** @brief Returns the deepest path two object paths are both at or below */
+static std::string commonNamespace(const std::string& a, const std::string& b)
+{
+    size_t i = 0;
+    while (i < a.size() && i < b.size() && a[i] == b[i])
+    {
+        i++;
+    }
+    if ((i == a.size() || a[i] == '/') && (i == b.size() || b[i] == '/'))
+    {
+        return a.substr(0, i);
+    }
+
+    // Back to the last element both have
+    auto slash = a.rfind('/', i - 1);
+    return (slash == 0 || slash == std::string::npos) ?
+           std::string("/") : a.substr(0, slash);
+}
+
+ReadingCache& ReadingCache::instance()
+{
+    static ReadingCache cache;
+    return cache;
+}
+
+/** @brief Returns the namespace a path is grouped under for the matches,
+ *         its first three elements, e.g. /xyz/openbmc_project/sensors
+ */
+static std::string group(const std::string& path)
+{
+    size_t end = 0;
+    for (int i = 0; i < 3 && end != std::string::npos; i++)
+    {
+        end = path.find('/', end + 1);
+    }
+    return path.substr(0, end);
+}
+
+void ReadingCache::watch(sdbusplus::bus::bus& bus,
+                         const std::vector<InstancePath>& paths)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    if (this->bus)
+    {
+        return;
+    }
+    this->bus = std::make_unique<sdbusplus::bus::bus>(bus.get());
+
+    // The deepest path the objects of each group are under
+    std::map<std::string, std::string> namespaces;
+    for (const auto& path : paths)
+    {
+        if (path.empty())
+        {
+            continue;
+        }
+        objects.emplace(path, Object{});
+
+        auto& root = namespaces[group(path)];
+        root = root.empty() ? path : commonNamespace(root, path);
+    }
+
+    // A match per namespace rather than one per object, each is an AddMatch
+    // call to the bus, propertiesChanged() picks out their signals. A single
+    // one would be on "/" as soon as the sensors are under /org and /xyz.
+    for (const auto& root : namespaces)
+    {
+        matches.push_back(std::make_unique<sdbusplus::bus::match_t>(
+            bus,
+            sdbusRule::type::signal() +
+            sdbusRule::member("PropertiesChanged") +
+            sdbusRule::interface(ipmi::PROP_INTF) +
+            sdbusRule::path_namespace(root.second),
+            std::bind(&ReadingCache::propertiesChanged, this,
+                      std::placeholders::_1)));
+    }
+}
+
+void ReadingCache::watchOwner(const std::string& service)
+{
+    if (service.empty() || owners.find(service) != owners.end())
+    {
+        return;
+    }
+
+    owners.emplace(service, std::make_unique<sdbusplus::bus::match_t>(
+        *bus,
+        sdbusRule::nameOwnerChanged() + sdbusRule::argN(0, service),
+        std::bind(&ReadingCache::nameOwnerChanged, this,
+                  std::placeholders::_1)));
+}
+
+Value ReadingCache::get(const InstancePath& path,
+                        const DbusInterface& interface,
+                        const DbusProperty& property,
+                        std::chrono::milliseconds maxAge,
+                        const std::function<Value(std::string&)>& fetch)
+{
+    auto key = std::make_pair(interface, property);
+    uint64_t since;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto object = objects.find(path);
+        if (object == objects.end())
+        {
+            std::string service;
+            return fetch(service);
+        }
+        auto found = object->second.readings.find(key);
+        if (found != object->second.readings.end() &&
+            (maxAge.count() == 0 ||
+             std::chrono::steady_clock::now() - found->second.updated <
+                 maxAge))
+        {
+            hitCount++;
+            return found->second.value;
+        }
+        missCount++;
+        since = object->second.generation;
+    }
+
+    // Not locked during the call, signals are handled meanwhile
+    std::string service;
+    auto value = fetch(service);
+
+    std::lock_guard<std::mutex> guard(lock);
+    auto object = objects.find(path);
+    if (object->second.generation == since)
+    {
+        object->second.readings[key] =
+            Reading{value, std::chrono::steady_clock::now()};
+    }
+    object->second.service = service;
+    watchOwner(service);
+    return value;
+}
+
+void ReadingCache::propertiesChanged(sdbusplus::message::message& msg)
+{
+    DbusInterface interface;
+    ipmi::PropertyMap changed;
+    std::vector<DbusProperty> invalidated;
+    std::string path = msg.get_path();
+
+    // Other objects below the sensors' namespace signal too
+    std::lock_guard<std::mutex> guard(lock);
+    auto object = objects.find(path);
+    if (object == objects.end())
+    {
+        return;
+    }
+    object->second.generation++;
+
+    auto& readings = object->second.readings;
+    try
+    {
+        msg.read(interface, changed, invalidated);
+    }
+    catch (const std::exception& e)
+    {
+        // Can't tell what changed
+        readings.clear();
+        return;
+    }
+
+    // Only the properties read already are kept
+    auto now = std::chrono::steady_clock::now();
+    for (auto& property : changed)
+    {
+        auto found = readings.find(std::make_pair(interface, property.first));
+        if (found != readings.end())
+        {
+            found->second = Reading{std::move(property.second), now};
+        }
+    }
+    for (const auto& property : invalidated)
+    {
+        readings.erase(std::make_pair(interface, property));
+    }
+}
+
+void ReadingCache::nameOwnerChanged(sdbusplus::message::message& msg)
+{
+    std::string name, oldOwner, newOwner;
+    msg.read(name, oldOwner, newOwner);
+    if (oldOwner.empty())
+    {
+        return;
+    }
+
+    // The service went away or changed hands
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto& object : objects)
+    {
+        if (object.second.service == name)
+        {
+            object.second.readings.clear();
+            object.second.generation++;
+        }
+    }
+}
+
+} // namespace sensor
+} // namespace ipmi
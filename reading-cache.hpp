@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/server.hpp>
+
+#include "types.hpp"
+
+namespace ipmi
+{
+namespace sensor
+{
+
+/** @class ReadingCache
+ *  @brief Values of the D-Bus properties the sensors read, kept in memory
+ *         for Get Sensor Reading.
+ *
+ *  @details watch() groups the sensors' objects by their first three path
+ *           elements, subscribes to PropertiesChanged below the deepest path
+ *           the objects of each group are under, and picks the signals of
+ *           the sensors' objects out of those. A value is fetched the first
+ *           time it is read, and kept current from the signals after that.
+ *           A sensor with a max age fetches its value again once it is older
+ *           than that, for services that don't signal every change. The
+ *           values of a service's objects are dropped when it leaves the
+ *           bus, since the one replacing it doesn't signal the values it
+ *           starts with. Paths not watched are read from D-Bus every time.
+ *
+ *           get() adds the NameOwnerChanged match of a service the first
+ *           time it reads from it, so it is called on the event loop thread
+ *           as Get Sensor Reading is. A value fetched while its object
+ *           signalled a change isn't kept.
+ */
+class ReadingCache
+{
+    public:
+        /** @brief Returns the cache of the process */
+        static ReadingCache& instance();
+
+        /** @brief Subscribes to the changes of the sensors' objects
+         *
+         *  @param[in] bus - DBUS Bus Object, dispatched by the event loop
+         *  @param[in] paths - object paths of the sensors to cache the
+         *                     readings of
+         */
+        void watch(sdbusplus::bus::bus& bus,
+                   const std::vector<InstancePath>& paths);
+
+        /** @brief Returns the kept value of a property, or fetches it
+         *
+         *  @param[in] path - Dbus object path
+         *  @param[in] interface - Dbus interface
+         *  @param[in] property - name of the property
+         *  @param[in] maxAge - how long the value is kept, 0 until it
+         *                      changes
+         *  @param[in] fetch - reads the value from D-Bus and sets the
+         *                     service it read it from, throws when it
+         *                     fails
+         *
+         *  @return the value of the property
+         */
+        Value get(const InstancePath& path, const DbusInterface& interface,
+                  const DbusProperty& property,
+                  std::chrono::milliseconds maxAge,
+                  const std::function<Value(std::string& service)>& fetch);
+
+        inline uint64_t hits() const
+        {
+            return hitCount;
+        }
+
+        inline uint64_t misses() const
+        {
+            return missCount;
+        }
+
+    private:
+        struct Reading
+        {
+            Value value;
+            std::chrono::steady_clock::time_point updated;
+        };
+
+        struct Object
+        {
+            std::map<std::pair<DbusInterface, DbusProperty>, Reading> readings;
+            //!< Changes each time the object signals
+            uint64_t generation = 0;
+            //!< Service the readings were last fetched from
+            std::string service;
+        };
+
+        /** @brief Drops the readings of a service's objects when it leaves
+         *         the bus, from the first time one is read on
+         */
+        void watchOwner(const std::string& service);
+
+        void propertiesChanged(sdbusplus::message::message& msg);
+        void nameOwnerChanged(sdbusplus::message::message& msg);
+
+        std::mutex lock;
+        std::map<InstancePath, Object> objects;
+        //!< Connection the matches are on, set by watch()
+        std::unique_ptr<sdbusplus::bus::bus> bus;
+        std::vector<std::unique_ptr<sdbusplus::bus::match_t>> matches;
+        std::map<std::string, std::unique_ptr<sdbusplus::bus::match_t>> owners;
+        std::atomic<uint64_t> hitCount{0};
+        std::atomic<uint64_t> missCount{0};
+};
+
+} // namespace sensor
+} // namespace ipmi
@@ -0,0 +1,229 @@
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <systemd/sd-bus.h>
+#include <systemd/sd-event.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include <capture-file.hpp>
+#include <command-stats.hpp>
+#include <host-ipmid/ipmid-host-cmd.hpp>
+#include "ipmid.hpp"
+#include "utils.hpp"
+
+// Replays a capture taken with ipmid -c against the handlers of the provider
+// libraries, on a bus other than the system one, and reports how long each
+// command took. Built from the same sources as ipmid, see Makefile.am.
+
+extern sd_bus *bus;
+extern sd_event *events;
+extern bool restricted_mode;
+extern thread_local uint32_t busCalls;
+
+extern void ipmi_init_hosts();
+extern void ipmi_release_hosts();
+extern void ipmi_init_router_whitelist();
+extern void ipmi_register_callback_handlers(const char* ipmi_lib_path);
+
+struct replay_command_t
+{
+    phosphor::ipmi::capture::RecordHeader record;
+    std::vector<uint8_t> request;
+    std::vector<uint8_t> response;
+};
+
+static uint64_t monotonic_usec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void print_usage(void)
+{
+    fprintf(stderr, "Usage: ipmid-replay [-l dir] [-a address] [-n passes]"
+                    " [-s file] capture\n");
+    fprintf(stderr, "    dir : Provider libraries (default %s)\n",
+            HOST_IPMI_LIB_PATH);
+    fprintf(stderr, "    address : Bus to run on (default the user bus)\n");
+    fprintf(stderr, "    passes : Times the capture is replayed"
+                    " (default 1)\n");
+    fprintf(stderr, "    file : Where the per command statistics are"
+                    " written (default stdout)\n");
+}
+
+static int open_bus(const char* address)
+{
+    if (address == nullptr)
+    {
+        return sd_bus_open_user(&bus);
+    }
+
+    int r = sd_bus_new(&bus);
+    if (r < 0)
+    {
+        return r;
+    }
+    r = sd_bus_set_address(bus, address);
+    if (r >= 0)
+    {
+        r = sd_bus_set_bus_client(bus, 1);
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_start(bus);
+    }
+    return r;
+}
+
+int main(int argc, char *argv[])
+{
+    const char* libPath = HOST_IPMI_LIB_PATH;
+    const char* address = nullptr;
+    const char* statsPath = "/dev/stdout";
+    unsigned long passes = 1;
+    int c;
+
+    while ((c = getopt(argc, argv, "hl:a:n:s:")) != -1)
+    {
+        switch (c)
+        {
+            case 'l':
+                libPath = optarg;
+                break;
+            case 'a':
+                address = optarg;
+                break;
+            case 'n':
+                passes = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                statsPath = optarg;
+                break;
+            default:
+                print_usage();
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc - 1)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    // Load the whole capture first, so that reading it isn't timed
+    std::vector<replay_command_t> commands;
+    phosphor::ipmi::capture::Reader reader;
+    int r = reader.open(argv[optind]);
+    if (r < 0)
+    {
+        fprintf(stderr, "Failed to open capture %s: %s\n", argv[optind],
+                strerror(-r));
+        return EXIT_FAILURE;
+    }
+    replay_command_t command;
+    while (reader.next(command.record, command.request, command.response))
+    {
+        commands.push_back(command);
+    }
+
+    // Never the system bus: commands that change settings would reach the
+    // services of whichever BMC this runs on.
+    r = open_bus(address);
+    if (r < 0)
+    {
+        fprintf(stderr, "Failed to connect to the bus: %s\n", strerror(-r));
+        return EXIT_FAILURE;
+    }
+
+    r = sd_event_default(&events);
+    if (r < 0)
+    {
+        fprintf(stderr, "Failed to create the event loop: %s\n",
+                strerror(-r));
+        return EXIT_FAILURE;
+    }
+    sd_bus_attach_event(bus, events, SD_EVENT_PRIORITY_NORMAL);
+
+    ipmid_get_sdbus_plus_handler() =
+        std::make_unique<sdbusplus::bus::bus>(bus);
+    ipmi_init_hosts();
+    ipmi::MapperCache::instance().watch(*ipmid_get_sdbus_plus_handler());
+    ipmi::ManagedObjects::instance().watch(*ipmid_get_sdbus_plus_handler());
+
+    // The capture only holds what the host was allowed to run
+    restricted_mode = false;
+    ipmi_init_router_whitelist();
+    ipmi_register_callback_handlers(libPath);
+
+    phosphor::ipmi::CommandStats stats;
+    size_t mismatches = 0;
+    uint64_t busy = 0;
+    uint64_t start = monotonic_usec();
+
+    for (unsigned long pass = 0; pass < passes; pass++)
+    {
+        for (const auto& cmd : commands)
+        {
+            unsigned char request[MAX_IPMI_BUFFER] = {0};
+            unsigned char response[MAX_IPMI_BUFFER] = {0};
+            size_t len = std::min(cmd.request.size(), sizeof(request));
+            memcpy(request, cmd.request.data(), len);
+
+            busCalls = 0;
+            uint64_t before = monotonic_usec();
+            ipmi_ret_t rc = ipmi_netfn_router(cmd.record.netfn,
+                                              cmd.record.cmd, request,
+                                              response, &len);
+            uint64_t elapsed = monotonic_usec() - before;
+            busy += elapsed;
+
+            stats.record(cmd.record.netfn, cmd.record.cmd, rc, elapsed,
+                         elapsed, busCalls);
+
+            // Response data as sent to the host, see send_ipmi_response()
+            size_t datalen = (rc == IPMI_CC_OK && len > IPMI_CC_LEN) ?
+                             len - IPMI_CC_LEN : 0;
+            if (rc != cmd.record.cc || datalen != cmd.response.size() ||
+                memcmp(response + IPMI_CC_LEN, cmd.response.data(),
+                       datalen) != 0)
+            {
+                mismatches++;
+            }
+
+            // Let timers and D-Bus replies the handlers queued run between
+            // commands, as they would in ipmid.
+            while (sd_event_run(events, 0) > 0)
+            {
+            }
+        }
+    }
+
+    uint64_t total = monotonic_usec() - start;
+    size_t replayed = commands.size() * passes;
+
+    fprintf(stderr, "Replayed %zu commands in %llu us, %.1f commands/s,"
+                    " %.1f us per command in handlers\n",
+            replayed, static_cast<unsigned long long>(total),
+            total ? replayed * 1000000.0 / total : 0.0,
+            replayed ? static_cast<double>(busy) / replayed : 0.0);
+    fprintf(stderr, "%zu responses differ from the capture\n", mismatches);
+
+    r = stats.dump(statsPath);
+    if (r < 0)
+    {
+        fprintf(stderr, "Failed to write the statistics to %s: %s\n",
+                statsPath, strerror(-r));
+    }
+
+    ipmi_release_hosts();
+    ipmid_get_sdbus_plus_handler().reset();
+    sd_bus_detach_event(bus);
+    sd_event_unref(events);
+    sd_bus_flush_close_unref(bus);
+    return r < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,79 @@
+#include "response-cache.hpp"
+#include <host-ipmid/ipmid-api.h>
+
+namespace phosphor
+{
+namespace ipmi
+{
+
+constexpr size_t ResponseCache::maxEntries;
+
+const std::vector<uint8_t>* ResponseCache::find(uint8_t netfn, uint8_t cmd,
+                                                const void* request,
+                                                size_t len)
+{
+    auto data = static_cast<const uint8_t*>(request);
+    auto it = responses.find(
+                  Key(netfn, cmd, std::vector<uint8_t>(data, data + len)));
+    if (it == responses.end())
+    {
+        missCount++;
+        return nullptr;
+    }
+    hitCount++;
+    used.splice(used.begin(), used, it->second.use);
+    return &it->second.response;
+}
+
+void ResponseCache::store(uint8_t netfn, uint8_t cmd, const void* request,
+                          size_t len, const uint8_t* response, size_t resplen,
+                          uint64_t since)
+{
+    if (since != invalidations)
+    {
+        return;
+    }
+
+    auto data = static_cast<const uint8_t*>(request);
+    auto inserted = responses.emplace(
+                        Key(netfn, cmd, std::vector<uint8_t>(data,
+                                                             data + len)),
+                        Entry());
+    auto& entry = inserted.first->second;
+    entry.response.assign(response, response + resplen);
+    if (!inserted.second)
+    {
+        used.splice(used.begin(), used, entry.use);
+        return;
+    }
+
+    used.push_front(&inserted.first->first);
+    entry.use = used.begin();
+    if (responses.size() > maxEntries)
+    {
+        erase(responses.find(*used.back()));
+    }
+}
+
+void ResponseCache::invalidate(uint8_t netfn, uint8_t cmd)
+{
+    invalidations++;
+
+    // Keys sort by NetFn, then Cmd, so a command's responses are contiguous
+    auto it = responses.lower_bound(
+                  Key(netfn, cmd == IPMI_CMD_WILDCARD ? 0 : cmd, {}));
+    while (it != responses.end() && std::get<0>(it->first) == netfn &&
+           (cmd == IPMI_CMD_WILDCARD || std::get<1>(it->first) == cmd))
+    {
+        erase(it++);
+    }
+}
+
+void ResponseCache::erase(std::map<Key, Entry>::iterator it)
+{
+    used.erase(it->second.use);
+    responses.erase(it);
+}
+
+} // namespace ipmi
+} // namespace phosphor
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <list>
+#include <map>
+#include <tuple>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace phosphor
+{
+namespace ipmi
+{
+
+/** @class ResponseCache
+ *  @brief Responses of the commands registered as cacheable, keyed by
+ *         [NetFn,Cmd] and the request bytes.
+ *
+ *  @details Only accessed from the event loop thread. Responses are stored
+ *           packed, completion code first, exactly as they were sent.
+ *           Providers drop them with invalidate() when the data behind a
+ *           command changes.
+ *
+ *           A response computed off the event loop may be stale by the time
+ *           it is stored, so store() takes the generation() read when the
+ *           request was dispatched and ignores the response if anything was
+ *           invalidated since.
+ *
+ *           Once maxEntries responses are kept, storing another drops the
+ *           one looked up least recently.
+ */
+class ResponseCache
+{
+    public:
+        /** @brief Upper bound on the number of responses kept */
+        static constexpr size_t maxEntries = 256;
+
+        /** @brief Looks up the response to a request
+         *
+         *  @param[in] netfn - Net function
+         *  @param[in] cmd - Command
+         *  @param[in] request - request data
+         *  @param[in] len - length of the request data
+         *
+         *  @return the packed response, nullptr if there is none
+         */
+        const std::vector<uint8_t>* find(uint8_t netfn, uint8_t cmd,
+                                         const void* request, size_t len);
+
+        /** @brief Keeps a response, unless it is stale
+         *
+         *  @param[in] netfn - Net function
+         *  @param[in] cmd - Command
+         *  @param[in] request - request data
+         *  @param[in] len - length of the request data
+         *  @param[in] response - packed response, completion code first
+         *  @param[in] resplen - length of the packed response
+         *  @param[in] since - generation() when the request was dispatched
+         */
+        void store(uint8_t netfn, uint8_t cmd, const void* request,
+                   size_t len, const uint8_t* response, size_t resplen,
+                   uint64_t since);
+
+        /** @brief Drops the responses of a command
+         *
+         *  @param[in] netfn - Net function
+         *  @param[in] cmd - Command, the wildcard drops every command of the
+         *                   NetFn
+         */
+        void invalidate(uint8_t netfn, uint8_t cmd);
+
+        /** @brief Returns a counter bumped by every invalidation */
+        inline uint64_t generation() const
+        {
+            return invalidations;
+        }
+
+        inline uint64_t hits() const
+        {
+            return hitCount;
+        }
+
+        inline uint64_t misses() const
+        {
+            return missCount;
+        }
+
+    private:
+        using Key = std::tuple<uint8_t, uint8_t, std::vector<uint8_t>>;
+
+        struct Entry
+        {
+            std::vector<uint8_t> response;
+            //!< Where the entry is in used
+            std::list<const Key*>::iterator use;
+        };
+
+        /** @brief Drops a response */
+        void erase(std::map<Key, Entry>::iterator it);
+
+        std::map<Key, Entry> responses;
+        //!< Keys of the responses, most recently looked up or stored first
+        std::list<const Key*> used;
+        uint64_t invalidations = 0;
+        uint64_t hitCount = 0;
+        uint64_t missCount = 0;
+};
+
+} // namespace ipmi
+} // namespace phosphor
@@ -29,10 +29,12 @@ interfaceDict = {}
 
 using namespace ipmi::sensor;
 
-extern const IdInfoMap sensors = {
+namespace
+{
+
 % for key in sensorDict.iterkeys():
    % if key:
-{${key},{
+const Info sensor${key} = {
 <%
        sensor = sensorDict[key]
        interfaces = sensor["interfaces"]
@@ -67,6 +69,7 @@ extern const IdInfoMap sensors = {
        if serviceInterface == "org.freedesktop.DBus.Properties":
            sensorInterface = next(iter(interfaces))
        mutability = sensor.get("mutability", "Mutability::Read")
+       maxAge = sensor.get("maxAge", 0)
 %>
         ${entityID},${instance},${sensorType},"${path}","${sensorInterface}",
         ${readingType},${multiplier},${offsetB},${exp},
@@ -138,8 +141,28 @@ except KeyError, e:
             }},
     % endfor
      },
-}},
+     std::chrono::milliseconds(${maxAge}),
+     {${multiplier}, ${offsetB * pow(10,exp)}, ${rExp}, ${scale}},
+};
+
    % endif
 % endfor
+} // namespace
+
+<%
+sensorIds = [key for key in sensorDict.iterkeys() if key]
+%>\
+// Indexed by sensor number, a constant table of the sensors above
+extern const IdInfoTable sensors = {
+    {{
+% for id in range(256):
+    % if id in sensorIds:
+        &sensor${id},
+    % else:
+        nullptr,
+    % endif
+% endfor
+    }},
+    ${len(sensorIds)}
 };
 
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace ipmi
+{
+namespace sdr
+{
+
+/** @brief Next record ID of the last record */
+constexpr uint16_t endOfRecords = 0xFFFF;
+/** @brief Bytes to read for all of a record from an offset */
+constexpr uint8_t wholeRecord = 0xFF;
+
+/** @class Image
+ *  @brief The records of an SDR repository serialized one after the other
+ *         into a single buffer.
+ *
+ *  @details An index by record ID keeps where each record is in the buffer
+ *           and the ID of the record after it, so reading any part of a
+ *           record, as Get SDR does, is a bounds check and a memcpy.
+ *           Records are walked in the order of their IDs. The space of a
+ *           record that is erased or changes length isn't reclaimed, records
+ *           only change when the repository is rebuilt.
+ */
+class Image
+{
+    public:
+        /** @brief Adds a record, or replaces the record with the same ID
+         *
+         *  @param[in] id - record ID
+         *  @param[in] record - the record
+         *  @param[in] length - bytes in the record, not 0
+         *
+         *  @return true if the record is new or its bytes changed
+         */
+        bool update(uint16_t id, const void* record, size_t length)
+        {
+            auto begin = static_cast<const uint8_t*>(record);
+            if (contains(id))
+            {
+                auto& entry = index[id];
+                if (entry.length == length &&
+                    memcmp(bytes.data() + entry.offset, begin, length) == 0)
+                {
+                    return false;
+                }
+                if (entry.length != length)
+                {
+                    // It doesn't fit where it was
+                    entry.offset = bytes.size();
+                    entry.length = length;
+                    bytes.insert(bytes.end(), begin, begin + length);
+                }
+                else
+                {
+                    memcpy(bytes.data() + entry.offset, begin, length);
+                }
+                return true;
+            }
+
+            if (id >= index.size())
+            {
+                index.resize(id + 1);
+            }
+            auto before = previous(id);
+            index[id] = {static_cast<uint32_t>(bytes.size()),
+                         static_cast<uint16_t>(length),
+                         (before == endOfRecords) ? head : index[before].next};
+            if (before == endOfRecords)
+            {
+                head = id;
+            }
+            else
+            {
+                index[before].next = id;
+            }
+            count++;
+
+            bytes.insert(bytes.end(), begin, begin + length);
+            return true;
+        }
+
+        /** @brief Erases a record
+         *
+         *  @param[in] id - record ID
+         *
+         *  @return true if there was a record with the ID
+         */
+        bool erase(uint16_t id)
+        {
+            if (!contains(id))
+            {
+                return false;
+            }
+
+            auto before = previous(id);
+            if (before == endOfRecords)
+            {
+                head = index[id].next;
+            }
+            else
+            {
+                index[before].next = index[id].next;
+            }
+            index[id] = {};
+            count--;
+            return true;
+        }
+
+        /** @brief Returns true if there is a record with the ID */
+        bool contains(uint16_t id) const
+        {
+            return id < index.size() && index[id].length != 0;
+        }
+
+        /** @brief Returns the number of records */
+        size_t size() const
+        {
+            return count;
+        }
+
+        /** @brief Returns the ID of the first record, endOfRecords if there
+         *         is none */
+        uint16_t first() const
+        {
+            return head;
+        }
+
+        /** @brief Reads part of a record
+         *
+         *  @param[in] id - record ID, 0 for the first record
+         *  @param[in] offset - offset into the record
+         *  @param[in] length - bytes to read, wholeRecord for all of it
+         *  @param[out] out - buffer the bytes are copied to
+         *  @param[in] max - size of out
+         *  @param[out] next - ID of the record after it, endOfRecords
+         *                    after the last
+         *
+         *  @return the number of bytes read, -ENOENT if there is no record
+         *          with the ID or -ERANGE if offset is past its end.
+         */
+        int read(uint16_t id, uint8_t offset, uint8_t length, uint8_t* out,
+                 size_t max, uint16_t& next) const
+        {
+            if (id == 0)
+            {
+                id = head;
+            }
+            if (!contains(id))
+            {
+                return -ENOENT;
+            }
+
+            const auto& entry = index[id];
+            if (offset > entry.length)
+            {
+                return -ERANGE;
+            }
+
+            size_t left = entry.length - offset;
+            size_t copied = (length == wholeRecord) ? left :
+                            std::min<size_t>(length, left);
+            copied = std::min(copied, max);
+            memcpy(out, bytes.data() + entry.offset + offset, copied);
+
+            next = entry.next;
+            return copied;
+        }
+
+    private:
+        /** @brief Returns the ID of the record before where a record with
+         *         the ID is or would be, endOfRecords if there is none.
+         */
+        uint16_t previous(uint16_t id) const
+        {
+            for (auto i = std::min<size_t>(id, index.size()); i-- > 0;)
+            {
+                if (index[i].length != 0)
+                {
+                    return i;
+                }
+            }
+            return endOfRecords;
+        }
+
+        /** @brief Where a record is in the image */
+        struct Entry
+        {
+            uint32_t offset; //!< offset of the record in bytes
+            uint16_t length; //!< length of the record, 0 if there is none
+            uint16_t next;   //!< ID of the record after it
+        };
+
+        std::vector<uint8_t> bytes;   //!< the records, back to back
+        std::vector<Entry> index;     //!< the records by record ID
+        size_t count = 0;             //!< number of records
+        uint16_t head = endOfRecords; //!< ID of the first record
+};
+
+} // namespace sdr
+} // namespace ipmi
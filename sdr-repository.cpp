@@ -0,0 +1,226 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <experimental/filesystem>
+#include <vector>
+
+#include <phosphor-logging/log.hpp>
+
+#include "sdr-repository.hpp"
+
+namespace ipmi
+{
+namespace sdr
+{
+
+using namespace phosphor::logging;
+namespace fs = std::experimental::filesystem;
+
+static constexpr char magic[4] = {'I', 'S', 'D', 'R'};
+static constexpr uint16_t version = 1;
+
+// Largest record, a record header and 255 bytes of record
+static constexpr size_t maxRecordLength = 5 + UINT8_MAX;
+
+Repository::Repository(const std::string& file) :
+    file(file)
+{
+    load();
+}
+
+void Repository::rebuild(const Image& records)
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    bool added = false;
+    bool erased = false;
+    uint8_t record[maxRecordLength];
+    uint16_t next = endOfRecords;
+
+    for (auto id = records.first(); id != endOfRecords; id = next)
+    {
+        auto length = records.read(id, 0, wholeRecord, record,
+                                   sizeof(record), next);
+        if (image.update(id, record, length))
+        {
+            added = true;
+        }
+    }
+
+    std::vector<uint16_t> gone;
+    for (auto id = image.first(); id != endOfRecords; id = next)
+    {
+        // Reading nothing, for the next ID
+        image.read(id, 0, 0, record, sizeof(record), next);
+        if (!records.contains(id))
+        {
+            gone.push_back(id);
+        }
+    }
+    for (auto id : gone)
+    {
+        image.erase(id);
+        erased = true;
+    }
+
+    if (!added && !erased)
+    {
+        return;
+    }
+
+    auto now = static_cast<uint32_t>(time(nullptr));
+    if (added)
+    {
+        addition = now;
+    }
+    if (erased)
+    {
+        erasure = now;
+    }
+    reservations.clear();
+
+    log<level::INFO>("SDR repository changed",
+                     entry("RECORDS=%zu", image.size()),
+                     entry("ADDITION=%u", addition),
+                     entry("ERASURE=%u", erasure));
+    save();
+}
+
+int Repository::read(unsigned int host, uint16_t reservation, uint16_t id,
+                     uint8_t offset, uint8_t length, uint8_t* out, size_t max,
+                     uint16_t& next)
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (reservation != 0 || offset != 0)
+    {
+        auto current = reservations.find(host);
+        if (current == reservations.end() || current->second != reservation)
+        {
+            return -EACCES;
+        }
+    }
+    return image.read(id, offset, length, out, max, next);
+}
+
+uint16_t Repository::reserve(unsigned int host)
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    // IPMI spec, Reservation ID, 0 is not a reservation
+    if (++lastReservation == 0)
+    {
+        lastReservation = 1;
+    }
+    reservations[host] = lastReservation;
+    return lastReservation;
+}
+
+size_t Repository::size()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return image.size();
+}
+
+uint32_t Repository::additionTimestamp()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return addition;
+}
+
+uint32_t Repository::erasureTimestamp()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return erasure;
+}
+
+void Repository::load()
+{
+    auto f = fopen(file.c_str(), "re");
+    if (f == nullptr)
+    {
+        return;
+    }
+
+    FileHeader header;
+    Image records;
+    bool valid = fread(&header, sizeof(header), 1, f) == 1 &&
+                 memcmp(header.magic, magic, sizeof(magic)) == 0 &&
+                 header.version == version &&
+                 header.recordSize == sizeof(RecordHeader);
+
+    RecordHeader record;
+    uint8_t data[maxRecordLength];
+    while (valid && fread(&record, sizeof(record), 1, f) == 1)
+    {
+        valid = record.length != 0 && record.length <= sizeof(data) &&
+                fread(data, 1, record.length, f) == record.length;
+        if (valid)
+        {
+            records.update(record.id, data, record.length);
+        }
+    }
+    fclose(f);
+
+    if (!valid)
+    {
+        log<level::ERR>("Ignoring the saved SDR repository, it isn't valid",
+                        entry("FILE=%s", file.c_str()));
+        return;
+    }
+
+    image = std::move(records);
+    addition = header.addition;
+    erasure = header.erasure;
+}
+
+void Repository::save()
+{
+    std::error_code ec;
+    fs::create_directories(fs::path(file).parent_path(), ec);
+
+    // Written aside and renamed over the file, so that it is never left
+    // half written
+    auto temporary = file + ".new";
+    auto f = fopen(temporary.c_str(), "we");
+    if (f == nullptr)
+    {
+        log<level::ERR>("Failed to save the SDR repository",
+                        entry("FILE=%s", temporary.c_str()),
+                        entry("ERRNO=%d", errno));
+        return;
+    }
+
+    FileHeader header = {{magic[0], magic[1], magic[2], magic[3]},
+                         version, sizeof(RecordHeader), addition, erasure};
+    bool written = fwrite(&header, sizeof(header), 1, f) == 1;
+
+    uint8_t data[maxRecordLength];
+    uint16_t next = endOfRecords;
+    for (auto id = image.first(); written && id != endOfRecords; id = next)
+    {
+        auto length = image.read(id, 0, wholeRecord, data, sizeof(data),
+                                 next);
+        RecordHeader record = {id, static_cast<uint16_t>(length)};
+        written = fwrite(&record, sizeof(record), 1, f) == 1 &&
+                  fwrite(data, 1, length, f) == static_cast<size_t>(length);
+    }
+
+    written = fflush(f) == 0 && fsync(fileno(f)) == 0 && written;
+    auto error = errno;
+    fclose(f);
+
+    if (!written || rename(temporary.c_str(), file.c_str()) != 0)
+    {
+        log<level::ERR>("Failed to save the SDR repository",
+                        entry("FILE=%s", file.c_str()),
+                        entry("ERRNO=%d", written ? errno : error));
+        unlink(temporary.c_str());
+    }
+}
+
+} // namespace sdr
+} // namespace ipmi
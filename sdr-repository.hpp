@@ -0,0 +1,131 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "sdr-image.hpp"
+
+namespace ipmi
+{
+namespace sdr
+{
+
+/** @detail A repository file holds the records and timestamps of the SDR
+ *          repository as they were last built. It starts with a FileHeader
+ *          followed, in record ID order, by a RecordHeader and the bytes of
+ *          each record. All fields are in host byte order.
+ */
+
+struct FileHeader
+{
+    char magic[4];          //!< "ISDR"
+    uint16_t version;       //!< 1
+    uint16_t recordSize;    //!< sizeof(RecordHeader)
+    uint32_t addition;      //!< Most recent addition timestamp
+    uint32_t erasure;       //!< Most recent erase timestamp
+} __attribute__((packed));
+
+struct RecordHeader
+{
+    uint16_t id;            //!< Record ID
+    uint16_t length;        //!< Bytes of the record following this header
+} __attribute__((packed));
+
+/** @class Repository
+ *  @brief The SDR repository served to hosts, along with when records were
+ *         last added or changed and erased, and the reservations of the
+ *         hosts reading it.
+ *
+ *  @details The records and timestamps are saved to a file, so that when
+ *           ipmid or the BMC restart the rebuilt repository is compared to
+ *           what it was record by record. The timestamps only move when a
+ *           record actually changed, which lets hosts that cache the SDR
+ *           skip reading it again. Any change cancels the reservations.
+ */
+class Repository
+{
+    public:
+        Repository() = delete;
+        Repository(const Repository&) = delete;
+        Repository& operator=(const Repository&) = delete;
+        Repository(Repository&&) = delete;
+        Repository& operator=(Repository&&) = delete;
+        ~Repository() = default;
+
+        /** @brief Loads the repository saved to a file, if there is one
+         *
+         *  @param[in] file - file the repository is saved to
+         */
+        explicit Repository(const std::string& file);
+
+        /** @brief Replaces the records of the repository. Records that are
+         *         new or changed set the addition timestamp, records that
+         *         are gone the erase timestamp. If any did, the reservations
+         *         are cancelled and the repository is saved.
+         *
+         *  @param[in] records - all the records the repository should have
+         */
+        void rebuild(const Image& records);
+
+        /** @brief Reads part of a record, as Get SDR does. A reservation is
+         *         needed to read from an offset other than 0, and is checked
+         *         whenever one is given.
+         *
+         *  @param[in] host - host reading the record
+         *  @param[in] reservation - reservation ID of the host, or 0
+         *  @param[in] id - record ID, 0 for the first record
+         *  @param[in] offset - offset into the record
+         *  @param[in] length - bytes to read, wholeRecord for all of it
+         *  @param[out] out - buffer the bytes are copied to
+         *  @param[in] max - size of out
+         *  @param[out] next - ID of the record after it
+         *
+         *  @return the number of bytes read, -EACCES if the reservation is
+         *          not the current one of the host, or the errors of
+         *          Image::read().
+         */
+        int read(unsigned int host, uint16_t reservation, uint16_t id,
+                 uint8_t offset, uint8_t length, uint8_t* out, size_t max,
+                 uint16_t& next);
+
+        /** @brief Returns a new reservation for a host, cancelling its
+         *         previous one.
+         */
+        uint16_t reserve(unsigned int host);
+
+        /** @brief Returns the number of records */
+        size_t size();
+
+        /** @brief Returns when a record was last added or changed, in
+         *         seconds since the epoch, 0 if never.
+         */
+        uint32_t additionTimestamp();
+
+        /** @brief Returns when a record was last erased, in seconds since
+         *         the epoch, 0 if never.
+         */
+        uint32_t erasureTimestamp();
+
+    private:
+        /** @brief Reads the repository file, leaving the repository empty
+         *         if it is missing or not valid.
+         */
+        void load();
+
+        /** @brief Writes the repository file, replacing it at once */
+        void save();
+
+        std::mutex lock;
+        std::string file;       //!< file the repository is saved to
+        Image image;            //!< the records
+        uint32_t addition = 0;  //!< Most recent addition timestamp
+        uint32_t erasure = 0;   //!< Most recent erase timestamp
+        uint16_t lastReservation = 0;  //!< last reservation ID handed out
+        std::map<unsigned int, uint16_t> reservations; //!< by host
+};
+
+} // namespace sdr
+} // namespace ipmi
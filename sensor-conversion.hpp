@@ -0,0 +1,62 @@
+#pragma once
+
+#include <algorithm>
+#include <math.h>
+#include <stdint.h>
+
+namespace ipmi
+{
+namespace sensor
+{
+
+/** @class Conversion
+ *  @brief Converts the D-Bus values of an analog sensor to its raw 8 bit
+ *         IPMI readings.
+ *
+ *  @details The reading of a value is
+ *
+ *             raw = (value * 10^(scale - R) - B * 10^Bexp) / M
+ *
+ *           where the power of ten is worked out once, when the sensor is
+ *           created, instead of on every reading. The operations that
+ *           remain are those of the formula, in the same order, so the
+ *           readings are exactly the ones it gives. Readings out of the 8
+ *           bit range saturate to 0 or 255 rather than wrapping around.
+ */
+class Conversion
+{
+    public:
+        Conversion() = delete;
+
+        /** @brief Works out the conversion of a sensor
+         *
+         *  @param[in] multiplier - M
+         *  @param[in] scaledOffset - B * 10^Bexp
+         *  @param[in] exponentR - R
+         *  @param[in] scale - power of ten the D-Bus value is in
+         */
+        Conversion(uint16_t multiplier, int64_t scaledOffset,
+                   int8_t exponentR, int16_t scale) :
+            power(pow(10, scale - exponentR)),
+            offset(scaledOffset),
+            multiplier(multiplier)
+        {
+        }
+
+        /** @brief Returns the raw reading of a value */
+        inline uint8_t encode(double value) const
+        {
+            double raw = (value * power - offset) / multiplier;
+            // Without a branch, NaN ends up at 255
+            raw = std::max(0.0, std::min(255.0, raw));
+            return static_cast<uint8_t>(raw);
+        }
+
+    private:
+        double power;
+        double offset;
+        double multiplier;
+};
+
+} // namespace sensor
+} // namespace ipmi
@@ -20,6 +20,47 @@ using InternalFailure =
 static constexpr auto MAPPER_BUSNAME = "xyz.openbmc_project.ObjectMapper";
 static constexpr auto MAPPER_PATH = "/xyz/openbmc_project/object_mapper";
 static constexpr auto MAPPER_INTERFACE = "xyz.openbmc_project.ObjectMapper";
+static constexpr auto INVENTORY_MANAGER = "xyz.openbmc_project.Inventory.Manager";
+
+void watchReadings(sdbusplus::bus::bus& bus, const IdInfoTable& sensors)
+{
+    std::vector<InstancePath> paths;
+    for (const auto sensor : sensors.infos)
+    {
+        if (sensor == nullptr)
+        {
+            continue;
+        }
+
+        // Inventory sensors name their object below the inventory root
+        if (sensor->sensorInterface == INVENTORY_MANAGER)
+        {
+            paths.push_back(inventoryRoot + sensor->sensorPath);
+        }
+        else
+        {
+            paths.push_back(sensor->sensorPath);
+        }
+    }
+    ReadingCache::instance().watch(bus, paths);
+}
+
+Value readProperty(const Info& sensorInfo,
+                   const InstancePath& path,
+                   const DbusInterface& serviceInterface,
+                   const DbusInterface& interface,
+                   const DbusProperty& property)
+{
+    return ReadingCache::instance().get(
+        path, interface, property, sensorInfo.maxAge,
+        [&](std::string& service)
+        {
+            sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
+            service = ipmi::getService(bus, serviceInterface, path);
+            return ipmi::getDbusProperty(bus, service, path, interface,
+                                         property);
+        });
+}
 
 /** @brief get the D-Bus service and service path
  *  @param[in] bus - The Dbus bus object
@@ -31,26 +72,34 @@ ServicePath getServiceAndPath(sdbusplus::bus::bus& bus,
                               const std::string& interface,
                               const std::string& path)
 {
-    auto depth = 0;
-    auto mapperCall = bus.new_method_call(MAPPER_BUSNAME,
-                                          MAPPER_PATH,
-                                          MAPPER_INTERFACE,
-                                          "GetSubTree");
-    mapperCall.append("/");
-    mapperCall.append(depth);
-    mapperCall.append(std::vector<Interface>({interface}));
-
-    auto mapperResponseMsg = bus.call(mapperCall);
-    if (mapperResponseMsg.is_method_error())
-    {
-        log<level::ERR>("Mapper GetSubTree failed",
-                        entry("PATH=%s", path.c_str()),
-                        entry("INTERFACE=%s", interface.c_str()));
-        elog<InternalFailure>();
-    }
+    // The whole tree is asked for whatever the path, so that every sensor
+    // of the interface shares one cached answer
+    auto mapperResponse = ipmi::MapperCache::instance().lookup(
+        ipmi::MapperCache::Method::getSubTree, "/", {interface},
+        [&]()
+        {
+            auto depth = 0;
+            auto mapperCall = bus.new_method_call(MAPPER_BUSNAME,
+                                                  MAPPER_PATH,
+                                                  MAPPER_INTERFACE,
+                                                  "GetSubTree");
+            mapperCall.append("/");
+            mapperCall.append(depth);
+            mapperCall.append(std::vector<Interface>({interface}));
+
+            auto mapperResponseMsg = bus.call(mapperCall);
+            if (mapperResponseMsg.is_method_error())
+            {
+                log<level::ERR>("Mapper GetSubTree failed",
+                                entry("PATH=%s", path.c_str()),
+                                entry("INTERFACE=%s", interface.c_str()));
+                elog<InternalFailure>();
+            }
 
-    MapperResponseType mapperResponse;
-    mapperResponseMsg.read(mapperResponse);
+            MapperResponseType mapperResponse;
+            mapperResponseMsg.read(mapperResponse);
+            return mapperResponse;
+        });
     if (mapperResponse.empty())
     {
         log<level::ERR>("Invalid mapper response",
@@ -128,23 +177,20 @@ GetSensorResponse mapDbusToAssertion(const Info& sensorInfo,
                                      const InstancePath& path,
                                      const DbusInterface& interface)
 {
-    sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
     GetSensorResponse response {};
     auto responseData = reinterpret_cast<GetReadingResponse*>(response.data());
 
-    auto service = ipmi::getService(bus, interface, path);
-
     const auto& interfaceList = sensorInfo.propertyInterfaces;
 
-    for (const auto& interface : interfaceList)
+    for (const auto& iface : interfaceList)
     {
-        for (const auto& property : interface.second)
+        for (const auto& property : iface.second)
         {
-            auto propValue = ipmi::getDbusProperty(bus,
-                                                   service,
-                                                   path,
-                                                   interface.first,
-                                                   property.first);
+            auto propValue = readProperty(sensorInfo,
+                                          path,
+                                          interface,
+                                          iface.first,
+                                          property.first);
 
             for (const auto& value : std::get<OffsetValueMap>(property.second))
             {
@@ -170,25 +216,20 @@ GetSensorResponse assertion(const Info& sensorInfo)
 
 GetSensorResponse eventdata2(const Info& sensorInfo)
 {
-    sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
     GetSensorResponse response {};
     auto responseData = reinterpret_cast<GetReadingResponse*>(response.data());
 
-    auto service = ipmi::getService(bus,
-                                    sensorInfo.sensorInterface,
-                                    sensorInfo.sensorPath);
-
     const auto& interfaceList = sensorInfo.propertyInterfaces;
 
     for (const auto& interface : interfaceList)
     {
         for (const auto& property : interface.second)
         {
-            auto propValue = ipmi::getDbusProperty(bus,
-                                                   service,
-                                                   sensorInfo.sensorPath,
-                                                   interface.first,
-                                                   property.first);
+            auto propValue = readProperty(sensorInfo,
+                                          sensorInfo.sensorPath,
+                                          sensorInfo.sensorInterface,
+                                          interface.first,
+                                          property.first);
 
             for (const auto& value : std::get<OffsetValueMap>(property.second))
             {
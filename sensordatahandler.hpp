@@ -1,6 +1,7 @@
 #pragma once
 
 #include <math.h>
+#include "reading-cache.hpp"
 #include "sensorhandler.h"
 #include "types.hpp"
 #include "utils.hpp"
@@ -47,6 +48,29 @@ AssertionSet getAssertionSet(const SetSensorReadingReq& cmdData);
  */
 ipmi_ret_t updateToDbus(IpmiUpdateData& msg);
 
+/** @brief Has the ReadingCache keep the readings of the sensors
+ *
+ *  @param[in] bus - DBUS Bus Object, dispatched by the event loop
+ *  @param[in] sensors - the sensors to cache the readings of
+ */
+void watchReadings(sdbusplus::bus::bus& bus, const IdInfoTable& sensors);
+
+/** @brief Reads a property of a sensor's object, through the ReadingCache
+ *
+ *  @param[in] sensorInfo - Dbus info related to sensor.
+ *  @param[in] path - Dbus object path.
+ *  @param[in] serviceInterface - interface the service is looked up by.
+ *  @param[in] interface - Dbus interface of the property.
+ *  @param[in] property - name of the property.
+ *
+ *  @return the value of the property
+ */
+Value readProperty(const Info& sensorInfo,
+                   const InstancePath& path,
+                   const DbusInterface& serviceInterface,
+                   const DbusInterface& interface,
+                   const DbusProperty& property);
+
 namespace get
 {
 
@@ -150,18 +174,13 @@ GetSensorResponse eventdata2(const Info& sensorInfo);
 template<typename T>
 GetSensorResponse readingAssertion(const Info& sensorInfo)
 {
-    sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
     GetSensorResponse response {};
     auto responseData = reinterpret_cast<GetReadingResponse*>(response.data());
 
-    auto service = ipmi::getService(bus,
-                                    sensorInfo.sensorInterface,
-                                    sensorInfo.sensorPath);
-
-    auto propValue = ipmi::getDbusProperty(
-            bus,
-            service,
+    auto propValue = readProperty(
+            sensorInfo,
             sensorInfo.sensorPath,
+            sensorInfo.sensorInterface,
             sensorInfo.propertyInterfaces.begin()->first,
             sensorInfo.propertyInterfaces.begin()->second.begin()->first);
 
@@ -181,30 +200,20 @@ GetSensorResponse readingAssertion(const Info& sensorInfo)
 template<typename T>
 GetSensorResponse readingData(const Info& sensorInfo)
 {
-    sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
     GetSensorResponse response {};
     auto responseData = reinterpret_cast<GetReadingResponse*>(response.data());
 
     enableScanning(responseData);
 
-    auto service = ipmi::getService(bus,
-                                    sensorInfo.sensorInterface,
-                                    sensorInfo.sensorPath);
-
-    auto propValue = ipmi::getDbusProperty(
-            bus,
-            service,
+    auto propValue = readProperty(
+            sensorInfo,
             sensorInfo.sensorPath,
+            sensorInfo.sensorInterface,
             sensorInfo.propertyInterfaces.begin()->first,
             sensorInfo.propertyInterfaces.begin()->second.begin()->first);
 
-    double value = propValue.get<T>() * pow(10,
-            sensorInfo.scale - sensorInfo.exponentR);
-
-    auto rawData = static_cast<uint8_t>(
-            (value - sensorInfo.scaledOffset) / sensorInfo.coefficientM);
-
-    setReading(rawData, responseData);
+    setReading(sensorInfo.conversion.encode(propValue.get<T>()),
+               responseData);
 
     return response;
 }
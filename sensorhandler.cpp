@@ -4,14 +4,18 @@
 #include <string.h>
 #include <set>
 #include <bitset>
+#include <mutex>
 #include <xyz/openbmc_project/Sensor/Value/server.hpp>
 #include <systemd/sd-bus.h>
 #include "host-ipmid/ipmid-api.h"
 #include <phosphor-logging/log.hpp>
 #include <phosphor-logging/elog-errors.hpp>
+#include "config.h"
 #include "fruread.hpp"
 #include "ipmid.hpp"
 #include "sensorhandler.h"
+#include "sensordatahandler.hpp"
+#include "sdr-repository.hpp"
 #include "types.hpp"
 #include "utils.hpp"
 #include "xyz/openbmc_project/Common/error.hpp"
@@ -22,7 +26,7 @@ static constexpr uint8_t BMCSlaveAddress = 0x20;
 
 extern int updateSensorRecordFromSSRAESC(const void *);
 extern sd_bus *bus;
-extern const ipmi::sensor::IdInfoMap sensors;
+extern const ipmi::sensor::IdInfoTable sensors;
 extern const FruMap frus;
 
 
@@ -146,13 +150,13 @@ int find_openbmc_path(uint8_t num, dbus_interface_t *interface) {
 
     // When the sensor map does not contain the sensor requested,
     // fall back to the legacy DBus lookup (deprecated)
-    const auto& sensor_it = sensors.find(num);
-    if (sensor_it == sensors.end())
+    const auto sensor = sensors.find(num);
+    if (sensor == nullptr)
     {
         return legacy_dbus_openbmc_path("SENSOR", num, interface);
     }
 
-    const auto& info = sensor_it->second;
+    const auto& info = *sensor;
 
     char* busname = nullptr;
     rc = get_bus_for_path(info.sensorPath.c_str(), &busname);
@@ -371,8 +375,8 @@ ipmi_ret_t setSensorReading(void *request)
             *(static_cast<ipmi::sensor::SetSensorReadingReq *>(request));
 
     // Check if the Sensor Number is present
-    const auto iter = sensors.find(cmdData.number);
-    if (iter == sensors.end())
+    const auto sensor = sensors.find(cmdData.number);
+    if (sensor == nullptr)
     {
         return IPMI_CC_SENSOR_INVALID;
     }
@@ -380,13 +384,13 @@ ipmi_ret_t setSensorReading(void *request)
     try
     {
         if (ipmi::sensor::Mutability::Write !=
-              (iter->second.mutability & ipmi::sensor::Mutability::Write))
+              (sensor->mutability & ipmi::sensor::Mutability::Write))
         {
             log<level::ERR>("Sensor Set operation is not allowed",
                             entry("SENSOR_NUM=%d", cmdData.number));
             return IPMI_CC_ILLEGAL_COMMAND;
         }
-        return iter->second.updateFunc(cmdData, iter->second);
+        return sensor->updateFunc(cmdData, *sensor);
     }
     catch (InternalFailure& e)
     {
@@ -563,6 +567,21 @@ ipmi_ret_t legacyGetSensorReading(uint8_t sensorNum,
     return rc;
 }
 
+/** @brief Has the ReadingCache watch the generated sensors, the first time
+ *         a reading is asked for. Not done when registering the commands:
+ *         the provider's constructors may run before the generated sensors
+ *         are initialized.
+ */
+static void watchSensorReadings()
+{
+    static std::once_flag watched;
+    std::call_once(watched, []()
+    {
+        sdbusplus::bus::bus dbus{ipmid_get_sd_bus_connection()};
+        ipmi::sensor::watchReadings(dbus, sensors);
+    });
+}
+
 ipmi_ret_t ipmi_sen_get_sensor_reading(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
                              ipmi_request_t request, ipmi_response_t response,
                              ipmi_data_len_t data_len, ipmi_context_t context)
@@ -572,20 +591,22 @@ ipmi_ret_t ipmi_sen_get_sensor_reading(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
     ipmi::sensor::GetSensorResponse getResponse {};
     static constexpr auto scanningEnabledBit = 6;
 
-    const auto iter = sensors.find(reqptr->sennum);
-    if (iter == sensors.end())
+    watchSensorReadings();
+
+    const auto sensor = sensors.find(reqptr->sennum);
+    if (sensor == nullptr)
     {
         return legacyGetSensorReading(reqptr->sennum, response, data_len);
     }
     if (ipmi::sensor::Mutability::Read !=
-          (iter->second.mutability & ipmi::sensor::Mutability::Read))
+          (sensor->mutability & ipmi::sensor::Mutability::Read))
     {
         return IPMI_CC_ILLEGAL_COMMAND;
     }
 
     try
     {
-        getResponse =  iter->second.getFunc(iter->second);
+        getResponse =  sensor->getFunc(*sensor);
         *data_len = getResponse.size();
         memcpy(resp, getResponse.data(), *data_len);
         resp->operation = 1 << scanningEnabledBit;
@@ -609,8 +630,7 @@ void getSensorThresholds(uint8_t sensorNum,
 
     sdbusplus::bus::bus bus{ipmid_get_sd_bus_connection()};
 
-    const auto iter = sensors.find(sensorNum);
-    const auto info = iter->second;
+    const auto& info = *sensors.find(sensorNum);
 
     auto service = ipmi::getService(bus, info.sensorInterface, info.sensorPath);
 
@@ -624,18 +644,14 @@ void getSensorThresholds(uint8_t sensorNum,
 
     if (warnLow != 0)
     {
-        warnLow *= pow(10, info.scale - info.exponentR);
-        response->lowerNonCritical = static_cast<uint8_t>((
-            warnLow - info.scaledOffset) / info.coefficientM);
+        response->lowerNonCritical = info.conversion.encode(warnLow);
         response->validMask |= static_cast<uint8_t>(
                 ipmi::sensor::ThresholdMask::NON_CRITICAL_LOW_MASK);
     }
 
     if (warnHigh != 0)
     {
-        warnHigh *= pow(10, info.scale - info.exponentR);
-        response->upperNonCritical = static_cast<uint8_t>((
-            warnHigh - info.scaledOffset) / info.coefficientM);
+        response->upperNonCritical = info.conversion.encode(warnHigh);
         response->validMask |= static_cast<uint8_t>(
                 ipmi::sensor::ThresholdMask::NON_CRITICAL_HIGH_MASK);
     }
@@ -649,18 +665,14 @@ void getSensorThresholds(uint8_t sensorNum,
 
     if (critLow != 0)
     {
-        critLow *= pow(10, info.scale - info.exponentR);
-        response->lowerCritical = static_cast<uint8_t>((
-            critLow - info.scaledOffset) / info.coefficientM);
+        response->lowerCritical = info.conversion.encode(critLow);
         response->validMask |= static_cast<uint8_t>(
                 ipmi::sensor::ThresholdMask::CRITICAL_LOW_MASK);
     }
 
     if (critHigh != 0)
     {
-        critHigh *= pow(10, info.scale - info.exponentR);
-        response->upperCritical = static_cast<uint8_t>((
-            critHigh - info.scaledOffset)/ info.coefficientM);
+        response->upperCritical = info.conversion.encode(critHigh);
         response->validMask |= static_cast<uint8_t>(
                 ipmi::sensor::ThresholdMask::CRITICAL_HIGH_MASK);
     }
@@ -681,13 +693,13 @@ ipmi_ret_t ipmi_sen_get_sensor_thresholds(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
     auto sensorNum = *(reinterpret_cast<const uint8_t *>(request));
     *data_len = 0;
 
-    const auto iter = sensors.find(sensorNum);
-    if (iter == sensors.end())
+    const auto sensor = sensors.find(sensorNum);
+    if (sensor == nullptr)
     {
         return IPMI_CC_SENSOR_INVALID;
     }
 
-    const auto info = iter->second;
+    const auto& info = *sensor;
 
     //Proceed only if the sensor value interface is implemented.
     if (info.propertyInterfaces.find(valueInterface) ==
@@ -737,7 +749,7 @@ ipmi_ret_t ipmi_sen_get_sdr_info(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
         get_sdr_info::request::get_count(request) == false)
     {
         // Get Sensor Count
-        resp->count = sensors.size() + frus.size();
+        resp->count = getSdrRepository().size();
     }
     else
     {
@@ -763,12 +775,13 @@ ipmi_ret_t ipmi_sen_reserve_sdr(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
                                 ipmi_data_len_t data_len,
                                 ipmi_context_t context)
 {
-    // A constant reservation ID is okay until we implement add/remove SDR.
-    const uint16_t reservation_id = 1;
-    *(uint16_t*)response = reservation_id;
-    *data_len = sizeof(uint16_t);
+    // Reservations are kept per host, and cancelled when the repository
+    // changes
+    uint16_t reservation_id =
+        getSdrRepository().reserve(ipmid_get_request_host());
+    memcpy(response, &reservation_id, sizeof(reservation_id));
+    *data_len = sizeof(reservation_id);
 
-    printf("Created new IPMI SDR reservation ID %d\n", *(uint16_t*)response);
     return IPMI_CC_OK;
 }
 
@@ -855,46 +868,65 @@ ipmi_ret_t populate_record_from_dbus(get_sdr::SensorDataFullRecordBody *body,
     return IPMI_CC_OK;
 };
 
-ipmi_ret_t ipmi_fru_get_sdr(ipmi_request_t request, ipmi_response_t response,
-                            ipmi_data_len_t data_len)
+/** @brief Builds the full sensor record of a sensor
+ *
+ *  @param[in] sensorId - sensor number, the record ID of the record
+ *  @param[in] sensor - the sensor
+ *  @param[out] record - the record
+ */
+static void buildFullRecord(uint8_t sensorId, const ipmi::sensor::Info& sensor,
+                            get_sdr::SensorDataFullRecord& record)
 {
-    auto req = reinterpret_cast<get_sdr::GetSdrReq*>(request);
-    auto resp = reinterpret_cast<get_sdr::GetSdrResp*>(response);
-    get_sdr::SensorDataFruRecord record {};
-    auto dataLength = 0;
+    /* Header */
+    get_sdr::header::set_record_id(sensorId, &(record.header));
+    record.header.sdr_version = SDR_VERSION; // Based on IPMI Spec v2.0 rev 1.1
+    record.header.record_type = get_sdr::SENSOR_DATA_FULL_RECORD;
+    record.header.record_length = sizeof(get_sdr::SensorDataFullRecord);
 
-    auto fru = frus.begin();
-    uint8_t fruID {};
-    auto recordID = get_sdr::request::get_record_id(req);
+    /* Key */
+    get_sdr::key::set_owner_id_bmc(&(record.key));
+    record.key.sensor_number = sensorId;
 
-    fruID = recordID - FRU_RECORD_ID_START;
-    fru = frus.find(fruID);
-    if (fru == frus.end())
-    {
-        return IPMI_CC_SENSOR_INVALID;
-    }
+    /* Body */
+    record.body.entity_id = sensor.entityType;
+    record.body.sensor_type = sensor.sensorType;
+    record.body.event_reading_type = sensor.sensorReadingType;
+    record.body.entity_instance = sensor.instance;
 
+    // Set the type-specific details given the DBus interface
+    populate_record_from_dbus(&(record.body), &sensor, nullptr);
+}
+
+/** @brief Builds the FRU device locator record of a FRU
+ *
+ *  @param[in] fru - the FRU
+ *  @param[out] record - the record
+ */
+static void buildFruRecord(const FruMap::value_type& fru,
+                           get_sdr::SensorDataFruRecord& record)
+{
     /* Header */
-    get_sdr::header::set_record_id(recordID, &(record.header));
+    get_sdr::header::set_record_id(FRU_RECORD_ID_START + fru.first,
+                                   &(record.header));
     record.header.sdr_version = SDR_VERSION; // Based on IPMI Spec v2.0 rev 1.1
     record.header.record_type = get_sdr::SENSOR_DATA_FRU_RECORD;
     record.header.record_length = sizeof(record.key) + sizeof(record.body);
 
     /* Key */
-    record.key.fruID = fruID;
+    record.key.fruID = fru.first;
     record.key.accessLun |= IPMI_LOGICAL_FRU;
     record.key.deviceAddress = BMCSlaveAddress;
 
     /* Body */
-    record.body.entityID = fru->second[0].entityID;
-    record.body.entityInstance = fru->second[0].entityInstance;
+    record.body.entityID = fru.second[0].entityID;
+    record.body.entityInstance = fru.second[0].entityInstance;
     record.body.deviceType = fruInventoryDevice;
     record.body.deviceTypeModifier = IPMIFruInventory;
 
     /* Device ID string */
-    auto deviceID = fru->second[0].path.substr(
-            fru->second[0].path.find_last_of('/') + 1,
-            fru->second[0].path.length());
+    auto deviceID = fru.second[0].path.substr(
+            fru.second[0].path.find_last_of('/') + 1,
+            fru.second[0].path.length());
 
 
     if (deviceID.length() > get_sdr::FRU_RECORD_DEVICE_ID_MAX_LENGTH)
@@ -911,121 +943,82 @@ ipmi_ret_t ipmi_fru_get_sdr(ipmi_request_t request, ipmi_response_t response,
 
     strncpy(record.body.deviceID, deviceID.c_str(),
             get_sdr::body::get_device_id_strlen(&(record.body)));
+}
+
+ipmi::sdr::Repository& getSdrRepository()
+{
+    static ipmi::sdr::Repository repository(SDR_REPOSITORY_FILE);
+    static std::once_flag built;
 
-    if (++fru == frus.end())
+    // The records only come from the generated sensor and FRU tables, they
+    // can only have changed since the repository was saved, with an update
+    // of the BMC firmware.
+    std::call_once(built, []()
     {
-        get_sdr::response::set_next_record_id(END_OF_RECORD, resp); // last record
-    }
-    else
+        ipmi::sdr::Image records;
+        for (auto id = sensors.next(0); id < sensors.infos.size();
+             id = sensors.next(id + 1))
+        {
+            get_sdr::SensorDataFullRecord record {};
+            buildFullRecord(id, *sensors.find(id), record);
+            records.update(id, &record, sizeof(record));
+        }
+        for (const auto& fru : frus)
+        {
+            get_sdr::SensorDataFruRecord record {};
+            buildFruRecord(fru, record);
+            records.update(FRU_RECORD_ID_START + fru.first, &record,
+                           sizeof(record));
+        }
+        repository.rebuild(records);
+    });
+    return repository;
+}
+
+ipmi_ret_t ipmi_sen_get_sdr(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
+                            ipmi_request_t request, ipmi_response_t response,
+                            ipmi_data_len_t data_len, ipmi_context_t context)
+{
+    auto req = reinterpret_cast<get_sdr::GetSdrReq*>(request);
+    auto resp = reinterpret_cast<get_sdr::GetSdrResp*>(response);
+
+    if (req == nullptr)
     {
-        get_sdr::response::set_next_record_id(
-                (FRU_RECORD_ID_START + fru->first), resp);
+        *data_len = 0;
+        return IPMI_CC_OK;
     }
 
-    if (req->bytes_to_read > (sizeof(*resp) - req->offset))
+    // At the beginning of a scan, the host side will send us id=0.
+    uint16_t nextId = END_OF_RECORD;
+    auto rc = getSdrRepository().read(ipmid_get_request_host(),
+                                      get_sdr::request::get_reservation_id(req),
+                                      get_sdr::request::get_record_id(req),
+                                      req->offset, req->bytes_to_read,
+                                      resp->record_data,
+                                      sizeof(resp->record_data), nextId);
+    if (rc == -EACCES)
     {
-        dataLength = (sizeof(*resp) - req->offset);
+        *data_len = 0;
+        return IPMI_CC_INVALID_RESERVATION_ID;
     }
-    else
+    if (rc == -ENOENT)
     {
-        dataLength =  req->bytes_to_read;
+        *data_len = 0;
+        return IPMI_CC_SENSOR_INVALID;
     }
-
-    if (dataLength <= 0)
+    if (rc < 0)
     {
-        return IPMI_CC_REQ_DATA_LEN_INVALID;
+        *data_len = 0;
+        return IPMI_CC_PARM_OUT_OF_RANGE;
     }
 
-    memcpy(resp->record_data,
-            reinterpret_cast<uint8_t*>(&record) + req->offset,
-            (dataLength));
-
-    *data_len = dataLength;
+    get_sdr::response::set_next_record_id(nextId, resp);
+    *data_len = rc;
     *data_len += 2; // additional 2 bytes for next record ID
 
     return IPMI_CC_OK;
 }
 
-ipmi_ret_t ipmi_sen_get_sdr(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
-                            ipmi_request_t request, ipmi_response_t response,
-                            ipmi_data_len_t data_len, ipmi_context_t context)
-{
-    ipmi_ret_t ret = IPMI_CC_OK;
-    get_sdr::GetSdrReq *req = (get_sdr::GetSdrReq*)request;
-    get_sdr::GetSdrResp *resp = (get_sdr::GetSdrResp*)response;
-    get_sdr::SensorDataFullRecord record = {0};
-    if (req != NULL)
-    {
-        // Note: we use an iterator so we can provide the next ID at the end of
-        // the call.
-        auto sensor = sensors.begin();
-        auto recordID = get_sdr::request::get_record_id(req);
-
-        // At the beginning of a scan, the host side will send us id=0.
-        if (recordID != 0)
-        {
-            // recordID greater then 255,it means it is a FRU record.
-            // Currently we are supporting two record types either FULL record
-            // or FRU record.
-            if (recordID >= FRU_RECORD_ID_START)
-            {
-                return ipmi_fru_get_sdr(request, response, data_len);
-            }
-            else
-            {
-                sensor = sensors.find(recordID);
-                if (sensor == sensors.end())
-                {
-                    return IPMI_CC_SENSOR_INVALID;
-                }
-            }
-        }
-
-        uint8_t sensor_id = sensor->first;
-
-        /* Header */
-        get_sdr::header::set_record_id(sensor_id, &(record.header));
-        record.header.sdr_version = 0x51; // Based on IPMI Spec v2.0 rev 1.1
-        record.header.record_type = get_sdr::SENSOR_DATA_FULL_RECORD;
-        record.header.record_length = sizeof(get_sdr::SensorDataFullRecord);
-
-        /* Key */
-        get_sdr::key::set_owner_id_bmc(&(record.key));
-        record.key.sensor_number = sensor_id;
-
-        /* Body */
-        record.body.entity_id = sensor->second.entityType;
-        record.body.sensor_type = sensor->second.sensorType;
-        record.body.event_reading_type = sensor->second.sensorReadingType;
-        record.body.entity_instance = sensor->second.instance;
-
-        // Set the type-specific details given the DBus interface
-        ret = populate_record_from_dbus(&(record.body), &(sensor->second),
-                                        data_len);
-
-        if (++sensor == sensors.end())
-        {
-            // we have reached till end of sensor, so assign the next record id
-            // to 256(Max Sensor ID = 255) + FRU ID(may start with 0).
-            auto next_record_id = (frus.size()) ?
-                frus.begin()->first + FRU_RECORD_ID_START :
-                END_OF_RECORD;
-
-            get_sdr::response::set_next_record_id(next_record_id, resp);
-        }
-        else
-        {
-            get_sdr::response::set_next_record_id(sensor->first, resp);
-        }
-
-        *data_len = sizeof(get_sdr::GetSdrResp) - req->offset;
-        memcpy(resp->record_data, (char*)&record + req->offset,
-               sizeof(get_sdr::SensorDataFullRecord) - req->offset);
-    }
-
-    return ret;
-}
-
 
 void register_netfn_sen_functions()
 {
@@ -1060,9 +1053,10 @@ void register_netfn_sen_functions()
                            PRIVILEGE_USER);
 
     // <Get Device SDR>
-    ipmi_register_callback(NETFUN_SENSOR, IPMI_CMD_GET_DEVICE_SDR,
-                           nullptr, ipmi_sen_get_sdr,
-                           PRIVILEGE_USER);
+    ipmi_register_callback_flags(NETFUN_SENSOR, IPMI_CMD_GET_DEVICE_SDR,
+                                 nullptr, ipmi_sen_get_sdr,
+                                 PRIVILEGE_USER,
+                                 IPMI_CMD_FLAG_PRIORITY_BULK);
 
     // <Get Sensor Thresholds>
     ipmi_register_callback(NETFUN_SENSOR, IPMI_CMD_GET_SENSOR_THRESHOLDS,
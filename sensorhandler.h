@@ -55,6 +55,19 @@ ipmi_ret_t ipmi_sen_get_sdr(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
                             ipmi_request_t request, ipmi_response_t response,
                             ipmi_data_len_t data_len, ipmi_context_t context);
 
+namespace ipmi
+{
+namespace sdr
+{
+class Repository;
+} // namespace sdr
+} // namespace ipmi
+
+/** @brief Returns the SDR repository of the sensors and FRUs, brought up to
+ *         date with them the first time it is used.
+ */
+ipmi::sdr::Repository& getSdrRepository();
+
 ipmi_ret_t ipmi_sen_reserve_sdr(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
                                 ipmi_request_t request,
                                 ipmi_response_t response,
@@ -130,7 +143,7 @@ struct GetSdrReq
 namespace request
 {
 
-inline uint8_t get_reservation_id(GetSdrReq* req)
+inline uint16_t get_reservation_id(GetSdrReq* req)
 {
     return (req->reservation_id_lsb + (req->reservation_id_msb << 8));
 };
@@ -1,5 +1,8 @@
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/log.hpp>
+#include <cstring>
+#include <functional>
+#include <sdbusplus/bus/match.hpp>
 #include "xyz/openbmc_project/Common/error.hpp"
 #include "settings.hpp"
 #include "utils.hpp"
@@ -14,6 +17,11 @@ constexpr auto mapperService = "xyz.openbmc_project.ObjectMapper";
 constexpr auto mapperPath = "/xyz/openbmc_project/object_mapper";
 constexpr auto mapperIntf = "xyz.openbmc_project.ObjectMapper";
 
+namespace sdbusRule = sdbusplus::bus::match::rules;
+
+// Interfaces every object has, whose properties aren't settings
+constexpr auto dbusIntfPrefix = "org.freedesktop.DBus.";
+
 Objects::Objects(sdbusplus::bus::bus& bus,
                  const std::vector<Interface>& filter):
     bus(bus)
@@ -44,11 +52,29 @@ Objects::Objects(sdbusplus::bus::bus& bus,
         elog<InternalFailure>();
     }
 
+    // Subscribe before loading, so that no change is missed in between
     for (auto& iter : result)
     {
         const auto& path = iter.first;
+        services.emplace(path, iter.second.begin()->first);
+        watchOwner(iter.second.begin()->first);
+        matches.push_back(std::make_unique<sdbusplus::bus::match_t>(
+            bus,
+            sdbusRule::type::signal() +
+            sdbusRule::path(path) +
+            sdbusRule::member("PropertiesChanged") +
+            sdbusRule::interface(ipmi::PROP_INTF),
+            std::bind(&Objects::propertiesChanged, this,
+                      std::placeholders::_1)));
+
         for (auto& interface : iter.second.begin()->second)
         {
+            if (interface.compare(0, strlen(dbusIntfPrefix),
+                                  dbusIntfPrefix) != 0)
+            {
+                load(path, interface);
+            }
+
             auto found = map.find(interface);
             if (map.end() != found)
             {
@@ -65,6 +91,12 @@ Objects::Objects(sdbusplus::bus::bus& bus,
 
 Service Objects::service(const Path& path, const Interface& interface) const
 {
+    auto cached = services.find(path);
+    if (cached != services.end() && !cached->second.empty())
+    {
+        return cached->second;
+    }
+
     using Interfaces = std::vector<Interface>;
     auto mapperCall = bus.new_method_call(mapperService,
                                           mapperPath,
@@ -88,9 +120,140 @@ Service Objects::service(const Path& path, const Interface& interface) const
         elog<InternalFailure>();
     }
 
+    services[path] = result.begin()->first;
+    watchOwner(result.begin()->first);
     return result.begin()->first;
 }
 
+void Objects::watchOwner(const Service& name) const
+{
+    if (owners.find(name) != owners.end())
+    {
+        return;
+    }
+
+    // Only the settings services' own NameOwnerChanged, not every client
+    // connecting to the bus
+    owners.emplace(name, std::make_unique<sdbusplus::bus::match_t>(
+                             bus,
+                             sdbusRule::nameOwnerChanged() +
+                             sdbusRule::argN(0, name),
+                             std::bind(&Objects::nameOwnerChanged, this,
+                                       std::placeholders::_1)));
+}
+
+void Objects::load(const Path& path, const Interface& interface) const
+{
+    // An interface that can't be mirrored is read from the object instead
+    try
+    {
+        properties[path][interface] = ipmi::getAllDbusProperties(
+                                          bus, service(path, interface),
+                                          path, interface);
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>("Failed to mirror settings",
+                        entry("OBJECT=%s", path.c_str()),
+                        entry("INTERFACE=%s", interface.c_str()),
+                        entry("ERROR=%s", e.what()));
+    }
+}
+
+ipmi::Value Objects::get(const Path& path, const Interface& interface,
+                         const Property& property) const
+{
+    // Dropped with its service, or with a change that couldn't be read:
+    // mirrored again as a whole
+    auto object = properties.find(path);
+    if (object == properties.end() ||
+        object->second.find(interface) == object->second.end())
+    {
+        load(path, interface);
+        object = properties.find(path);
+    }
+
+    if (object != properties.end())
+    {
+        auto mirrored = object->second.find(interface);
+        if (mirrored != object->second.end())
+        {
+            auto value = mirrored->second.find(property);
+            if (value != mirrored->second.end())
+            {
+                return value->second;
+            }
+        }
+    }
+
+    // The interface can't be mirrored, or doesn't have the property
+    auto value = ipmi::getDbusProperty(bus, service(path, interface), path,
+                                       interface, property);
+    properties[path][interface][property] = value;
+    return value;
+}
+
+void Objects::set(const Path& path, const Interface& interface,
+                  const Property& property, const ipmi::Value& value)
+{
+    ipmi::setDbusProperty(bus, service(path, interface), path, interface,
+                          property, value);
+    properties[path][interface][property] = value;
+}
+
+void Objects::propertiesChanged(sdbusplus::message::message& msg)
+{
+    auto object = properties.find(msg.get_path());
+    if (object == properties.end())
+    {
+        return;
+    }
+
+    Interface interface;
+    ipmi::PropertyMap changed;
+    std::vector<Property> invalidated;
+    try
+    {
+        msg.read(interface, changed, invalidated);
+    }
+    catch (const std::exception& e)
+    {
+        // Not mirrored anymore, the next read mirrors it again
+        log<level::ERR>("Failed to read settings change",
+                        entry("OBJECT=%s", msg.get_path()),
+                        entry("ERROR=%s", e.what()));
+        object->second.erase(interface);
+        return;
+    }
+
+    auto& mirrored = object->second[interface];
+    for (auto& property : changed)
+    {
+        mirrored[property.first] = std::move(property.second);
+    }
+    for (const auto& property : invalidated)
+    {
+        mirrored.erase(property);
+    }
+}
+
+void Objects::nameOwnerChanged(sdbusplus::message::message& msg) const
+{
+    std::string name, oldOwner, newOwner;
+    msg.read(name, oldOwner, newOwner);
+
+    for (auto& service : services)
+    {
+        if (service.second == name)
+        {
+            // A unique name doesn't come back, a well-known one may have a
+            // new owner with other values
+            service.second.clear();
+            properties.erase(service.first);
+        }
+    }
+}
+
 namespace boot
 {
 
@@ -118,25 +281,8 @@ std::tuple<Path, OneTimeEnabled> setting(const Objects& objects,
     const Path& oneTimeSetting = paths[index];
     const Path& regularSetting = paths[!index];
 
-    auto method =
-        objects.bus.new_method_call(
-            objects.service(oneTimeSetting, iface).c_str(),
-            oneTimeSetting.c_str(),
-            ipmi::PROP_INTF,
-            "Get");
-    method.append(enabledIntf, "Enabled");
-    auto reply = objects.bus.call(method);
-    if (reply.is_method_error())
-    {
-        log<level::ERR>("Error in getting Enabled property",
-                        entry("OBJECT=%s", oneTimeSetting.c_str()),
-                        entry("INTERFACE=%s", iface.c_str()));
-        elog<InternalFailure>();
-    }
-
-    sdbusplus::message::variant<bool> enabled;
-    reply.read(enabled);
-    auto oneTimeEnabled = enabled.get<bool>();
+    auto oneTimeEnabled = objects.get(oneTimeSetting, enabledIntf,
+                                      "Enabled").get<bool>();
     const Path& setting = oneTimeEnabled ? oneTimeSetting : regularSetting;
     return std::make_tuple(setting, oneTimeEnabled);
 }
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <map>
+#include <memory>
 #include <string>
 #include <tuple>
+#include <vector>
 #include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include "types.hpp"
 
 namespace settings
 {
@@ -10,11 +15,20 @@ namespace settings
 using Path = std::string;
 using Service = std::string;
 using Interface = std::string;
+using Property = std::string;
 
 constexpr auto root = "/";
 
 /** @class Objects
- *  @brief Fetch paths of settings d-bus objects of interest, upon construction
+ *  @brief Fetch paths of settings d-bus objects of interest, upon
+ *         construction, and mirror their properties.
+ *
+ *  @details The properties of each object are loaded with GetAll on
+ *           construction, then kept current from the PropertiesChanged
+ *           signals of the object. When the settings service goes away or
+ *           changes owner, what was mirrored from it is dropped, and loaded
+ *           again on the next read. Only used from the sd_event loop thread,
+ *           which the signals are dispatched on.
  */
 struct Objects
 {
@@ -26,15 +40,15 @@ struct Objects
          *            interested in.
          */
         Objects(sdbusplus::bus::bus& bus, const std::vector<Interface>& filter);
-        Objects(const Objects&) = default;
-        Objects& operator=(const Objects&) = default;
+        Objects(const Objects&) = delete;
+        Objects& operator=(const Objects&) = delete;
         Objects(Objects&&) = delete;
         Objects& operator=(Objects&&) = delete;
         ~Objects() = default;
 
         /** @brief Fetch d-bus service, given a path and an interface. The
-         *         service can't be cached because mapper returns unique
-         *         service names.
+         *         service is looked up again once its owner has changed,
+         *         since mapper returns unique service names.
          *
          * @param[in] path - The Dbus object
          * @param[in] interface - The Dbus interface
@@ -43,11 +57,66 @@ struct Objects
          */
         Service service(const Path& path, const Interface& interface) const;
 
+        /** @brief Read a property of a settings object from the mirror. An
+         *         interface that isn't mirrored is loaded again with GetAll,
+         *         the property is only fetched alone when that fails
+         *
+         * @param[in] path - The Dbus object
+         * @param[in] interface - The Dbus interface
+         * @param[in] property - The property name
+         *
+         * @return the property value
+         */
+        ipmi::Value get(const Path& path, const Interface& interface,
+                        const Property& property) const;
+
+        /** @brief Set a property of a settings object, and mirror the new
+         *         value right away
+         *
+         * @param[in] path - The Dbus object
+         * @param[in] interface - The Dbus interface
+         * @param[in] property - The property name
+         * @param[in] value - The new value
+         */
+        void set(const Path& path, const Interface& interface,
+                 const Property& property, const ipmi::Value& value);
+
         /** @brief map of settings objects */
         std::map<Interface, std::vector<Path>> map;
 
         /** @brief The Dbus bus object */
         sdbusplus::bus::bus& bus;
+
+    private:
+        /** @brief Mirror the properties of an object's interface */
+        void load(const Path& path, const Interface& interface) const;
+
+        /** @brief Apply a PropertiesChanged signal of a settings object */
+        void propertiesChanged(sdbusplus::message::message& msg);
+
+        /** @brief Forget what was mirrored from a service whose owner
+         *         changed
+         */
+        void nameOwnerChanged(sdbusplus::message::message& msg) const;
+
+        /** @brief Subscribe to the owner changes of a settings service */
+        void watchOwner(const Service& name) const;
+
+        /** @brief Service of each settings object, empty once it is to be
+         *         looked up again
+         */
+        mutable std::map<Path, Service> services;
+
+        /** @brief Mirrored properties, per object and interface */
+        mutable std::map<Path, std::map<Interface, ipmi::PropertyMap>>
+            properties;
+
+        /** @brief Signal matches keeping the mirror current */
+        std::vector<std::unique_ptr<sdbusplus::bus::match_t>> matches;
+
+        /** @brief NameOwnerChanged matches, per settings service */
+        mutable std::map<Service,
+                         std::unique_ptr<sdbusplus::bus::match_t>> owners;
 };
 
 namespace boot
@@ -14,6 +14,7 @@
 #include "fruread.hpp"
 #include "host-ipmid/ipmid-api.h"
 #include "read_fru_data.hpp"
+#include "sdr-repository.hpp"
 #include "selutility.hpp"
 #include "storageaddsel.h"
 #include "storagehandler.h"
@@ -25,8 +26,6 @@
 void register_netfn_storage_functions() __attribute__((constructor));
 
 unsigned int   g_sel_time    = 0xFFFFFFFF;
-extern unsigned short g_sel_reserve;
-extern const ipmi::sensor::IdInfoMap sensors;
 extern const FruMap frus;
 
 namespace {
@@ -136,7 +135,7 @@ ipmi_ret_t getSELEntry(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
 
     if (requestData->reservationID != 0)
     {
-        if (g_sel_reserve != requestData->reservationID)
+        if (get_sel_reserve_id() != requestData->reservationID)
         {
             *data_len = 0;
             return IPMI_CC_INVALID_RESERVATION_ID;
@@ -249,7 +248,7 @@ ipmi_ret_t deleteSELEntry(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
     auto requestData = reinterpret_cast<const ipmi::sel::DeleteSELEntryRequest*>
             (request);
 
-    if (g_sel_reserve != requestData->reservationID)
+    if (get_sel_reserve_id() != requestData->reservationID)
     {
         *data_len = 0;
         return IPMI_CC_INVALID_RESERVATION_ID;
@@ -334,7 +333,7 @@ ipmi_ret_t clearSEL(ipmi_netfn_t netfn, ipmi_cmd_t cmd, ipmi_request_t request,
     auto requestData = reinterpret_cast<const ipmi::sel::ClearSELRequest*>
             (request);
 
-    if (g_sel_reserve != requestData->reservationID)
+    if (get_sel_reserve_id() != requestData->reservationID)
     {
         *data_len = 0;
         return IPMI_CC_INVALID_RESERVATION_ID;
@@ -543,14 +542,13 @@ ipmi_ret_t ipmi_storage_reserve_sel(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
 {
     ipmi_ret_t rc = IPMI_CC_OK;
 
-    // IPMI spec, Reservation ID, the value simply increases against each execution of reserve_sel command.
-    if( ++g_sel_reserve == 0)
-        g_sel_reserve = 1;
+    // Reservations are kept per host by ipmid
+    unsigned short reserve = new_sel_reserve_id();
 
-    *data_len = sizeof(g_sel_reserve);
+    *data_len = sizeof(reserve);
 
     // Pack the actual response
-    memcpy(response, &g_sel_reserve, *data_len);
+    memcpy(response, &reserve, *data_len);
 
     return rc;
 }
@@ -566,7 +564,7 @@ ipmi_ret_t ipmi_storage_add_sel(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
 
     recordid = ((uint16_t)p->eventdata[1] << 8) | p->eventdata[2];
 
-    *data_len = sizeof(g_sel_reserve);
+    *data_len = sizeof(recordid);
 
     // Pack the actual response
     memcpy(response, &p->eventdata[1], 2);
@@ -689,6 +687,8 @@ ipmi_ret_t ipmi_get_repository_info(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
                              ipmi_data_len_t data_len, ipmi_context_t context)
 {
     constexpr auto sdrVersion = 0x51;
+    // Operation support, Reserve SDR Repository command supported
+    constexpr uint8_t reserveSdrSupported = 0x02;
     auto responseData =
         reinterpret_cast<GetRepositoryInfoResponse*>(response);
 
@@ -696,12 +696,25 @@ ipmi_ret_t ipmi_get_repository_info(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
 
     responseData->sdrVersion = sdrVersion;
 
-    uint16_t records = frus.size() + sensors.size();
+    auto& repository = getSdrRepository();
+    uint16_t records = repository.size();
     responseData->recordCountMs = records >> 8;
     responseData->recordCountLs = records;
 
-    responseData->freeSpace[0] = 0xFF;
-    responseData->freeSpace[1] = 0xFF;
+    // Records can't be added by hosts
+    responseData->freeSpace[0] = 0x00;
+    responseData->freeSpace[1] = 0x00;
+
+    // Hosts caching the SDR compare these to know if it changed
+    auto addition = repository.additionTimestamp();
+    auto erasure = repository.erasureTimestamp();
+    for (size_t i = 0; i < sizeof(addition); i++)
+    {
+        responseData->additionTimestamp[i] = addition >> (i * 8);
+        responseData->deletionTimestamp[i] = erasure >> (i * 8);
+    }
+
+    responseData->operationSupport = reserveSdrSupported;
 
     *data_len = sizeof(GetRepositoryInfoResponse);
 
@@ -742,8 +755,9 @@ void register_netfn_storage_functions()
     ipmi_register_callback(NETFUN_STORAGE, IPMI_CMD_ADD_SEL, NULL, ipmi_storage_add_sel,
                            PRIVILEGE_OPERATOR);
     // <Clear SEL>
-    ipmi_register_callback(NETFUN_STORAGE, IPMI_CMD_CLEAR_SEL, NULL, clearSEL,
-                           PRIVILEGE_OPERATOR);
+    ipmi_register_callback_flags(NETFUN_STORAGE, IPMI_CMD_CLEAR_SEL, NULL,
+                                 clearSEL, PRIVILEGE_OPERATOR,
+                                 IPMI_CMD_FLAG_PRIORITY_BULK);
     // <Get FRU Inventory Area Info>
     ipmi_register_callback(NETFUN_STORAGE, IPMI_CMD_GET_FRU_INV_AREA_INFO, NULL,
             ipmi_storage_get_fru_inv_area_info, PRIVILEGE_OPERATOR);
@@ -763,9 +777,10 @@ void register_netfn_storage_functions()
                            PRIVILEGE_USER);
 
     // <Get SDR>
-    ipmi_register_callback(NETFUN_STORAGE, IPMI_CMD_GET_SDR,
-                           nullptr, ipmi_sen_get_sdr,
-                           PRIVILEGE_USER);
+    ipmi_register_callback_flags(NETFUN_STORAGE, IPMI_CMD_GET_SDR,
+                                 nullptr, ipmi_sen_get_sdr,
+                                 PRIVILEGE_USER,
+                                 IPMI_CMD_FLAG_PRIORITY_BULK);
 
     ipmi::fru::registerCallbackHandler();
     return;
@@ -109,16 +109,18 @@ void register_netfn_app_functions()
 {
 
     // <Read Event Message Buffer>
-    ipmi_register_callback(NETFUN_APP, IPMI_CMD_READ_EVENT, NULL, ipmi_app_read_event,
-                           SYSTEM_INTERFACE);
+    ipmi_register_callback_flags(NETFUN_APP, IPMI_CMD_READ_EVENT, NULL,
+                                 ipmi_app_read_event, SYSTEM_INTERFACE,
+                                 IPMI_CMD_FLAG_PRIORITY_CRITICAL);
 
     // <Set BMC Global Enables>
     ipmi_register_callback(NETFUN_APP, IPMI_CMD_SET_BMC_GLOBAL_ENABLES, NULL,
                            ipmi_app_set_bmc_global_enables, SYSTEM_INTERFACE);
 
     // <Get Message Flags>
-    ipmi_register_callback(NETFUN_APP, IPMI_CMD_GET_MSG_FLAGS, NULL, ipmi_app_get_msg_flags,
-                           SYSTEM_INTERFACE);
+    ipmi_register_callback_flags(NETFUN_APP, IPMI_CMD_GET_MSG_FLAGS, NULL,
+                                 ipmi_app_get_msg_flags, SYSTEM_INTERFACE,
+                                 IPMI_CMD_FLAG_PRIORITY_CRITICAL);
 
     // Create new xyz.openbmc_project.host object on the bus
     auto objPath = std::string{CONTROL_HOST_OBJ_MGR} + '/' + HOST_NAME + '0';
@@ -0,0 +1,120 @@
+#include "ipmid.hpp"
+
+#include <host-ipmid/ipmid-api.h>
+#include <host-ipmid/ipmid-async.hpp>
+
+#include <list>
+
+#include <gtest/gtest.h>
+
+// Linked against ipmid's own router, see Makefile.am
+extern bool restricted_mode;
+
+namespace ipmi
+{
+namespace async
+{
+extern std::list<Handler> handlers;
+} // namespace async
+} // namespace ipmi
+
+using ipmi::async::Payload;
+using ipmi::async::Responder;
+
+// The router table is ipmid's, so each test registers a NetFn of its own
+constexpr ipmi_netfn_t standInNetFn = 0x30;
+constexpr ipmi_netfn_t duplicateNetFn = 0x31;
+constexpr ipmi_netfn_t callbackNetFn = 0x32;
+constexpr ipmi_netfn_t wildcardNetFn = 0x33;
+constexpr ipmi_cmd_t cmd = 0x01;
+constexpr uint8_t callbackData = 0x5A;
+
+static void asyncHandler(ipmi_netfn_t, ipmi_cmd_t, const Payload&,
+                         Responder respond)
+{
+    respond(IPMI_CC_OK, {});
+}
+
+static ipmi_ret_t callbackHandler(ipmi_netfn_t, ipmi_cmd_t, ipmi_request_t,
+                                  ipmi_response_t response,
+                                  ipmi_data_len_t data_len, ipmi_context_t)
+{
+    *static_cast<uint8_t*>(response) = callbackData;
+    *data_len = 1;
+    return IPMI_CC_OK;
+}
+
+class AsyncHandlerTest : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            restricted_mode = false;
+            kept = ipmi::async::handlers.size();
+        }
+
+        // Routes a request without data as a synchronous caller would
+        ipmi_ret_t route(ipmi_netfn_t netfn)
+        {
+            size_t length = 0;
+            return ipmi_netfn_router(netfn, cmd, nullptr, response, &length);
+        }
+
+        // Handlers kept by the registrations of the test
+        size_t added() const
+        {
+            return ipmi::async::handlers.size() - kept;
+        }
+
+        size_t kept = 0;
+        uint8_t response[MAX_IPMI_BUFFER];
+};
+
+TEST_F(AsyncHandlerTest, RoutedToTheStandIn)
+{
+    ipmi::async::registerHandler(standInNetFn, cmd, asyncHandler,
+                                 PRIVILEGE_USER);
+    EXPECT_EQ(1u, added());
+
+    // Synchronous callers can't wait for the response
+    EXPECT_EQ(IPMI_CC_UNSPECIFIED_ERROR, route(standInNetFn));
+}
+
+TEST_F(AsyncHandlerTest, DuplicateNotKept)
+{
+    ipmi::async::registerHandler(duplicateNetFn, cmd, asyncHandler,
+                                 PRIVILEGE_USER);
+    ipmi::async::registerHandler(duplicateNetFn, cmd, asyncHandler,
+                                 PRIVILEGE_USER);
+    EXPECT_EQ(1u, added());
+}
+
+TEST_F(AsyncHandlerTest, TakenByCallbackNotKept)
+{
+    ipmi_register_callback(callbackNetFn, cmd, nullptr, callbackHandler,
+                           PRIVILEGE_USER);
+    ipmi::async::registerHandler(callbackNetFn, cmd, asyncHandler,
+                                 PRIVILEGE_USER);
+    EXPECT_EQ(0u, added());
+
+    // The callback still answers the command
+    EXPECT_EQ(IPMI_CC_OK, route(callbackNetFn));
+    EXPECT_EQ(callbackData, response[IPMI_CC_LEN]);
+}
+
+TEST_F(AsyncHandlerTest, InvalidNetFnNotKept)
+{
+    ipmi::async::registerHandler(MAX_IPMI_NETFN, cmd, asyncHandler,
+                                 PRIVILEGE_USER);
+    EXPECT_EQ(0u, added());
+}
+
+TEST_F(AsyncHandlerTest, ClaimsTheWildcardsCommand)
+{
+    ipmi_register_callback(wildcardNetFn, IPMI_CMD_WILDCARD, nullptr,
+                           callbackHandler, PRIVILEGE_USER);
+    ipmi::async::registerHandler(wildcardNetFn, cmd, asyncHandler,
+                                 PRIVILEGE_USER);
+    EXPECT_EQ(1u, added());
+    EXPECT_EQ(IPMI_CC_UNSPECIFIED_ERROR, route(wildcardNetFn));
+}
@@ -0,0 +1,16 @@
+#include "chassishandler.h"
+#include "handler_benchmark.hpp"
+
+BENCHMARK_CAPTURE(runCommand, GetChassisCapabilities,
+                  NETFUN_CHASSIS, IPMI_CMD_GET_CHASSIS_CAP,
+                  std::vector<uint8_t>{});
+BENCHMARK_CAPTURE(runCommand, GetChassisStatus,
+                  NETFUN_CHASSIS, IPMI_CMD_CHASSIS_STATUS,
+                  std::vector<uint8_t>{});
+// Boot flags parameter
+BENCHMARK_CAPTURE(runCommand, GetSystemBootOptions,
+                  NETFUN_CHASSIS, IPMI_CMD_GET_SYS_BOOT_OPTIONS,
+                  std::vector<uint8_t>{0x05, 0x00, 0x00});
+BENCHMARK_CAPTURE(runCommand, GetPohCounter,
+                  NETFUN_CHASSIS, IPMI_CMD_GET_POH_COUNTER,
+                  std::vector<uint8_t>{});
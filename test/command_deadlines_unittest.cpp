@@ -0,0 +1,84 @@
+#include "command-deadlines.hpp"
+
+#include <host-ipmid/ipmid-api.h>
+
+#include <gtest/gtest.h>
+
+using phosphor::ipmi::CommandDeadlines;
+using phosphor::ipmi::dueBy;
+using phosphor::ipmi::overdue;
+
+TEST(CommandDeadlinesTest, NoneWithoutAFile)
+{
+    CommandDeadlines deadlines;
+    EXPECT_EQ(0u, deadlines.get(0x06, 0x01));
+    EXPECT_EQ(0u, deadlines.get(0x3F, 0xFF));
+}
+
+TEST(CommandDeadlinesTest, CommandsOverrideTheirNetFn)
+{
+    CommandDeadlines deadlines;
+    auto data = R"({"default": 5000,
+                    "commands": [{"netfn": 10, "cmd": 71, "deadline": 0},
+                                 {"netfn": 10, "deadline": 10000},
+                                 {"netfn": 4, "cmd": 45, "deadline": 200}]})"_json;
+    EXPECT_EQ(0u, deadlines.parse(data));
+
+    EXPECT_EQ(5000u, deadlines.get(0x06, 0x01));
+    EXPECT_EQ(10000u, deadlines.get(10, 70));
+    EXPECT_EQ(0u, deadlines.get(10, 71));
+    EXPECT_EQ(200u, deadlines.get(4, 45));
+    EXPECT_EQ(5000u, deadlines.get(4, 46));
+}
+
+TEST(CommandDeadlinesTest, OutOfRangeEntriesIgnored)
+{
+    CommandDeadlines deadlines;
+    auto data = R"({"commands": [{"netfn": 64, "deadline": 100},
+                                 {"netfn": 6, "cmd": 256, "deadline": 100},
+                                 {"netfn": 6, "cmd": 1, "deadline": 100}]})"_json;
+    EXPECT_EQ(2u, deadlines.parse(data));
+    EXPECT_EQ(100u, deadlines.get(6, 1));
+    EXPECT_EQ(0u, deadlines.get(6, 0));
+}
+
+TEST(CommandDeadlinesTest, InvalidFileLeavesTheDeadlines)
+{
+    CommandDeadlines deadlines;
+    deadlines.parse(R"({"default": 1000})"_json);
+
+    auto missing = R"({"default": 5000,
+                       "commands": [{"netfn": 6, "cmd": 1}]})"_json;
+    EXPECT_THROW(deadlines.parse(missing), nlohmann::json::exception);
+    auto mistyped = R"({"default": "5s"})"_json;
+    EXPECT_THROW(deadlines.parse(mistyped), nlohmann::json::exception);
+
+    EXPECT_EQ(1000u, deadlines.get(6, 1));
+}
+
+TEST(CommandDeadlinesTest, DueFromWhenReceived)
+{
+    EXPECT_EQ(0u, dueBy(0, 1000000));
+    EXPECT_EQ(1250000u, dueBy(250, 1000000));
+}
+
+TEST(CommandDeadlinesTest, TimedOutOnceDue)
+{
+    CommandDeadlines deadlines;
+    deadlines.parse(R"({"default": 100})"_json);
+
+    // What the router answers a request that waited past its deadline,
+    // before or after calling the handler
+    auto due = dueBy(deadlines.get(6, 1), 1000000);
+    auto answer = [due](uint64_t now)
+    {
+        return overdue(due, now) ? IPMI_CC_TIMEOUT : IPMI_CC_OK;
+    };
+    EXPECT_EQ(IPMI_CC_OK, answer(1000000));
+    EXPECT_EQ(IPMI_CC_OK, answer(1099999));
+    EXPECT_EQ(IPMI_CC_TIMEOUT, answer(1100000));
+    EXPECT_EQ(0xC3, IPMI_CC_TIMEOUT);
+
+    // Without a deadline a request is never late
+    EXPECT_FALSE(overdue(dueBy(0, 1000000), UINT64_MAX));
+}
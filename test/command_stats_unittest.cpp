@@ -0,0 +1,187 @@
+#include "command-stats.hpp"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <host-ipmid/ipmid-api.h>
+
+#include <gtest/gtest.h>
+
+using phosphor::ipmi::CommandStats;
+using phosphor::ipmi::LatencyHistogram;
+
+// Linked against ipmid's own router, see Makefile.am
+extern phosphor::ipmi::CommandStats commandStats;
+
+TEST(LatencyHistogramTest, EmptyIsZero)
+{
+    LatencyHistogram histogram;
+    EXPECT_EQ(0u, histogram.count());
+    EXPECT_EQ(0u, histogram.percentile(50));
+    EXPECT_EQ(0u, histogram.max());
+}
+
+TEST(LatencyHistogramTest, SmallDurationsExact)
+{
+    LatencyHistogram histogram;
+    for (uint64_t usec = 1; usec <= 8; usec++)
+    {
+        histogram.record(usec);
+    }
+    EXPECT_EQ(8u, histogram.count());
+    EXPECT_EQ(1u, histogram.percentile(0));
+    EXPECT_EQ(4u, histogram.percentile(50));
+    EXPECT_EQ(8u, histogram.percentile(100));
+}
+
+TEST(LatencyHistogramTest, BucketsWithinAnEighth)
+{
+    for (uint64_t usec : {9ull, 96ull, 100ull, 1000ull, 123456ull,
+                          4000000000ull})
+    {
+        LatencyHistogram histogram;
+        histogram.record(usec);
+        histogram.record(UINT32_MAX);
+
+        // The upper bound of the duration's bucket
+        auto bound = histogram.percentile(50);
+        EXPECT_LE(usec, bound);
+        EXPECT_GE(usec + usec / LatencyHistogram::subBuckets, bound);
+    }
+
+    // 96 to 103 share a bucket
+    LatencyHistogram histogram;
+    histogram.record(96);
+    histogram.record(1000);
+    EXPECT_EQ(103u, histogram.percentile(50));
+}
+
+TEST(LatencyHistogramTest, LongerDurationsCountedLast)
+{
+    LatencyHistogram histogram;
+    histogram.record(1);
+    histogram.record(1ull << 40);
+    EXPECT_EQ(1u, histogram.percentile(50));
+    EXPECT_EQ(1ull << 40, histogram.percentile(100));
+    EXPECT_EQ(1ull << 40, histogram.max());
+}
+
+TEST(CommandStatsTest, EveryCommandWithoutAPredicate)
+{
+    CommandStats stats;
+    stats.record(0x06, 0x01, IPMI_CC_OK, 5, 7, 1);
+    stats.record(0x3F, 0xFF, IPMI_CC_OK, 5, 7, 1);
+    stats.reject(0x0A, 0x10);
+
+    EXPECT_EQ(3u, stats.entries().size());
+    EXPECT_EQ(1u, stats.entries().at(0x0A10).rateLimited);
+    EXPECT_EQ(0u, stats.unhandledEntry().count);
+}
+
+TEST(CommandStatsTest, OthersShareTheUnhandledEntry)
+{
+    CommandStats stats([](uint8_t netfn, uint8_t cmd)
+                       {
+                           return netfn == 0x06;
+                       });
+    stats.record(0x06, 0x01, IPMI_CC_OK, 5, 7, 1);
+    stats.record(0x0A, 0x10, IPMI_CC_INVALID, 5, 7, 0);
+    stats.record(0x3F, 0xFF, IPMI_CC_INVALID, 5, 7, 0);
+    stats.reject(0x0A, 0x11);
+
+    EXPECT_EQ(1u, stats.entries().size());
+    EXPECT_EQ(1u, stats.entries().at(0x0601).count);
+    EXPECT_EQ(2u, stats.unhandledEntry().count);
+    EXPECT_EQ(2u, stats.unhandledEntry().completionCodes.at(IPMI_CC_INVALID));
+    EXPECT_EQ(1u, stats.unhandledEntry().rateLimited);
+}
+
+// ipmid's predicate, from its router table
+static ipmi_ret_t handler(ipmi_netfn_t, ipmi_cmd_t, ipmi_request_t,
+                          ipmi_response_t, ipmi_data_len_t data_len,
+                          ipmi_context_t)
+{
+    *data_len = 0;
+    return IPMI_CC_OK;
+}
+
+TEST(CommandStatsTest, OwnEntriesOnlyForOwnHandlers)
+{
+    ipmi_register_callback(0x30, 0x01, nullptr, handler, PRIVILEGE_USER);
+    ipmi_register_callback(0x31, IPMI_CMD_WILDCARD, nullptr, handler,
+                           PRIVILEGE_USER);
+    ipmi_register_callback(0x31, 0x06, nullptr, handler, PRIVILEGE_USER);
+
+    auto unhandled = commandStats.unhandledEntry().count;
+    commandStats.record(0x30, 0x01, IPMI_CC_OK, 5, 7, 0);
+    commandStats.record(0x31, 0x06, IPMI_CC_OK, 5, 7, 0);
+
+    // Not registered, served by the wildcard and out of range
+    commandStats.record(0x30, 0x02, IPMI_CC_INVALID, 5, 7, 0);
+    commandStats.record(0x31, 0x05, IPMI_CC_OK, 5, 7, 0);
+    commandStats.record(0x3F + 1, 0x01, IPMI_CC_INVALID, 5, 7, 0);
+
+    EXPECT_EQ(1u, commandStats.entries().count(0x3001));
+    EXPECT_EQ(1u, commandStats.entries().count(0x3106));
+    EXPECT_EQ(0u, commandStats.entries().count(0x3002));
+    EXPECT_EQ(0u, commandStats.entries().count(0x3105));
+    EXPECT_EQ(unhandled + 3, commandStats.unhandledEntry().count);
+}
+
+// Writes the stats to a temporary file, returns its lines
+static std::vector<std::string> dump(const CommandStats& stats)
+{
+    char path[] = "/tmp/command_stats_unittest.XXXXXX";
+    int fd = mkstemp(path);
+    EXPECT_LE(0, fd);
+    close(fd);
+
+    EXPECT_EQ(0, stats.dump(path));
+    std::vector<std::string> lines;
+    std::ifstream file(path);
+    for (std::string line; std::getline(file, line);)
+    {
+        lines.push_back(line);
+    }
+    unlink(path);
+    return lines;
+}
+
+TEST(CommandStatsTest, DumpedOneCommandPerLine)
+{
+    CommandStats stats([](uint8_t netfn, uint8_t cmd)
+                       {
+                           return netfn == 0x06;
+                       });
+    stats.record(0x06, 0x01, IPMI_CC_OK, 5, 7, 1);
+    stats.record(0x06, 0x01, IPMI_CC_INVALID_FIELD_REQUEST, 5, 7, 2);
+    stats.record(0x06, 0x02, IPMI_CC_OK, 9, 12, 0);
+    stats.reject(0x06, 0x02);
+
+    auto lines = dump(stats);
+    ASSERT_EQ(4u, lines.size());
+    EXPECT_EQ('#', lines[0][0]);
+    EXPECT_EQ('#', lines[1][0]);
+    EXPECT_EQ("0x06 0x01 2 bus_calls=1.50/2 handler_us=5/5/5/5"
+              " total_us=7/7/7/7 limited=0 0x00=1 0xCC=1", lines[2]);
+    EXPECT_EQ("0x06 0x02 1 bus_calls=0.00/0 handler_us=9/9/9/9"
+              " total_us=12/12/12/12 limited=1 0x00=1", lines[3]);
+
+    // Only once there are any
+    stats.record(0x0A, 0x10, IPMI_CC_INVALID, 5, 7, 0);
+    lines = dump(stats);
+    ASSERT_EQ(5u, lines.size());
+    EXPECT_EQ("unhandled 1 bus_calls=0.00/0 handler_us=5/5/5/5"
+              " total_us=7/7/7/7 limited=0 0xC1=1", lines[4]);
+}
+
+TEST(CommandStatsTest, DumpFailureReturned)
+{
+    CommandStats stats;
+    EXPECT_EQ(-ENOENT, stats.dump("/nonexistent/command_stats"));
+}
@@ -0,0 +1,15 @@
+#include "dcmihandler.hpp"
+#include "handler_benchmark.hpp"
+
+// DCMI requests start with the group extension identifier. Commands backed
+// by configuration files rather than D-Bus are left out.
+BENCHMARK_CAPTURE(runCommand, GetPowerLimit,
+                  NETFUN_GRPEXT, dcmi::Commands::GET_POWER_LIMIT,
+                  std::vector<uint8_t>{dcmi::groupExtId, 0x00, 0x00});
+// Offset 0, 16 bytes
+BENCHMARK_CAPTURE(runCommand, GetAssetTag,
+                  NETFUN_GRPEXT, dcmi::Commands::GET_ASSET_TAG,
+                  std::vector<uint8_t>{dcmi::groupExtId, 0x00, 0x10});
+BENCHMARK_CAPTURE(runCommand, GetMgmntCtrlIdStr,
+                  NETFUN_GRPEXT, dcmi::Commands::GET_MGMNT_CTRL_ID_STR,
+                  std::vector<uint8_t>{dcmi::groupExtId, 0x00, 0x10});
@@ -0,0 +1,52 @@
+#include <stdio.h>
+#include <exception>
+#include "mock_dbus.hpp"
+#include "mock_ipmid.hpp"
+#include "handler_benchmark.hpp"
+
+static mock::Bus* mockBus = nullptr;
+static mock::Host* mockHost = nullptr;
+
+void runCommand(benchmark::State& state, ipmi_netfn_t netfn, ipmi_cmd_t cmd,
+                std::vector<uint8_t> request)
+{
+    std::vector<uint8_t> response;
+    ipmi_ret_t cc = IPMI_CC_OK;
+    auto calls = mockBus->calls();
+
+    for (auto _ : state)
+    {
+        cc = mockHost->call(netfn, cmd, request, response);
+        benchmark::DoNotOptimize(response.data());
+    }
+
+    state.counters["bus_calls"] =
+        benchmark::Counter(mockBus->calls() - calls,
+                           benchmark::Counter::kAvgIterations);
+    state.counters["cc"] = cc;
+}
+
+// The suites are linked in, and register their benchmarks, alongside this
+// file. The provider library is loaded only once the mock services are up,
+// as some handlers query them while being registered.
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+
+    try
+    {
+        mock::Bus bus(MOCK_BMC_FIXTURE);
+        mock::Host host(bus.get());
+        host.load(PROVIDER_LIBRARY);
+
+        mockBus = &bus;
+        mockHost = &host;
+        benchmark::RunSpecifiedBenchmarks();
+    }
+    catch (const std::exception& e)
+    {
+        fprintf(stderr, "Setting up the mock BMC failed: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
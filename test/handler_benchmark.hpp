@@ -0,0 +1,12 @@
+#pragma once
+
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <host-ipmid/ipmid-api.h>
+
+// Runs one command per iteration against the mock BMC that
+// handler_benchmark's main() sets up from mock/bmc.json. Besides the time
+// per command, reports the D-Bus method calls each command makes and the
+// completion code it returned.
+void runCommand(benchmark::State& state, ipmi_netfn_t netfn, ipmi_cmd_t cmd,
+                std::vector<uint8_t> request);
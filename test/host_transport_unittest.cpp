@@ -0,0 +1,166 @@
+#include "host-transport.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using phosphor::ipmi::HostRequest;
+using phosphor::ipmi::HostTransport;
+
+// The transport on one end of a socketpair, the test plays the host on the
+// other end
+class HostTransportTest : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            int fds[2];
+            ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+            transport = std::make_unique<HostTransport>(fds[0], "test");
+            host = fds[1];
+        }
+
+        void TearDown() override
+        {
+            if (host >= 0)
+            {
+                close(host);
+            }
+        }
+
+        void hostWrite(const std::vector<uint8_t>& bytes)
+        {
+            ASSERT_EQ(static_cast<ssize_t>(bytes.size()),
+                      write(host, bytes.data(), bytes.size()));
+        }
+
+        std::vector<uint8_t> hostRead()
+        {
+            uint8_t buf[512];
+            auto n = read(host, buf, sizeof(buf));
+            return std::vector<uint8_t>(buf, buf + std::max<ssize_t>(n, 0));
+        }
+
+        std::unique_ptr<HostTransport> transport;
+        int host = -1;
+};
+
+TEST_F(HostTransportTest, ReceivesRequestsWrittenTogether)
+{
+    // Get Device ID, then Get Sensor Reading of sensor 0x10
+    hostWrite({0x03, 0x06 << 2, 0x01, 0x01,
+               0x04, 0x04 << 2 | 0x02, 0x02, 0x2D, 0x10});
+
+    std::vector<HostRequest> requests;
+    EXPECT_EQ(0, transport->receive(requests));
+    ASSERT_EQ(2u, requests.size());
+
+    EXPECT_EQ(0x06, requests[0].netfn);
+    EXPECT_EQ(0x00, requests[0].lun);
+    EXPECT_EQ(0x01, requests[0].seq);
+    EXPECT_EQ(0x01, requests[0].cmd);
+    EXPECT_TRUE(requests[0].data.empty());
+
+    EXPECT_EQ(0x04, requests[1].netfn);
+    EXPECT_EQ(0x02, requests[1].lun);
+    EXPECT_EQ(0x02, requests[1].seq);
+    EXPECT_EQ(0x2D, requests[1].cmd);
+    EXPECT_EQ(std::vector<uint8_t>({0x10}), requests[1].data);
+}
+
+TEST_F(HostTransportTest, ReassemblesSplitRequests)
+{
+    std::vector<HostRequest> requests;
+
+    hostWrite({0x05, 0x0A << 2, 0x07});
+    EXPECT_EQ(0, transport->receive(requests));
+    EXPECT_TRUE(requests.empty());
+
+    hostWrite({0x43, 0x00, 0x00});
+    EXPECT_EQ(0, transport->receive(requests));
+    ASSERT_EQ(1u, requests.size());
+    EXPECT_EQ(0x0A, requests[0].netfn);
+    EXPECT_EQ(0x07, requests[0].seq);
+    EXPECT_EQ(0x43, requests[0].cmd);
+    EXPECT_EQ(std::vector<uint8_t>({0x00, 0x00}), requests[0].data);
+}
+
+TEST_F(HostTransportTest, SkipsMalformedRequests)
+{
+    hostWrite({0x01, 0x18, 0x03, 0x06 << 2, 0x03, 0x01});
+
+    std::vector<HostRequest> requests;
+    EXPECT_EQ(0, transport->receive(requests));
+    ASSERT_EQ(1u, requests.size());
+    EXPECT_EQ(0x03, requests[0].seq);
+    EXPECT_EQ(1u, transport->dropped());
+}
+
+TEST_F(HostTransportTest, FramesResponses)
+{
+    const uint8_t data[] = {0x20, 0x81};
+    EXPECT_EQ(0, transport->send(0x01, 0x06, 0x00, 0x01, 0x00, data,
+                                 sizeof(data)));
+    EXPECT_FALSE(transport->pending());
+
+    EXPECT_EQ(std::vector<uint8_t>({0x06, 0x07 << 2, 0x01, 0x01, 0x00,
+                                    0x20, 0x81}),
+              hostRead());
+}
+
+TEST_F(HostTransportTest, RefusesOversizedResponses)
+{
+    std::vector<uint8_t> data(HostTransport::maxResponseData + 1);
+    EXPECT_EQ(-EMSGSIZE, transport->send(0x01, 0x06, 0x00, 0x01, 0x00,
+                                         data.data(), data.size()));
+}
+
+TEST_F(HostTransportTest, QueuesResponsesUntilWritable)
+{
+    // Fill the socket until the transport has to queue
+    std::vector<uint8_t> data(HostTransport::maxResponseData);
+    size_t sent = 0;
+    while (!transport->pending())
+    {
+        ASSERT_EQ(0, transport->send(sent, 0x06, 0x00, 0x01, 0x00,
+                                     data.data(), data.size()));
+        sent++;
+    }
+    // Responses go out in order once the host reads
+    size_t frameLen = 1 + 4 + data.size();
+    size_t received = 0;
+    std::vector<uint8_t> stream;
+    while (received < sent)
+    {
+        auto bytes = hostRead();
+        ASSERT_FALSE(bytes.empty());
+        stream.insert(stream.end(), bytes.begin(), bytes.end());
+        while (stream.size() >= frameLen)
+        {
+            EXPECT_EQ(static_cast<uint8_t>(received), stream[2]);
+            stream.erase(stream.begin(), stream.begin() + frameLen);
+            received++;
+        }
+        ASSERT_EQ(0, transport->flush());
+    }
+    EXPECT_FALSE(transport->pending());
+}
+
+TEST_F(HostTransportTest, ReportsHostClosed)
+{
+    hostWrite({0x03, 0x06 << 2, 0x01, 0x01});
+    close(host);
+    host = -1;
+
+    std::vector<HostRequest> requests;
+    EXPECT_EQ(-EPIPE, transport->receive(requests));
+    EXPECT_EQ(1u, requests.size());
+
+    EXPECT_EQ(-EPIPE, transport->send(0x01, 0x06, 0x00, 0x01, 0x00, nullptr,
+                                      0));
+}
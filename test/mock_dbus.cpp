@@ -0,0 +1,771 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+#include "mock_dbus.hpp"
+
+namespace mock
+{
+
+using json = nlohmann::json;
+
+constexpr auto mapperName = "xyz.openbmc_project.ObjectMapper";
+constexpr auto mapperPath = "/xyz/openbmc_project/object_mapper";
+constexpr auto mapperIntf = "xyz.openbmc_project.ObjectMapper";
+constexpr auto propIntf = "org.freedesktop.DBus.Properties";
+constexpr auto objectManagerIntf = "org.freedesktop.DBus.ObjectManager";
+
+namespace
+{
+
+using Interfaces = std::vector<std::string>;
+using ObjectTree =
+    std::map<std::string, std::map<std::string, Interfaces>>;
+
+/** @brief Signals sd-bus that the message was answered */
+int answered(int r)
+{
+    return r < 0 ? r : 1;
+}
+
+/** @brief Returns the length of the first complete type of a signature */
+size_t typeLength(const char* sig)
+{
+    switch (*sig)
+    {
+        case 'a':
+            return 1 + typeLength(sig + 1);
+        case '(':
+        case '{':
+        {
+            char end = (*sig == '(') ? ')' : '}';
+            size_t len = 1;
+            while (sig[len] != '\0' && sig[len] != end)
+            {
+                len += typeLength(sig + len);
+            }
+            return len + 1;
+        }
+        default:
+            return 1;
+    }
+}
+
+template <typename T>
+int appendBasic(sd_bus_message* m, char type, T value)
+{
+    return sd_bus_message_append_basic(m, type, &value);
+}
+
+int appendValue(sd_bus_message* m, const std::string& sig,
+                const json& value);
+
+/** @brief Appends the members of a struct or dict entry */
+int appendMembers(sd_bus_message* m, const std::string& members,
+                  const std::vector<json>& values)
+{
+    size_t pos = 0;
+    for (const auto& value : values)
+    {
+        auto len = typeLength(members.c_str() + pos);
+        int r = appendValue(m, members.substr(pos, len), value);
+        if (r < 0)
+        {
+            return r;
+        }
+        pos += len;
+    }
+    return 0;
+}
+
+/** @brief Appends a fixture value of D-Bus type sig */
+int appendValue(sd_bus_message* m, const std::string& sig, const json& value)
+{
+    int r;
+
+    switch (sig[0])
+    {
+        case 'b':
+            return appendBasic<int>(m, 'b', value.get<bool>());
+        case 'y':
+            return appendBasic<uint8_t>(m, 'y', value.get<uint8_t>());
+        case 'n':
+            return appendBasic<int16_t>(m, 'n', value.get<int16_t>());
+        case 'q':
+            return appendBasic<uint16_t>(m, 'q', value.get<uint16_t>());
+        case 'i':
+            return appendBasic<int32_t>(m, 'i', value.get<int32_t>());
+        case 'u':
+            return appendBasic<uint32_t>(m, 'u', value.get<uint32_t>());
+        case 'x':
+            return appendBasic<int64_t>(m, 'x', value.get<int64_t>());
+        case 't':
+            return appendBasic<uint64_t>(m, 't', value.get<uint64_t>());
+        case 'd':
+            return appendBasic<double>(m, 'd', value.get<double>());
+        case 's':
+        case 'o':
+        case 'g':
+            return sd_bus_message_append_basic(
+                       m, sig[0], value.get<std::string>().c_str());
+        case 'v':
+        {
+            // ["<signature>", <value>]
+            auto contents = value.at(0).get<std::string>();
+            r = sd_bus_message_open_container(m, 'v', contents.c_str());
+            if (r >= 0)
+            {
+                r = appendValue(m, contents, value.at(1));
+            }
+            return r < 0 ? r : sd_bus_message_close_container(m);
+        }
+        case '(':
+        {
+            auto members = sig.substr(1, sig.size() - 2);
+            r = sd_bus_message_open_container(m, 'r', members.c_str());
+            if (r >= 0)
+            {
+                r = appendMembers(m, members,
+                                  value.get<std::vector<json>>());
+            }
+            return r < 0 ? r : sd_bus_message_close_container(m);
+        }
+        case 'a':
+        {
+            auto element = sig.substr(1);
+            r = sd_bus_message_open_container(m, 'a', element.c_str());
+            if (r < 0)
+            {
+                return r;
+            }
+
+            if (element[0] == '{')
+            {
+                auto members = element.substr(1, element.size() - 2);
+                bool stringKey = members[0] == 's' || members[0] == 'o' ||
+                                 members[0] == 'g';
+                for (auto it = value.begin(); it != value.end() && r >= 0;
+                     ++it)
+                {
+                    // JSON keys are strings, numeric ones are parsed back
+                    json key = stringKey ? json(it.key()) :
+                                           json::parse(it.key());
+                    r = sd_bus_message_open_container(m, 'e',
+                                                      members.c_str());
+                    if (r >= 0)
+                    {
+                        r = appendMembers(m, members, {key, it.value()});
+                    }
+                    if (r >= 0)
+                    {
+                        r = sd_bus_message_close_container(m);
+                    }
+                }
+            }
+            else
+            {
+                for (const auto& item : value)
+                {
+                    r = appendValue(m, element, item);
+                    if (r < 0)
+                    {
+                        break;
+                    }
+                }
+            }
+            return r < 0 ? r : sd_bus_message_close_container(m);
+        }
+        default:
+            return -EINVAL;
+    }
+}
+
+/** @brief Reads a variant holding a basic type, as a fixture value */
+json readVariant(sd_bus_message* m)
+{
+    char type;
+    const char* contents = nullptr;
+    int r = sd_bus_message_peek_type(m, &type, &contents);
+    if (r <= 0 || type != 'v' || contents == nullptr || contents[1] != '\0')
+    {
+        throw std::invalid_argument("Only basic types can be set");
+    }
+    sd_bus_message_enter_container(m, 'v', contents);
+
+    json value;
+    union
+    {
+        int b;
+        uint8_t y;
+        int16_t n;
+        uint16_t q;
+        int32_t i;
+        uint32_t u;
+        int64_t x;
+        uint64_t t;
+        double d;
+        const char* s;
+    } data;
+    r = sd_bus_message_read_basic(m, contents[0], &data);
+    if (r <= 0)
+    {
+        throw std::invalid_argument("Malformed variant");
+    }
+    switch (contents[0])
+    {
+        case 'b': value = static_cast<bool>(data.b); break;
+        case 'y': value = data.y; break;
+        case 'n': value = data.n; break;
+        case 'q': value = data.q; break;
+        case 'i': value = data.i; break;
+        case 'u': value = data.u; break;
+        case 'x': value = data.x; break;
+        case 't': value = data.t; break;
+        case 'd': value = data.d; break;
+        default: value = data.s; break;
+    }
+
+    sd_bus_message_exit_container(m);
+    return json::array({std::string(contents), value});
+}
+
+std::string readString(sd_bus_message* m)
+{
+    const char* s = nullptr;
+    if (sd_bus_message_read_basic(m, 's', &s) <= 0)
+    {
+        throw std::invalid_argument("String argument expected");
+    }
+    return s;
+}
+
+Interfaces readStrings(sd_bus_message* m)
+{
+    Interfaces strings;
+    if (sd_bus_message_enter_container(m, 'a', "s") <= 0)
+    {
+        throw std::invalid_argument("String array argument expected");
+    }
+    const char* s = nullptr;
+    while (sd_bus_message_read_basic(m, 's', &s) > 0)
+    {
+        strings.emplace_back(s);
+    }
+    sd_bus_message_exit_container(m);
+    return strings;
+}
+
+/** @brief Returns the interfaces of an object, empty if it implements none
+ *         of filter
+ */
+Interfaces matching(const json& object, const Interfaces& filter)
+{
+    Interfaces interfaces;
+    bool match = filter.empty();
+    for (auto it = object.begin(); it != object.end(); ++it)
+    {
+        interfaces.push_back(it.key());
+        for (const auto& interface : filter)
+        {
+            match = match || interface == it.key();
+        }
+    }
+    return match ? interfaces : Interfaces();
+}
+
+/** @brief Tells if path lies below root, within depth levels if not 0 */
+bool inSubtree(const std::string& path, std::string root, int32_t depth)
+{
+    if (root == "/")
+    {
+        root.clear();
+    }
+    if (path.size() <= root.size() || path.compare(0, root.size(), root) ||
+        path[root.size()] != '/')
+    {
+        return false;
+    }
+
+    auto levels = std::count(path.begin() + root.size(), path.end(), '/');
+    return depth <= 0 || levels <= depth;
+}
+
+int replyWith(sd_bus_message* call, const std::string& sig,
+              const json& value)
+{
+    sd_bus_message* reply = nullptr;
+    int r = sd_bus_message_new_method_return(call, &reply);
+    if (r >= 0)
+    {
+        r = appendValue(reply, sig, value);
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_send(sd_bus_message_get_bus(call), reply, nullptr);
+    }
+    sd_bus_message_unref(reply);
+    return answered(r);
+}
+
+} // namespace
+
+Bus::Bus(const std::string& fixture)
+{
+    std::ifstream file(fixture);
+    auto data = json::parse(file, nullptr, false);
+    if (data.is_discarded() || !data.count("services"))
+    {
+        throw std::runtime_error("Invalid mock D-Bus fixture " + fixture);
+    }
+    services = data["services"];
+
+    try
+    {
+        startDaemon();
+
+        server = connect();
+        for (auto it = services.begin(); it != services.end(); ++it)
+        {
+            int r = sd_bus_request_name(server, it.key().c_str(), 0);
+            if (r < 0)
+            {
+                throw std::system_error(-r, std::generic_category(),
+                                        "Requesting " + it.key());
+            }
+        }
+        int r = sd_bus_request_name(server, mapperName, 0);
+        if (r >= 0)
+        {
+            r = sd_bus_add_fallback(server, &slot, "/", handleMessage, this);
+        }
+        if (r >= 0)
+        {
+            r = sd_event_new(&events);
+        }
+        if (r >= 0)
+        {
+            r = sd_bus_attach_event(server, events, SD_EVENT_PRIORITY_NORMAL);
+        }
+        if (r < 0)
+        {
+            throw std::system_error(-r, std::generic_category(),
+                                    "Setting up the mock services");
+        }
+
+        stopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (stopFd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(),
+                                    "Creating the stop eventfd");
+        }
+        r = sd_event_add_io(events, &stopSource, stopFd, EPOLLIN,
+                            [](sd_event_source*, int, uint32_t, void* e)
+                            {
+                                return sd_event_exit(
+                                           static_cast<sd_event*>(e), 0);
+                            }, events);
+        if (r < 0)
+        {
+            throw std::system_error(-r, std::generic_category(),
+                                    "Watching the stop eventfd");
+        }
+
+        client = connect();
+        thread = std::thread([this]() { sd_event_loop(events); });
+    }
+    catch (...)
+    {
+        shutdown();
+        throw;
+    }
+}
+
+Bus::~Bus()
+{
+    shutdown();
+}
+
+void Bus::shutdown()
+{
+    if (thread.joinable())
+    {
+        uint64_t one = 1;
+        while (write(stopFd, &one, sizeof(one)) < 0 && errno == EINTR)
+        {
+        }
+        thread.join();
+    }
+
+    stopSource = sd_event_source_unref(stopSource);
+    slot = sd_bus_slot_unref(slot);
+    if (server)
+    {
+        sd_bus_detach_event(server);
+    }
+    server = sd_bus_flush_close_unref(server);
+    client = sd_bus_flush_close_unref(client);
+    events = sd_event_unref(events);
+    if (stopFd >= 0)
+    {
+        close(stopFd);
+        stopFd = -1;
+    }
+
+    if (daemon > 0)
+    {
+        kill(daemon, SIGTERM);
+        waitpid(daemon, nullptr, 0);
+        daemon = -1;
+    }
+
+    if (!dir.empty())
+    {
+        unlink((dir + "/bus").c_str());
+        unlink((dir + "/bus.conf").c_str());
+        rmdir(dir.c_str());
+        dir.clear();
+    }
+}
+
+void Bus::startDaemon()
+{
+    char tmpl[] = "/tmp/ipmid-mock-XXXXXX";
+    if (mkdtemp(tmpl) == nullptr)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "Creating the mock bus directory");
+    }
+    dir = tmpl;
+    address = "unix:path=" + dir + "/bus";
+
+    auto config = dir + "/bus.conf";
+    std::ofstream conf(config);
+    conf << "<!DOCTYPE busconfig PUBLIC"
+            " \"-//freedesktop//DTD D-Bus Bus Configuration 1.0//EN\"\n"
+            " \"http://www.freedesktop.org/standards/dbus/1.0/"
+            "busconfig.dtd\">\n"
+            "<busconfig>\n"
+            "  <type>session</type>\n"
+            "  <listen>" << address << "</listen>\n"
+            "  <policy context=\"default\">\n"
+            "    <allow send_destination=\"*\" eavesdrop=\"true\"/>\n"
+            "    <allow eavesdrop=\"true\"/>\n"
+            "    <allow own=\"*\"/>\n"
+            "  </policy>\n"
+            "</busconfig>\n";
+    conf.close();
+    if (!conf)
+    {
+        throw std::runtime_error("Writing " + config + " failed");
+    }
+
+    // The daemon prints its address to the pipe once it is listening
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) < 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "Creating the dbus-daemon pipe");
+    }
+    auto configArg = "--config-file=" + config;
+    auto printArg = "--print-address=" + std::to_string(fds[1]);
+
+    daemon = fork();
+    if (daemon == 0)
+    {
+        fcntl(fds[1], F_SETFD, 0);
+        execlp("dbus-daemon", "dbus-daemon", configArg.c_str(), "--nofork",
+               "--nopidfile", printArg.c_str(), nullptr);
+        _exit(127);
+    }
+    close(fds[1]);
+    if (daemon < 0)
+    {
+        close(fds[0]);
+        throw std::system_error(errno, std::generic_category(),
+                                "Starting dbus-daemon");
+    }
+
+    std::string line;
+    char buf[256];
+    while (line.find('\n') == std::string::npos)
+    {
+        auto n = read(fds[0], buf, sizeof(buf));
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            break;
+        }
+        line.append(buf, n);
+    }
+    close(fds[0]);
+
+    if (line.find('\n') == std::string::npos)
+    {
+        throw std::runtime_error("dbus-daemon failed to start");
+    }
+}
+
+sd_bus* Bus::connect()
+{
+    sd_bus* bus = nullptr;
+    int r = sd_bus_new(&bus);
+    if (r >= 0)
+    {
+        r = sd_bus_set_address(bus, address.c_str());
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_set_bus_client(bus, 1);
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_start(bus);
+    }
+    if (r < 0)
+    {
+        sd_bus_unref(bus);
+        throw std::system_error(-r, std::generic_category(),
+                                "Connecting to the mock bus");
+    }
+    return bus;
+}
+
+int Bus::handleMessage(sd_bus_message* m, void* userdata,
+                       sd_bus_error* error)
+{
+    auto self = static_cast<Bus*>(userdata);
+    const char* destination = sd_bus_message_get_destination(m);
+    const char* path = sd_bus_message_get_path(m);
+    const char* interface = sd_bus_message_get_interface(m);
+    const char* member = sd_bus_message_get_member(m);
+    if (destination == nullptr || path == nullptr || member == nullptr)
+    {
+        return 0;
+    }
+    std::string intf = interface ? interface : "";
+
+    self->handled.fetch_add(1, std::memory_order_relaxed);
+
+    try
+    {
+        if (strcmp(destination, mapperName) == 0)
+        {
+            if (intf == mapperIntf && strcmp(path, mapperPath) == 0)
+            {
+                return self->handleMapper(m, member);
+            }
+            return answered(sd_bus_reply_method_errorf(
+                               m, SD_BUS_ERROR_UNKNOWN_METHOD,
+                               "Unknown mapper method %s", member));
+        }
+
+        auto service = self->services.find(destination);
+        if (service == self->services.end())
+        {
+            return answered(sd_bus_reply_method_errorf(
+                               m, "org.freedesktop.DBus.Error.ServiceUnknown",
+                               "No service %s", destination));
+        }
+
+        if (intf == objectManagerIntf &&
+            strcmp(member, "GetManagedObjects") == 0)
+        {
+            return self->handleManagedObjects(m, *service, path);
+        }
+
+        auto object = service->find(path);
+        if (object == service->end())
+        {
+            return answered(sd_bus_reply_method_errorf(
+                               m, SD_BUS_ERROR_UNKNOWN_OBJECT,
+                               "No object %s", path));
+        }
+
+        if (intf == propIntf)
+        {
+            return self->handleProperties(m, *object, member);
+        }
+
+        // Methods of the fixture objects succeed without doing anything
+        return answered(sd_bus_reply_method_return(m, nullptr));
+    }
+    catch (const std::exception& e)
+    {
+        return answered(sd_bus_reply_method_errorf(
+                           m, SD_BUS_ERROR_INVALID_ARGS, "%s", e.what()));
+    }
+}
+
+int Bus::handleMapper(sd_bus_message* m, const std::string& member)
+{
+    if (member == "GetObject")
+    {
+        auto path = readString(m);
+        auto filter = readStrings(m);
+
+        std::map<std::string, Interfaces> result;
+        for (auto service = services.begin(); service != services.end();
+             ++service)
+        {
+            auto object = service->find(path);
+            if (object != service->end())
+            {
+                auto interfaces = matching(*object, filter);
+                if (!interfaces.empty())
+                {
+                    result.emplace(service.key(), std::move(interfaces));
+                }
+            }
+        }
+
+        if (result.empty())
+        {
+            return answered(sd_bus_reply_method_errorf(
+                               m, "org.freedesktop.DBus.Error.FileNotFound",
+                               "No object %s", path.c_str()));
+        }
+        return replyWith(m, "a{sas}", json(result));
+    }
+
+    if (member == "GetSubTree" || member == "GetSubTreePaths")
+    {
+        auto root = readString(m);
+        int32_t depth = 0;
+        sd_bus_message_read_basic(m, 'i', &depth);
+        auto filter = readStrings(m);
+
+        ObjectTree tree;
+        for (auto service = services.begin(); service != services.end();
+             ++service)
+        {
+            for (auto object = service->begin(); object != service->end();
+                 ++object)
+            {
+                if (!inSubtree(object.key(), root, depth))
+                {
+                    continue;
+                }
+                auto interfaces = matching(*object, filter);
+                if (!interfaces.empty())
+                {
+                    tree[object.key()][service.key()] = std::move(interfaces);
+                }
+            }
+        }
+
+        if (member == "GetSubTreePaths")
+        {
+            std::vector<std::string> paths;
+            for (const auto& object : tree)
+            {
+                paths.push_back(object.first);
+            }
+            return replyWith(m, "as", json(paths));
+        }
+
+        return replyWith(m, "a{sa{sas}}", json(tree));
+    }
+
+    if (member == "GetAncestors")
+    {
+        auto path = readString(m);
+        auto filter = readStrings(m);
+
+        ObjectTree tree;
+        for (auto service = services.begin(); service != services.end();
+             ++service)
+        {
+            for (auto object = service->begin(); object != service->end();
+                 ++object)
+            {
+                if (!inSubtree(path, object.key(), 0))
+                {
+                    continue;
+                }
+                auto interfaces = matching(*object, filter);
+                if (!interfaces.empty())
+                {
+                    tree[object.key()][service.key()] = std::move(interfaces);
+                }
+            }
+        }
+
+        return replyWith(m, "a{sa{sas}}", json(tree));
+    }
+
+    return answered(sd_bus_reply_method_errorf(
+                       m, SD_BUS_ERROR_UNKNOWN_METHOD,
+                       "Unknown mapper method %s", member.c_str()));
+}
+
+int Bus::handleProperties(sd_bus_message* m, json& object,
+                          const std::string& member)
+{
+    auto interface = readString(m);
+    auto properties = object.find(interface);
+    if (properties == object.end())
+    {
+        return answered(sd_bus_reply_method_errorf(
+                           m, "org.freedesktop.DBus.Error.UnknownInterface",
+                           "No interface %s", interface.c_str()));
+    }
+
+    if (member == "GetAll")
+    {
+        return replyWith(m, "a{sv}", *properties);
+    }
+
+    auto name = readString(m);
+    auto property = properties->find(name);
+
+    if (member == "Get")
+    {
+        if (property == properties->end())
+        {
+            return answered(sd_bus_reply_method_errorf(
+                               m, SD_BUS_ERROR_UNKNOWN_PROPERTY,
+                               "No property %s", name.c_str()));
+        }
+        return replyWith(m, "v", *property);
+    }
+
+    if (member == "Set")
+    {
+        (*properties)[name] = readVariant(m);
+        return answered(sd_bus_reply_method_return(m, nullptr));
+    }
+
+    return answered(sd_bus_reply_method_errorf(
+                       m, SD_BUS_ERROR_UNKNOWN_METHOD,
+                       "Unknown method %s", member.c_str()));
+}
+
+int Bus::handleManagedObjects(sd_bus_message* m, const json& objects,
+                              const std::string& path)
+{
+    json managed = json::object();
+    for (auto object = objects.begin(); object != objects.end(); ++object)
+    {
+        if (inSubtree(object.key(), path, 0))
+        {
+            managed[object.key()] = *object;
+        }
+    }
+    return replyWith(m, "a{oa{sa{sv}}}", managed);
+}
+
+} // namespace mock
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <sys/types.h>
+#include <systemd/sd-bus.h>
+#include <systemd/sd-event.h>
+#include "nlohmann/json.hpp"
+
+namespace mock
+{
+
+/** @class Bus
+ *  @brief A private dbus-daemon with fake BMC services, so that handlers can
+ *         be exercised without a BMC.
+ *
+ *  @details The services are described by a JSON fixture:
+ *
+ *           {
+ *               "services": {
+ *                   "<bus name>": {
+ *                       "<object path>": {
+ *                           "<interface>": {
+ *                               "<property>": ["<signature>", <value>]
+ *                           }
+ *                       }
+ *                   }
+ *               }
+ *           }
+ *
+ *           Values are JSON arrays for D-Bus arrays and structs, objects for
+ *           dictionaries and ["<signature>", <value>] pairs for variants.
+ *
+ *           A single connection owns every bus name of the fixture and the
+ *           ObjectMapper's. It answers the mapper's GetObject, GetSubTree,
+ *           GetSubTreePaths and GetAncestors from the fixture, as well as
+ *           Properties Get, GetAll and Set and ObjectManager
+ *           GetManagedObjects. Any other method call on a fixture object
+ *           gets an empty reply. The services run on their own thread.
+ */
+class Bus
+{
+    public:
+        Bus() = delete;
+        Bus(const Bus&) = delete;
+        Bus& operator=(const Bus&) = delete;
+        Bus(Bus&&) = delete;
+        Bus& operator=(Bus&&) = delete;
+
+        /** @brief Starts the bus and the services
+         *
+         *  @param[in] fixture - path of the JSON fixture
+         *
+         *  @error std::runtime_error thrown if the fixture can't be read or
+         *         the bus can't be started
+         */
+        explicit Bus(const std::string& fixture);
+
+        /** @brief Stops the services and the bus */
+        ~Bus();
+
+        /** @brief Returns a client connection to the bus, for use by the
+         *         thread that created this object
+         */
+        inline sd_bus* get()
+        {
+            return client;
+        }
+
+        /** @brief Opens another connection to the bus, owned by the caller
+         *
+         *  @error std::system_error thrown if the connection fails
+         */
+        sd_bus* connect();
+
+        /** @brief Returns the number of method calls the services answered */
+        inline uint64_t calls() const
+        {
+            return handled.load(std::memory_order_relaxed);
+        }
+
+    private:
+        /** @brief Releases whatever has been set up, in reverse order */
+        void shutdown();
+
+        /** @brief Starts dbus-daemon on a socket in dir */
+        void startDaemon();
+
+        /** @brief Entry point for every method call to the services */
+        static int handleMessage(sd_bus_message* m, void* userdata,
+                                 sd_bus_error* error);
+
+        int handleMapper(sd_bus_message* m, const std::string& member);
+        int handleProperties(sd_bus_message* m, nlohmann::json& object,
+                             const std::string& member);
+        int handleManagedObjects(sd_bus_message* m,
+                                 const nlohmann::json& objects,
+                                 const std::string& path);
+
+        /** @brief Fixture services, only accessed by the service thread
+         *         once started
+         */
+        nlohmann::json services;
+
+        /** @brief Temporary directory holding the config and socket */
+        std::string dir;
+        std::string address;
+        pid_t daemon = -1;
+
+        sd_bus* client = nullptr;
+        sd_bus* server = nullptr;
+        sd_bus_slot* slot = nullptr;
+        sd_event* events = nullptr;
+        sd_event_source* stopSource = nullptr;
+        int stopFd = -1;
+        std::thread thread;
+
+        std::atomic<uint64_t> handled{0};
+};
+
+} // namespace mock
@@ -0,0 +1,151 @@
+#include <dlfcn.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include "ipmid.hpp"
+#include "timer.hpp"
+#include "mock_ipmid.hpp"
+
+// Symbols the provider libraries resolve from ipmid
+sd_bus *bus = nullptr;
+std::unique_ptr<phosphor::ipmi::Timer> networkTimer = nullptr;
+
+namespace
+{
+
+struct Registration
+{
+    ipmid_callback_t handler;
+    ipmi_context_t context;
+};
+
+std::map<std::pair<ipmi_netfn_t, ipmi_cmd_t>, Registration> registrations;
+sd_event* events = nullptr;
+unsigned short selReserve = 0xFFFF;
+
+} // namespace
+
+void ipmi_register_callback(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
+                            ipmi_context_t context, ipmid_callback_t handler,
+                            ipmi_cmd_privilege_t priv)
+{
+    ipmi_register_callback_flags(netfn, cmd, context, handler, priv,
+                                 IPMI_CMD_FLAG_NONE);
+}
+
+void ipmi_register_callback_flags(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
+                                  ipmi_context_t context,
+                                  ipmid_callback_t handler,
+                                  ipmi_cmd_privilege_t priv,
+                                  ipmi_cmd_flags_t flags)
+{
+    registrations[std::make_pair(netfn, cmd)] = {handler, context};
+}
+
+// Responses aren't cached, every call reaches the handler
+void ipmi_invalidate_cached_responses(ipmi_netfn_t netfn, ipmi_cmd_t cmd)
+{
+}
+
+// A single host is served
+ipmi_host_t ipmid_get_request_host(void)
+{
+    return 0;
+}
+
+unsigned short get_sel_reserve_id(void)
+{
+    return selReserve;
+}
+
+unsigned short new_sel_reserve_id(void)
+{
+    if (++selReserve == 0)
+    {
+        selReserve = 1;
+    }
+    return selReserve;
+}
+
+sd_bus *ipmid_get_sd_bus_connection(void)
+{
+    return bus;
+}
+
+sd_event *ipmid_get_sd_event_connection(void)
+{
+    return events;
+}
+
+sd_bus_slot *ipmid_get_sd_bus_slot(void)
+{
+    return nullptr;
+}
+
+namespace mock
+{
+
+Host::Host(sd_bus* connection)
+{
+    bus = connection;
+    sd_event_default(&events);
+}
+
+Host::~Host()
+{
+    networkTimer.reset();
+    for (auto library : libraries)
+    {
+        dlclose(library);
+    }
+    registrations.clear();
+    events = sd_event_unref(events);
+    bus = nullptr;
+}
+
+void Host::load(const std::string& library)
+{
+    auto handle = dlopen(library.c_str(), RTLD_LAZY);
+    if (handle == nullptr)
+    {
+        throw std::runtime_error(std::string("Loading provider failed: ") +
+                                 dlerror());
+    }
+    libraries.push_back(handle);
+}
+
+ipmi_ret_t Host::call(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
+                      const std::vector<uint8_t>& request,
+                      std::vector<uint8_t>& response)
+{
+    auto registration = registrations.find(std::make_pair(netfn, cmd));
+    if (registration == registrations.end())
+    {
+        registration = registrations.find(
+                           std::make_pair(netfn, IPMI_CMD_WILDCARD));
+    }
+    if (registration == registrations.end())
+    {
+        response.clear();
+        return IPMI_CC_INVALID;
+    }
+
+    // Handlers rely on both buffers being MAX_IPMI_BUFFER long
+    uint8_t requestBuf[MAX_IPMI_BUFFER] = {0};
+    uint8_t responseBuf[MAX_IPMI_BUFFER] = {0};
+    size_t len = std::min(request.size(), sizeof(requestBuf));
+    memcpy(requestBuf, request.data(), len);
+
+    ipmi_ret_t rc = registration->second.handler(netfn, cmd, requestBuf,
+                                                 responseBuf, &len,
+                                                 registration->second.context);
+
+    response.assign(responseBuf,
+                    responseBuf + std::min(len, sizeof(responseBuf)));
+    return rc;
+}
+
+} // namespace mock
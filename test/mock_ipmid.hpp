@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <host-ipmid/ipmid-api.h>
+
+namespace mock
+{
+
+/** @class Host
+ *  @brief Stands in for ipmid towards the provider libraries.
+ *
+ *  @details Defines the symbols providers resolve from ipmid: command
+ *           registration, the bus and event loop accessors and the few
+ *           globals they share with it. The program must be linked with
+ *           -export-dynamic for the libraries to see them. Only one Host
+ *           may exist at a time.
+ */
+class Host
+{
+    public:
+        Host() = delete;
+        Host(const Host&) = delete;
+        Host& operator=(const Host&) = delete;
+        Host(Host&&) = delete;
+        Host& operator=(Host&&) = delete;
+
+        /** @brief Sets the connection handlers get from
+         *         ipmid_get_sd_bus_connection()
+         *
+         *  @param[in] bus - connection to hand to the handlers
+         */
+        explicit Host(sd_bus* bus);
+
+        ~Host();
+
+        /** @brief Loads a provider library, which registers its commands
+         *
+         *  @param[in] library - path of the shared library
+         *
+         *  @error std::runtime_error thrown if it can't be loaded
+         */
+        void load(const std::string& library);
+
+        /** @brief Runs a registered command the way ipmid does
+         *
+         *  @param[in] netfn - Net function
+         *  @param[in] cmd - Command
+         *  @param[in] request - Request data
+         *  @param[out] response - Response data, without completion code
+         *
+         *  @return completion code
+         */
+        ipmi_ret_t call(ipmi_netfn_t netfn, ipmi_cmd_t cmd,
+                        const std::vector<uint8_t>& request,
+                        std::vector<uint8_t>& response);
+
+    private:
+        std::vector<void*> libraries;
+};
+
+} // namespace mock
@@ -0,0 +1,130 @@
+#include "rate-limiter.hpp"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+using phosphor::ipmi::RateLimiter;
+using phosphor::ipmi::TokenBucket;
+
+// CLOCK_MONOTONIC usec the tests start at, and a second of it
+constexpr uint64_t start = 1000000;
+constexpr uint64_t second = 1000000;
+
+// Takes tokens until the bucket runs out, returns how many were taken
+static int drain(TokenBucket& bucket, uint64_t now)
+{
+    int taken = 0;
+    while (bucket.available(now))
+    {
+        bucket.take();
+        taken++;
+    }
+    return taken;
+}
+
+TEST(TokenBucketTest, StartsWithABurst)
+{
+    TokenBucket bucket(10, 3);
+    EXPECT_TRUE(bucket.available(start));
+    EXPECT_TRUE(bucket.full());
+    EXPECT_EQ(3, drain(bucket, start));
+    EXPECT_FALSE(bucket.full());
+}
+
+TEST(TokenBucketTest, RefillsAtTheRate)
+{
+    TokenBucket bucket(10, 3);
+    drain(bucket, start);
+
+    // A token every tenth of a second
+    EXPECT_FALSE(bucket.available(start + second / 10 - 1));
+    EXPECT_TRUE(bucket.available(start + second / 10));
+    EXPECT_EQ(1, drain(bucket, start + second / 10));
+    EXPECT_EQ(2, drain(bucket, start + 3 * second / 10));
+}
+
+TEST(TokenBucketTest, RefillsUpToTheBurst)
+{
+    TokenBucket bucket(10, 3);
+    drain(bucket, start);
+
+    EXPECT_TRUE(bucket.available(start + 60 * second));
+    EXPECT_TRUE(bucket.full());
+    EXPECT_EQ(3, drain(bucket, start + 60 * second));
+}
+
+TEST(TokenBucketTest, EarlierTimesDontRefill)
+{
+    TokenBucket bucket(10, 1);
+    drain(bucket, start + second);
+    EXPECT_FALSE(bucket.available(start));
+    EXPECT_FALSE(bucket.available(start + second));
+}
+
+TEST(RateLimiterTest, BridgesHaveBucketsOfTheirOwn)
+{
+    RateLimiter limiter;
+    limiter.limitBridges({1, 2});
+    EXPECT_TRUE(limiter.enabled());
+
+    EXPECT_TRUE(limiter.admit(":1.1", 0x06, 0x01, false, start));
+    EXPECT_TRUE(limiter.admit(":1.1", 0x06, 0x01, false, start));
+    EXPECT_FALSE(limiter.admit(":1.1", 0x06, 0x01, false, start));
+
+    // The other bridge's bucket is still full
+    EXPECT_TRUE(limiter.admit(":1.2", 0x06, 0x01, false, start));
+    EXPECT_TRUE(limiter.admit(":1.2", 0x06, 0x01, false, start));
+    EXPECT_FALSE(limiter.admit(":1.2", 0x06, 0x01, false, start));
+
+    EXPECT_EQ(1u, limiter.rejected().at(":1.1"));
+    EXPECT_EQ(1u, limiter.rejected().at(":1.2"));
+}
+
+TEST(RateLimiterTest, RefusedRequestsDontDrainOtherBuckets)
+{
+    RateLimiter limiter;
+    limiter.limitCommand(0x06, 0x01, {1, 1});
+    limiter.limitBridges({1, 2});
+
+    EXPECT_TRUE(limiter.admit(":1.1", 0x06, 0x01, false, start));
+    EXPECT_FALSE(limiter.admit(":1.1", 0x06, 0x01, false, start));
+
+    // The bridge still has the token the refused command didn't take
+    EXPECT_TRUE(limiter.admit(":1.1", 0x06, 0x02, false, start));
+    EXPECT_FALSE(limiter.admit(":1.1", 0x06, 0x02, false, start));
+}
+
+TEST(RateLimiterTest, ExemptCommandsSkipTheOtherLimits)
+{
+    RateLimiter limiter;
+    limiter.limitNetFn(0x06, {1, 1});
+    limiter.limitCommand(0x06, 0x01, {0, 0});
+    limiter.limitCommand(0x06, 0x02, {1, 2});
+
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_TRUE(limiter.admit(":1.1", 0x06, 0x01, false, start));
+    }
+
+    // Only the command's own limit applies to an exempt request
+    EXPECT_TRUE(limiter.admit(":1.1", 0x06, 0x02, true, start));
+    EXPECT_TRUE(limiter.admit(":1.1", 0x06, 0x02, true, start));
+    EXPECT_FALSE(limiter.admit(":1.1", 0x06, 0x02, true, start));
+}
+
+TEST(RateLimiterTest, RefusalsCountedForBoundedBridges)
+{
+    RateLimiter limiter;
+    limiter.limitNetFn(0x06, {1, 1});
+    EXPECT_TRUE(limiter.admit(":1.0", 0x06, 0x01, false, start));
+
+    for (size_t i = 1; i <= RateLimiter::maxBridges + 4; i++)
+    {
+        auto bridge = ":1." + std::to_string(i);
+        EXPECT_FALSE(limiter.admit(bridge, 0x06, 0x01, false, start));
+    }
+
+    EXPECT_EQ(RateLimiter::maxBridges + 1, limiter.rejected().size());
+    EXPECT_EQ(4u, limiter.rejected().at(RateLimiter::otherBridges));
+}
@@ -0,0 +1,232 @@
+#include "reading-cache.hpp"
+
+#include <sys/socket.h>
+#include <systemd/sd-bus.h>
+#include <systemd/sd-id128.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using ipmi::sensor::ReadingCache;
+using ipmi::Value;
+using sdbusplus::message::variant_ns::get;
+
+constexpr auto sensorPath = "/xyz/openbmc_project/sensors/temperature/cpu0";
+constexpr auto otherPath = "/xyz/openbmc_project/sensors/temperature/cpu1";
+constexpr auto occPath = "/org/open_power/control/occ0";
+constexpr auto hwmon = "xyz.openbmc_project.Hwmon";
+constexpr auto valueIntf = "xyz.openbmc_project.Sensor.Value";
+constexpr auto propIntf = "org.freedesktop.DBus.Properties";
+
+// The cache watches one end of a direct connection, the test sends the
+// signals from the other end, which no dbus-daemon is needed for. The
+// sensors are in two namespaces, as those of a real BMC are.
+class ReadingCacheTest : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            int fds[2];
+            ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK |
+                                    SOCK_CLOEXEC, 0, fds));
+
+            sd_id128_t id;
+            ASSERT_LE(0, sd_id128_randomize(&id));
+            ASSERT_LE(0, sd_bus_new(&service));
+            ASSERT_LE(0, sd_bus_set_fd(service, fds[0], fds[0]));
+            ASSERT_LE(0, sd_bus_set_server(service, 1, id));
+            ASSERT_LE(0, sd_bus_start(service));
+
+            sd_bus* client = nullptr;
+            ASSERT_LE(0, sd_bus_new(&client));
+            ASSERT_LE(0, sd_bus_set_fd(client, fds[1], fds[1]));
+            ASSERT_LE(0, sd_bus_start(client));
+            bus = std::make_unique<sdbusplus::bus::bus>(client);
+            sd_bus_unref(client);
+
+            cache = std::make_unique<ReadingCache>();
+            cache->watch(*bus, {sensorPath, occPath});
+            deliver();
+        }
+
+        void TearDown() override
+        {
+            cache.reset();
+            bus.reset();
+            sd_bus_flush_close_unref(service);
+        }
+
+        // Runs both ends until neither has anything left to do
+        void deliver()
+        {
+            for (;;)
+            {
+                int r = 1;
+                while (r > 0)
+                {
+                    r = sd_bus_process(service, nullptr);
+                    r = std::max(r, sd_bus_process(bus->get(), nullptr));
+                }
+                ASSERT_EQ(0, r);
+                if (sd_bus_wait(bus->get(), 10000) == 0 &&
+                    sd_bus_wait(service, 10000) == 0)
+                {
+                    return;
+                }
+            }
+        }
+
+        // Signals the service changing a property, or invalidating it
+        void propertiesChanged(const char* path, double value)
+        {
+            sd_bus_message* m = nullptr;
+            ASSERT_LE(0, sd_bus_message_new_signal(service, &m, path,
+                                                   propIntf,
+                                                   "PropertiesChanged"));
+            ASSERT_LE(0, sd_bus_message_append(m, "sa{sv}as", valueIntf,
+                                               1, "Value", "d", value, 0));
+            ASSERT_LE(0, sd_bus_send(service, m, nullptr));
+            sd_bus_message_unref(m);
+            deliver();
+        }
+
+        void propertiesInvalidated(const char* path)
+        {
+            sd_bus_message* m = nullptr;
+            ASSERT_LE(0, sd_bus_message_new_signal(service, &m, path,
+                                                   propIntf,
+                                                   "PropertiesChanged"));
+            ASSERT_LE(0, sd_bus_message_append(m, "sa{sv}as", valueIntf,
+                                               0, 1, "Value"));
+            ASSERT_LE(0, sd_bus_send(service, m, nullptr));
+            sd_bus_message_unref(m);
+            deliver();
+        }
+
+        // Signals a service leaving the bus, as the bus itself would
+        void serviceGone(const char* name)
+        {
+            sd_bus_message* m = nullptr;
+            ASSERT_LE(0, sd_bus_message_new_signal(service, &m,
+                                                   "/org/freedesktop/DBus",
+                                                   "org.freedesktop.DBus",
+                                                   "NameOwnerChanged"));
+            ASSERT_LE(0, sd_bus_message_set_sender(m,
+                                                   "org.freedesktop.DBus"));
+            ASSERT_LE(0, sd_bus_message_append(m, "sss", name, ":1.42", ""));
+            ASSERT_LE(0, sd_bus_send(service, m, nullptr));
+            sd_bus_message_unref(m);
+            deliver();
+        }
+
+        // Reads the sensor value, the fetch answers the next value given,
+        // from hwmon
+        double read(const char* path = sensorPath,
+                    std::chrono::milliseconds maxAge =
+                        std::chrono::milliseconds(0))
+        {
+            auto value = cache->get(path, valueIntf, "Value", maxAge,
+                                    [this](std::string& service)
+                                    {
+                                        fetches++;
+                                        service = hwmon;
+                                        return Value(fetched);
+                                    });
+            return get<double>(value);
+        }
+
+        sd_bus* service = nullptr;
+        std::unique_ptr<sdbusplus::bus::bus> bus;
+        std::unique_ptr<ReadingCache> cache;
+        double fetched = 1.0;
+        int fetches = 0;
+};
+
+TEST_F(ReadingCacheTest, KeptUntilChanged)
+{
+    EXPECT_EQ(1.0, read());
+    fetched = 2.0;
+    EXPECT_EQ(1.0, read());
+    EXPECT_EQ(1, fetches);
+    EXPECT_EQ(1u, cache->hits());
+    EXPECT_EQ(1u, cache->misses());
+}
+
+TEST_F(ReadingCacheTest, NotWatchedAlwaysFetched)
+{
+    read(otherPath);
+    read(otherPath);
+    EXPECT_EQ(2, fetches);
+}
+
+TEST_F(ReadingCacheTest, FetchedAgainOnceExpired)
+{
+    auto maxAge = std::chrono::milliseconds(20);
+    EXPECT_EQ(1.0, read(sensorPath, maxAge));
+    fetched = 2.0;
+    EXPECT_EQ(1.0, read(sensorPath, maxAge));
+    EXPECT_EQ(1, fetches);
+
+    std::this_thread::sleep_for(maxAge);
+    EXPECT_EQ(2.0, read(sensorPath, maxAge));
+    EXPECT_EQ(2, fetches);
+}
+
+TEST_F(ReadingCacheTest, UpdatedFromChangedSignal)
+{
+    read();
+    propertiesChanged(sensorPath, 3.0);
+    EXPECT_EQ(3.0, read());
+    EXPECT_EQ(1, fetches);
+}
+
+TEST_F(ReadingCacheTest, DroppedByInvalidatedSignal)
+{
+    read();
+    propertiesInvalidated(sensorPath);
+    fetched = 2.0;
+    EXPECT_EQ(2.0, read());
+    EXPECT_EQ(2, fetches);
+}
+
+TEST_F(ReadingCacheTest, OtherObjectsSignalsIgnored)
+{
+    read();
+    propertiesChanged(otherPath, 3.0);
+    EXPECT_EQ(1.0, read());
+    EXPECT_EQ(1, fetches);
+}
+
+TEST_F(ReadingCacheTest, DroppedWhenServiceGone)
+{
+    read();
+    serviceGone(hwmon);
+    fetched = 2.0;
+    EXPECT_EQ(2.0, read());
+    EXPECT_EQ(2, fetches);
+}
+
+TEST_F(ReadingCacheTest, KeptWhenOtherServiceGone)
+{
+    read();
+    serviceGone("xyz.openbmc_project.Inventory.Manager");
+    fetched = 2.0;
+    EXPECT_EQ(1.0, read());
+    EXPECT_EQ(1, fetches);
+}
+
+TEST_F(ReadingCacheTest, UpdatedInEachNamespace)
+{
+    read(occPath);
+    propertiesChanged(occPath, 3.0);
+    EXPECT_EQ(3.0, read(occPath));
+
+    read();
+    propertiesChanged(sensorPath, 4.0);
+    EXPECT_EQ(4.0, read());
+    EXPECT_EQ(2, fetches);
+}
@@ -0,0 +1,146 @@
+#include "response-cache.hpp"
+
+#include <host-ipmid/ipmid-api.h>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using phosphor::ipmi::ResponseCache;
+
+// Stores the response of a request of one byte, taking the generation
+// when it was dispatched
+static void store(ResponseCache& cache, uint8_t netfn, uint8_t cmd,
+                  uint8_t request, uint8_t data)
+{
+    uint8_t response[] = {IPMI_CC_OK, data};
+    cache.store(netfn, cmd, &request, sizeof(request), response,
+                sizeof(response), cache.generation());
+}
+
+// Returns the data of the response kept for a request, -1 if there is none
+static int find(ResponseCache& cache, uint8_t netfn, uint8_t cmd,
+                uint8_t request)
+{
+    auto response = cache.find(netfn, cmd, &request, sizeof(request));
+    return response == nullptr ? -1 : response->at(1);
+}
+
+TEST(ResponseCacheTest, KeyedByCommandAndRequest)
+{
+    ResponseCache cache;
+    store(cache, 0x06, 0x01, 0x00, 0xAA);
+
+    EXPECT_EQ(0xAA, find(cache, 0x06, 0x01, 0x00));
+    EXPECT_EQ(-1, find(cache, 0x06, 0x01, 0x01));
+    EXPECT_EQ(-1, find(cache, 0x06, 0x02, 0x00));
+    EXPECT_EQ(-1, find(cache, 0x0A, 0x01, 0x00));
+    EXPECT_EQ(1u, cache.hits());
+    EXPECT_EQ(3u, cache.misses());
+}
+
+TEST(ResponseCacheTest, StoredAgainReplaces)
+{
+    ResponseCache cache;
+    store(cache, 0x06, 0x01, 0x00, 0xAA);
+    store(cache, 0x06, 0x01, 0x00, 0xBB);
+    EXPECT_EQ(0xBB, find(cache, 0x06, 0x01, 0x00));
+}
+
+TEST(ResponseCacheTest, LeastRecentlyUsedEvicted)
+{
+    ResponseCache cache;
+    for (size_t i = 0; i < ResponseCache::maxEntries; i++)
+    {
+        store(cache, 0x06, i, 0x00, i);
+    }
+
+    // Looking the oldest up makes the second oldest the least recent
+    EXPECT_EQ(0, find(cache, 0x06, 0, 0x00));
+    store(cache, 0x0A, 0x01, 0x00, 0xAA);
+    EXPECT_EQ(0, find(cache, 0x06, 0, 0x00));
+    EXPECT_EQ(-1, find(cache, 0x06, 1, 0x00));
+    EXPECT_EQ(0xAA, find(cache, 0x0A, 0x01, 0x00));
+}
+
+TEST(ResponseCacheTest, StoringAgainCountsAsUse)
+{
+    ResponseCache cache;
+    for (size_t i = 0; i < ResponseCache::maxEntries; i++)
+    {
+        store(cache, 0x06, i, 0x00, i);
+    }
+
+    store(cache, 0x06, 0, 0x00, 0xAA);
+    store(cache, 0x0A, 0x01, 0x00, 0xBB);
+    EXPECT_EQ(0xAA, find(cache, 0x06, 0, 0x00));
+    EXPECT_EQ(-1, find(cache, 0x06, 1, 0x00));
+}
+
+TEST(ResponseCacheTest, BoundedByMaxEntries)
+{
+    ResponseCache cache;
+    for (size_t i = 0; i < 2 * ResponseCache::maxEntries; i++)
+    {
+        store(cache, 0x06 + i / 256, i % 256, 0x00, i);
+    }
+
+    // Only the last maxEntries stored are left
+    size_t kept = 0;
+    for (size_t i = 0; i < 2 * ResponseCache::maxEntries; i++)
+    {
+        if (find(cache, 0x06 + i / 256, i % 256, 0x00) != -1)
+        {
+            EXPECT_LE(ResponseCache::maxEntries, i);
+            kept++;
+        }
+    }
+    EXPECT_EQ(ResponseCache::maxEntries, kept);
+}
+
+TEST(ResponseCacheTest, StaleResponseIgnored)
+{
+    ResponseCache cache;
+    auto since = cache.generation();
+    cache.invalidate(0x0A, 0x10);
+    EXPECT_NE(since, cache.generation());
+
+    // Dispatched before the invalidation, of any command
+    uint8_t request = 0x00;
+    uint8_t response[] = {IPMI_CC_OK, 0xAA};
+    cache.store(0x06, 0x01, &request, sizeof(request), response,
+                sizeof(response), since);
+    EXPECT_EQ(-1, find(cache, 0x06, 0x01, 0x00));
+
+    cache.store(0x06, 0x01, &request, sizeof(request), response,
+                sizeof(response), cache.generation());
+    EXPECT_EQ(0xAA, find(cache, 0x06, 0x01, 0x00));
+}
+
+TEST(ResponseCacheTest, InvalidateDropsTheCommand)
+{
+    ResponseCache cache;
+    store(cache, 0x06, 0x01, 0x00, 0xAA);
+    store(cache, 0x06, 0x01, 0x01, 0xAB);
+    store(cache, 0x06, 0x02, 0x00, 0xBB);
+
+    cache.invalidate(0x06, 0x01);
+    EXPECT_EQ(-1, find(cache, 0x06, 0x01, 0x00));
+    EXPECT_EQ(-1, find(cache, 0x06, 0x01, 0x01));
+    EXPECT_EQ(0xBB, find(cache, 0x06, 0x02, 0x00));
+}
+
+TEST(ResponseCacheTest, WildcardDropsTheNetFn)
+{
+    ResponseCache cache;
+    store(cache, 0x04, 0xFF, 0x00, 0x44);
+    store(cache, 0x06, 0x00, 0x00, 0x60);
+    store(cache, 0x06, 0xFE, 0x00, 0x6E);
+    store(cache, 0x07, 0x00, 0x00, 0x70);
+
+    cache.invalidate(0x06, IPMI_CMD_WILDCARD);
+    EXPECT_EQ(-1, find(cache, 0x06, 0x00, 0x00));
+    EXPECT_EQ(-1, find(cache, 0x06, 0xFE, 0x00));
+    EXPECT_EQ(0x44, find(cache, 0x04, 0xFF, 0x00));
+    EXPECT_EQ(0x70, find(cache, 0x07, 0x00, 0x00));
+}
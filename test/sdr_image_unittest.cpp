@@ -0,0 +1,149 @@
+#include "sdr-image.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using ipmi::sdr::Image;
+using ipmi::sdr::endOfRecords;
+using ipmi::sdr::wholeRecord;
+
+// A record of length bytes filled with its ID and the offset of each byte
+static std::vector<uint8_t> makeRecord(uint16_t id, size_t length)
+{
+    std::vector<uint8_t> record(length);
+    for (size_t i = 0; i < length; i++)
+    {
+        record[i] = id + i;
+    }
+    return record;
+}
+
+class ImageTest : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            for (auto id : ids)
+            {
+                auto record = makeRecord(id, id < 256 ? 64 : 32);
+                image.update(id, record.data(), record.size());
+            }
+        }
+
+        // Sensor records, then FRU records from 256
+        const std::vector<uint16_t> ids {0x54, 0x60, 0xD0, 256, 258};
+        Image image;
+        uint8_t out[64];
+        uint16_t next = 0;
+};
+
+TEST_F(ImageTest, WalksRecordsInOrder)
+{
+    EXPECT_EQ(ids.size(), image.size());
+    EXPECT_EQ(ids.front(), image.first());
+
+    std::vector<uint16_t> walked;
+    uint16_t id = 0;
+    do
+    {
+        ASSERT_EQ(5, image.read(id, 0, 5, out, sizeof(out), next));
+        walked.push_back(out[0]);
+        id = next;
+    } while (id != endOfRecords);
+
+    std::vector<uint16_t> expected;
+    for (auto id : ids)
+    {
+        expected.push_back(static_cast<uint8_t>(id));
+    }
+    EXPECT_EQ(expected, walked);
+}
+
+TEST_F(ImageTest, ReadsWholeRecord)
+{
+    ASSERT_EQ(64, image.read(0xD0, 0, wholeRecord, out, sizeof(out), next));
+    EXPECT_EQ(makeRecord(0xD0, 64), std::vector<uint8_t>(out, out + 64));
+    EXPECT_EQ(256, next);
+
+    ASSERT_EQ(32, image.read(258, 0, wholeRecord, out, sizeof(out), next));
+    EXPECT_EQ(makeRecord(258, 32), std::vector<uint8_t>(out, out + 32));
+    EXPECT_EQ(endOfRecords, next);
+}
+
+TEST_F(ImageTest, ReadsPartOfRecord)
+{
+    auto record = makeRecord(0x60, 64);
+    ASSERT_EQ(16, image.read(0x60, 20, 16, out, sizeof(out), next));
+    EXPECT_EQ(std::vector<uint8_t>(record.begin() + 20, record.begin() + 36),
+              std::vector<uint8_t>(out, out + 16));
+    EXPECT_EQ(0xD0, next);
+
+    // Reads stop at the end of the record
+    EXPECT_EQ(4, image.read(0x60, 60, 16, out, sizeof(out), next));
+    EXPECT_EQ(0, image.read(0x60, 64, 16, out, sizeof(out), next));
+    // and of the buffer
+    EXPECT_EQ(8, image.read(0x60, 0, wholeRecord, out, 8, next));
+}
+
+TEST_F(ImageTest, RejectsMissingRecordsAndOffsets)
+{
+    EXPECT_EQ(-ENOENT, image.read(0x55, 0, 5, out, sizeof(out), next));
+    EXPECT_EQ(-ENOENT, image.read(257, 0, 5, out, sizeof(out), next));
+    EXPECT_EQ(-ENOENT, image.read(1000, 0, 5, out, sizeof(out), next));
+    EXPECT_EQ(-ERANGE, image.read(256, 33, 5, out, sizeof(out), next));
+}
+
+TEST_F(ImageTest, UpdatesOnlyChangedRecords)
+{
+    auto record = makeRecord(0x60, 64);
+    EXPECT_FALSE(image.update(0x60, record.data(), record.size()));
+
+    record[10] = 0;
+    EXPECT_TRUE(image.update(0x60, record.data(), record.size()));
+    ASSERT_EQ(64, image.read(0x60, 0, wholeRecord, out, sizeof(out), next));
+    EXPECT_EQ(record, std::vector<uint8_t>(out, out + 64));
+
+    // A record changing length moves, the walk stays the same
+    record.resize(40);
+    EXPECT_TRUE(image.update(0x60, record.data(), record.size()));
+    ASSERT_EQ(40, image.read(0x60, 0, wholeRecord, out, sizeof(out), next));
+    EXPECT_EQ(record, std::vector<uint8_t>(out, out + 40));
+    EXPECT_EQ(0xD0, next);
+    EXPECT_EQ(ids.size(), image.size());
+}
+
+TEST_F(ImageTest, KeepsRecordsInIdOrder)
+{
+    auto record = makeRecord(0x10, 64);
+    EXPECT_TRUE(image.update(0x10, record.data(), record.size()));
+    record = makeRecord(0x70, 64);
+    EXPECT_TRUE(image.update(0x70, record.data(), record.size()));
+    EXPECT_EQ(0x10, image.first());
+
+    EXPECT_TRUE(image.erase(0xD0));
+    EXPECT_FALSE(image.erase(0xD0));
+    EXPECT_TRUE(image.erase(0x10));
+    EXPECT_FALSE(image.contains(0xD0));
+    EXPECT_EQ(-ENOENT, image.read(0xD0, 0, 5, out, sizeof(out), next));
+
+    std::vector<uint16_t> walked;
+    for (auto id = image.first(); id != endOfRecords; id = next)
+    {
+        ASSERT_EQ(5, image.read(id, 0, 5, out, sizeof(out), next));
+        walked.push_back(id);
+    }
+    EXPECT_EQ(std::vector<uint16_t>({0x54, 0x60, 0x70, 256, 258}), walked);
+    EXPECT_EQ(walked.size(), image.size());
+}
+
+TEST(Image, Empty)
+{
+    Image image;
+    uint8_t out[64];
+    uint16_t next = 0;
+    EXPECT_EQ(0u, image.size());
+    EXPECT_EQ(endOfRecords, image.first());
+    EXPECT_EQ(-ENOENT, image.read(0, 0, 5, out, sizeof(out), next));
+}
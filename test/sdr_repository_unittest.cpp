@@ -0,0 +1,247 @@
+#include "sdr-repository.hpp"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using ipmi::sdr::FileHeader;
+using ipmi::sdr::Image;
+using ipmi::sdr::RecordHeader;
+using ipmi::sdr::Repository;
+using ipmi::sdr::endOfRecords;
+
+// Timestamps old enough that a rebuild within the test can't set them
+constexpr uint32_t oldAddition = 1000;
+constexpr uint32_t oldErasure = 2000;
+
+// A repository saved to a file of a temporary directory
+class RepositoryTest : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            char dirTemplate[] = "/tmp/sdr_repository_unittest.XXXXXX";
+            ASSERT_NE(nullptr, mkdtemp(dirTemplate));
+            dir = dirTemplate;
+            file = dir + "/sdr";
+
+            for (uint16_t id : {1, 2, 256})
+            {
+                std::vector<uint8_t> record(id < 256 ? 64 : 32, id);
+                records.update(id, record.data(), record.size());
+            }
+        }
+
+        void TearDown() override
+        {
+            unlink(file.c_str());
+            unlink((file + ".new").c_str());
+            rmdir(dir.c_str());
+        }
+
+        // Writes the file as a repository saved with the old timestamps
+        void save(const Image& image, const char* magic = "ISDR")
+        {
+            auto f = fopen(file.c_str(), "w");
+            ASSERT_NE(nullptr, f);
+            FileHeader header = {{magic[0], magic[1], magic[2], magic[3]},
+                                 1, sizeof(RecordHeader),
+                                 oldAddition, oldErasure};
+            fwrite(&header, sizeof(header), 1, f);
+
+            uint8_t data[UINT8_MAX];
+            uint16_t next = endOfRecords;
+            for (auto id = image.first(); id != endOfRecords; id = next)
+            {
+                auto length = image.read(id, 0, ipmi::sdr::wholeRecord, data,
+                                         sizeof(data), next);
+                RecordHeader record = {id, static_cast<uint16_t>(length)};
+                fwrite(&record, sizeof(record), 1, f);
+                fwrite(data, 1, length, f);
+            }
+            fclose(f);
+        }
+
+        // Appends bytes to the file
+        void append(const std::vector<uint8_t>& bytes)
+        {
+            auto f = fopen(file.c_str(), "a");
+            ASSERT_NE(nullptr, f);
+            fwrite(bytes.data(), 1, bytes.size(), f);
+            fclose(f);
+        }
+
+        std::string dir;
+        std::string file;
+        Image records;
+        uint8_t out[64];
+        uint16_t next = 0;
+};
+
+TEST_F(RepositoryTest, StartsEmptyWithoutAFile)
+{
+    Repository repository(file);
+    EXPECT_EQ(0u, repository.size());
+    EXPECT_EQ(0u, repository.additionTimestamp());
+    EXPECT_EQ(0u, repository.erasureTimestamp());
+    EXPECT_EQ(-ENOENT, repository.read(0, 0, 0, 0, 5, out, sizeof(out),
+                                       next));
+}
+
+TEST_F(RepositoryTest, SavedAndLoadedBack)
+{
+    {
+        Repository repository(file);
+        repository.rebuild(records);
+        EXPECT_EQ(3u, repository.size());
+        EXPECT_NE(0u, repository.additionTimestamp());
+        EXPECT_EQ(0u, repository.erasureTimestamp());
+    }
+
+    Repository repository(file);
+    EXPECT_EQ(3u, repository.size());
+    EXPECT_NE(0u, repository.additionTimestamp());
+    EXPECT_EQ(0u, repository.erasureTimestamp());
+
+    EXPECT_EQ(32, repository.read(0, 0, 256, 0, ipmi::sdr::wholeRecord, out,
+                                  sizeof(out), next));
+    EXPECT_EQ(static_cast<uint8_t>(256), out[0]);
+    EXPECT_EQ(endOfRecords, next);
+}
+
+TEST_F(RepositoryTest, UnchangedRebuildKeepsTheTimestamps)
+{
+    save(records);
+    Repository repository(file);
+    EXPECT_EQ(3u, repository.size());
+
+    repository.rebuild(records);
+    EXPECT_EQ(oldAddition, repository.additionTimestamp());
+    EXPECT_EQ(oldErasure, repository.erasureTimestamp());
+}
+
+TEST_F(RepositoryTest, ChangedRecordMovesTheAdditionTimestamp)
+{
+    save(records);
+    Repository repository(file);
+
+    std::vector<uint8_t> record(64, 0xAA);
+    records.update(2, record.data(), record.size());
+    repository.rebuild(records);
+    EXPECT_NE(oldAddition, repository.additionTimestamp());
+    EXPECT_EQ(oldErasure, repository.erasureTimestamp());
+
+    EXPECT_EQ(5, repository.read(0, 0, 2, 0, 5, out, sizeof(out), next));
+    EXPECT_EQ(0xAA, out[0]);
+}
+
+TEST_F(RepositoryTest, GoneRecordMovesTheErasureTimestamp)
+{
+    save(records);
+    Repository repository(file);
+
+    records.erase(2);
+    repository.rebuild(records);
+    EXPECT_EQ(2u, repository.size());
+    EXPECT_EQ(oldAddition, repository.additionTimestamp());
+    EXPECT_NE(oldErasure, repository.erasureTimestamp());
+    EXPECT_EQ(-ENOENT, repository.read(0, 0, 2, 0, 5, out, sizeof(out),
+                                       next));
+}
+
+TEST_F(RepositoryTest, PartialReadsNeedTheHostsReservation)
+{
+    Repository repository(file);
+    repository.rebuild(records);
+
+    // Reading a record from its start needs no reservation
+    EXPECT_EQ(5, repository.read(0, 0, 1, 0, 5, out, sizeof(out), next));
+    EXPECT_EQ(-EACCES, repository.read(0, 0, 1, 5, 5, out, sizeof(out),
+                                       next));
+
+    auto reservation = repository.reserve(0);
+    EXPECT_NE(0, reservation);
+    EXPECT_EQ(5, repository.read(0, reservation, 1, 5, 5, out, sizeof(out),
+                                 next));
+    EXPECT_EQ(-EACCES, repository.read(0, reservation + 1, 1, 5, 5, out,
+                                       sizeof(out), next));
+
+    // Each host has its own, reserving again cancels the previous one
+    EXPECT_EQ(-EACCES, repository.read(1, reservation, 1, 5, 5, out,
+                                       sizeof(out), next));
+    auto again = repository.reserve(0);
+    EXPECT_EQ(-EACCES, repository.read(0, reservation, 1, 5, 5, out,
+                                       sizeof(out), next));
+    EXPECT_EQ(5, repository.read(0, again, 1, 5, 5, out, sizeof(out),
+                                 next));
+}
+
+TEST_F(RepositoryTest, ChangesCancelTheReservations)
+{
+    Repository repository(file);
+    repository.rebuild(records);
+    auto reservation = repository.reserve(0);
+
+    // Not if nothing changed
+    repository.rebuild(records);
+    EXPECT_EQ(5, repository.read(0, reservation, 1, 5, 5, out, sizeof(out),
+                                 next));
+
+    records.erase(2);
+    repository.rebuild(records);
+    EXPECT_EQ(-EACCES, repository.read(0, reservation, 1, 5, 5, out,
+                                       sizeof(out), next));
+}
+
+TEST_F(RepositoryTest, BadMagicIgnored)
+{
+    save(records, "XXXX");
+    Repository repository(file);
+    EXPECT_EQ(0u, repository.size());
+    EXPECT_EQ(0u, repository.additionTimestamp());
+}
+
+TEST_F(RepositoryTest, TruncatedRecordIgnored)
+{
+    save(records);
+    RecordHeader record = {300, 64};
+    auto header = reinterpret_cast<const uint8_t*>(&record);
+    std::vector<uint8_t> bytes(header, header + sizeof(record));
+    bytes.resize(bytes.size() + 10, 0x55);
+    append(bytes);
+
+    Repository repository(file);
+    EXPECT_EQ(0u, repository.size());
+    EXPECT_EQ(0u, repository.additionTimestamp());
+    EXPECT_EQ(0u, repository.erasureTimestamp());
+}
+
+TEST_F(RepositoryTest, EmptyRecordIgnored)
+{
+    save(records);
+    RecordHeader record = {300, 0};
+    auto header = reinterpret_cast<const uint8_t*>(&record);
+    append(std::vector<uint8_t>(header, header + sizeof(record)));
+
+    Repository repository(file);
+    EXPECT_EQ(0u, repository.size());
+}
+
+TEST_F(RepositoryTest, RebuiltOverAnIgnoredFile)
+{
+    save(records, "XXXX");
+    {
+        Repository repository(file);
+        repository.rebuild(records);
+    }
+
+    Repository repository(file);
+    EXPECT_EQ(3u, repository.size());
+}
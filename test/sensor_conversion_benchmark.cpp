@@ -0,0 +1,75 @@
+#include "sensor-conversion.hpp"
+
+#include <math.h>
+
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+// Converting D-Bus values to raw readings, as Get Sensor Reading used to
+// with pow() on every reading, against the precomputed conversion. The
+// coefficients are those of sensor 0xD0 of scripts/sensor-example.yaml.
+
+using ipmi::sensor::Conversion;
+
+constexpr uint16_t multiplier = 511;
+constexpr int64_t scaledOffset = 0;
+constexpr int8_t exponentR = 0;
+constexpr int16_t scale = -3;
+
+static std::vector<int64_t> makeValues(size_t count)
+{
+    std::vector<int64_t> values(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        values[i] = 20000 + (i * 7919) % 60000;
+    }
+    return values;
+}
+
+static void BM_Formula(benchmark::State& state)
+{
+    auto values = makeValues(state.range(0));
+    std::vector<uint8_t> raw(values.size());
+    // The exponents come from the sensor, the compiler can't fold them
+    volatile int16_t s = scale;
+    volatile int8_t r = exponentR;
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            double value = values[i] * pow(10, s - r);
+            raw[i] = static_cast<uint8_t>((value - scaledOffset) /
+                                          multiplier);
+        }
+        benchmark::DoNotOptimize(raw.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+static void BM_Conversion(benchmark::State& state)
+{
+    auto values = makeValues(state.range(0));
+    std::vector<uint8_t> raw(values.size());
+    Conversion conversion(multiplier, scaledOffset, exponentR, scale);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            raw[i] = conversion.encode(values[i]);
+        }
+        benchmark::DoNotOptimize(raw.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+// Number of values converted
+BENCHMARK(BM_Formula)->Arg(1)->Arg(128);
+BENCHMARK(BM_Conversion)->Arg(1)->Arg(128);
+
+BENCHMARK_MAIN();
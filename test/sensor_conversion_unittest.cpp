@@ -0,0 +1,74 @@
+#include "sensor-conversion.hpp"
+
+#include <math.h>
+
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+using ipmi::sensor::Conversion;
+
+// The conversion Get Sensor Reading and Get Sensor Thresholds used to make
+static double formula(int64_t value, uint16_t m, int64_t scaledOffset,
+                      int8_t exponentR, int16_t scale)
+{
+    double scaled = value * pow(10, scale - exponentR);
+    return (scaled - scaledOffset) / m;
+}
+
+struct Coefficients
+{
+    uint16_t m;
+    int64_t scaledOffset;
+    int8_t exponentR;
+    int16_t scale;
+};
+
+class ConversionTest : public ::testing::TestWithParam<Coefficients>
+{
+};
+
+TEST_P(ConversionTest, MatchesFormulaInRange)
+{
+    const auto& c = GetParam();
+    Conversion conversion(c.m, c.scaledOffset, c.exponentR, c.scale);
+
+    size_t compared = 0;
+    for (int64_t value = -200000; value <= 2000000; value += 3)
+    {
+        auto expected = formula(value, c.m, c.scaledOffset, c.exponentR,
+                                c.scale);
+        // Out of range readings were undefined, they saturate now
+        if (expected < 0 || expected >= 256)
+        {
+            continue;
+        }
+        ASSERT_EQ(static_cast<uint8_t>(expected), conversion.encode(value))
+            << "value " << value;
+        compared++;
+    }
+    EXPECT_GT(compared, 0u);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    Sensors, ConversionTest,
+    ::testing::Values(
+        // Temperature in millidegrees, 1 degree per count
+        Coefficients{1, 0, 0, -3},
+        // sensor-example.yaml 0xD0
+        Coefficients{511, 0, 0, -3},
+        // Offset readings and result exponents
+        Coefficients{1, 20, 0, -3},
+        Coefficients{3, -40, 0, 0},
+        Coefficients{7, 0, 2, 0},
+        Coefficients{100, 5, -2, -3},
+        Coefficients{49, 0, -1, 0}));
+
+TEST(Conversion, Saturates)
+{
+    Conversion conversion(1, 0, 0, 0);
+    EXPECT_EQ(0, conversion.encode(-1.0));
+    EXPECT_EQ(255, conversion.encode(256.0));
+    EXPECT_EQ(255, conversion.encode(1e300));
+    EXPECT_EQ(255, conversion.encode(NAN));
+}
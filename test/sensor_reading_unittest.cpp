@@ -0,0 +1,61 @@
+#include "sensorhandler.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "mock_dbus.hpp"
+#include "mock_ipmid.hpp"
+
+// Loads libapphandler, with the sensors generated from
+// scripts/sensor-example.yaml, against the mock BMC, as ipmid would
+class SensorReadingTest : public ::testing::Test
+{
+    protected:
+        static void SetUpTestCase()
+        {
+            bus = std::make_unique<mock::Bus>(MOCK_BMC_FIXTURE);
+            host = std::make_unique<mock::Host>(bus->get());
+            host->load(PROVIDER_LIBRARY);
+        }
+
+        static void TearDownTestCase()
+        {
+            host.reset();
+            bus.reset();
+        }
+
+        // Gets the reading of a sensor, returns the bus calls it took
+        uint64_t read(uint8_t sensor, std::vector<uint8_t>& response)
+        {
+            auto calls = bus->calls();
+            EXPECT_EQ(IPMI_CC_OK,
+                      host->call(NETFUN_SENSOR, IPMI_CMD_GET_SENSOR_READING,
+                                 {sensor}, response));
+            return bus->calls() - calls;
+        }
+
+        static std::unique_ptr<mock::Bus> bus;
+        static std::unique_ptr<mock::Host> host;
+};
+
+std::unique_ptr<mock::Bus> SensorReadingTest::bus;
+std::unique_ptr<mock::Host> SensorReadingTest::host;
+
+TEST_F(SensorReadingTest, ValueKeptForTheGeneratedSensor)
+{
+    std::vector<uint8_t> first, second;
+    EXPECT_NE(0u, read(0xD0, first));
+    EXPECT_EQ(0u, read(0xD0, second));
+    EXPECT_EQ(first, second);
+}
+
+TEST_F(SensorReadingTest, AssertionKeptForTheGeneratedSensor)
+{
+    // Its object isn't below the same namespace as the value sensor's
+    std::vector<uint8_t> first, second;
+    EXPECT_NE(0u, read(0x63, first));
+    EXPECT_EQ(0u, read(0x63, second));
+    EXPECT_EQ(first, second);
+}
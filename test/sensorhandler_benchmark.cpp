@@ -0,0 +1,24 @@
+#include "sensorhandler.h"
+#include "storagehandler.h"
+#include "handler_benchmark.hpp"
+
+// Sensor numbers are those of scripts/sensor-example.yaml
+BENCHMARK_CAPTURE(runCommand, GetSensorReadingValue,
+                  NETFUN_SENSOR, IPMI_CMD_GET_SENSOR_READING,
+                  std::vector<uint8_t>{0xD0});
+BENCHMARK_CAPTURE(runCommand, GetSensorReadingAssertion,
+                  NETFUN_SENSOR, IPMI_CMD_GET_SENSOR_READING,
+                  std::vector<uint8_t>{0x63});
+BENCHMARK_CAPTURE(runCommand, GetSensorType,
+                  NETFUN_SENSOR, IPMI_CMD_GET_SENSOR_TYPE,
+                  std::vector<uint8_t>{0xD0});
+BENCHMARK_CAPTURE(runCommand, GetSensorThresholds,
+                  NETFUN_SENSOR, IPMI_CMD_GET_SENSOR_THRESHOLDS,
+                  std::vector<uint8_t>{0xD0});
+BENCHMARK_CAPTURE(runCommand, GetDeviceSdrInfo,
+                  NETFUN_SENSOR, IPMI_CMD_GET_DEVICE_SDR_INFO,
+                  std::vector<uint8_t>{});
+// Reservation 0, first record, whole record
+BENCHMARK_CAPTURE(runCommand, GetSdr,
+                  NETFUN_STORAGE, IPMI_CMD_GET_SDR,
+                  std::vector<uint8_t>{0x00, 0x00, 0x00, 0x00, 0x00, 0xFF});
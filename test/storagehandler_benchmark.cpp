@@ -0,0 +1,19 @@
+#include "handler_benchmark.hpp"
+#include "storagehandler.h"
+
+BENCHMARK_CAPTURE(runCommand, GetSelInfo,
+                  NETFUN_STORAGE, IPMI_CMD_GET_SEL_INFO,
+                  std::vector<uint8_t>{});
+BENCHMARK_CAPTURE(runCommand, ReserveSel,
+                  NETFUN_STORAGE, IPMI_CMD_RESERVE_SEL,
+                  std::vector<uint8_t>{});
+// Reservation 0, first entry, whole record
+BENCHMARK_CAPTURE(runCommand, GetSelEntry,
+                  NETFUN_STORAGE, IPMI_CMD_GET_SEL_ENTRY,
+                  std::vector<uint8_t>{0x00, 0x00, 0x00, 0x00, 0x00, 0xFF});
+BENCHMARK_CAPTURE(runCommand, GetSelTime,
+                  NETFUN_STORAGE, IPMI_CMD_GET_SEL_TIME,
+                  std::vector<uint8_t>{});
+BENCHMARK_CAPTURE(runCommand, GetSdrRepositoryInfo,
+                  NETFUN_STORAGE, IPMI_CMD_GET_REPOSITORY_INFO,
+                  std::vector<uint8_t>{});
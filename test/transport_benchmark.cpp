@@ -0,0 +1,212 @@
+#include "host-transport.hpp"
+#include "mock_dbus.hpp"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+// Round trip of a command between the host side and ipmid, with an ipmid
+// side that answers at once on its own thread, so only the transport is
+// measured: the ReceivedMessage signal and sendMessage call exchanged with a
+// bridge over D-Bus, against a HostTransport on a socketpair.
+
+using phosphor::ipmi::HostRequest;
+using phosphor::ipmi::HostTransport;
+
+static mock::Bus* mockBus = nullptr;
+
+constexpr auto bridgePath = "/org/openbmc/HostIpmi/1";
+constexpr auto bridgeIntf = "org.openbmc.HostIpmi";
+
+// ipmid's side of the D-Bus path: answers a ReceivedMessage signal with a
+// sendMessage call to its sender, like send_ipmi_message() does
+static int handleReceivedMessage(sd_bus_message* m, void* userdata,
+                                 sd_bus_error* error)
+{
+    uint8_t seq, netfn, lun, cmd;
+    const void* data;
+    size_t len;
+    if (sd_bus_message_read(m, "yyyy", &seq, &netfn, &lun, &cmd) < 0 ||
+        sd_bus_message_read_array(m, 'y', &data, &len) < 0)
+    {
+        return 0;
+    }
+
+    sd_bus_message* call = nullptr;
+    int r = sd_bus_message_new_method_call(
+                sd_bus_message_get_bus(m), &call, sd_bus_message_get_sender(m),
+                sd_bus_message_get_path(m), bridgeIntf, "sendMessage");
+    if (r >= 0)
+    {
+        r = sd_bus_message_append(call, "yyyyy", seq, netfn | 0x01, lun, cmd,
+                                  0);
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_message_append_array(call, 'y', data, len);
+    }
+    if (r >= 0)
+    {
+        sd_bus_call_async(sd_bus_message_get_bus(m), nullptr, call, nullptr,
+                          nullptr, 0);
+    }
+    sd_bus_message_unref(call);
+    return 0;
+}
+
+// The bridge's side: completes the round trip when the response comes back
+static int handleSendMessage(sd_bus_message* m, void* userdata,
+                             sd_bus_error* error)
+{
+    *static_cast<bool*>(userdata) = true;
+    return sd_bus_reply_method_return(m, "x", static_cast<int64_t>(0));
+}
+
+static void BM_DBusBridge(benchmark::State& state)
+{
+    std::vector<uint8_t> request(state.range(0));
+    sd_bus* bridge = mockBus->connect();
+    sd_bus* ipmid = mockBus->connect();
+    sd_bus_slot* match = nullptr;
+    sd_bus_slot* object = nullptr;
+    bool responded = false;
+
+    // Adding the match waits for the daemon, so no signal can be missed
+    sd_bus_add_match(ipmid, &match,
+                     "type='signal',interface='org.openbmc.HostIpmi',"
+                     "member='ReceivedMessage'",
+                     handleReceivedMessage, nullptr);
+    sd_bus_add_object(bridge, &object, bridgePath, handleSendMessage,
+                      &responded);
+
+    std::atomic<bool> stop{false};
+    std::thread server([ipmid, &stop]()
+    {
+        while (!stop)
+        {
+            if (sd_bus_process(ipmid, nullptr) == 0)
+            {
+                sd_bus_wait(ipmid, 100000);
+            }
+        }
+    });
+
+    uint8_t seq = 0;
+    for (auto _ : state)
+    {
+        sd_bus_message* signal = nullptr;
+        sd_bus_message_new_signal(bridge, &signal, bridgePath, bridgeIntf,
+                                  "ReceivedMessage");
+        sd_bus_message_append(signal, "yyyy", seq++, 0x06, 0x00, 0x01);
+        sd_bus_message_append_array(signal, 'y', request.data(),
+                                    request.size());
+        sd_bus_send(bridge, signal, nullptr);
+        sd_bus_message_unref(signal);
+
+        responded = false;
+        while (!responded)
+        {
+            if (sd_bus_process(bridge, nullptr) == 0)
+            {
+                sd_bus_wait(bridge, UINT64_MAX);
+            }
+        }
+    }
+
+    stop = true;
+    server.join();
+    sd_bus_slot_unref(object);
+    sd_bus_slot_unref(match);
+    sd_bus_flush_close_unref(ipmid);
+    sd_bus_flush_close_unref(bridge);
+}
+
+static void BM_HostTransport(benchmark::State& state)
+{
+    std::vector<uint8_t> request(state.range(0));
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) < 0)
+    {
+        state.SkipWithError("socketpair failed");
+        return;
+    }
+
+    // ipmid's side, until the host closes its end
+    std::thread server([fd = fds[0]]()
+    {
+        HostTransport transport(fd, "bench");
+        std::vector<HostRequest> requests;
+        int r = 0;
+        while (r == 0)
+        {
+            struct pollfd pfd = {fd, POLLIN, 0};
+            poll(&pfd, 1, -1);
+            requests.clear();
+            r = transport.receive(requests);
+            for (const auto& req : requests)
+            {
+                transport.send(req.seq, req.netfn, req.lun, req.cmd, 0,
+                               req.data.data(), req.data.size());
+            }
+        }
+    });
+
+    int host = fds[1];
+    std::vector<uint8_t> frame = {
+        static_cast<uint8_t>(3 + request.size()), 0x06 << 2, 0, 0x01};
+    frame.insert(frame.end(), request.begin(), request.end());
+    std::vector<uint8_t> response(256);
+    uint8_t seq = 0;
+
+    for (auto _ : state)
+    {
+        frame[2] = seq++;
+        write(host, frame.data(), frame.size());
+
+        // Length byte, then the rest of the response
+        size_t got = 0;
+        while (got == 0 || got < 1u + response[0])
+        {
+            auto n = read(host, response.data() + got, response.size() - got);
+            if (n <= 0)
+            {
+                state.SkipWithError("host transport closed");
+                break;
+            }
+            got += n;
+        }
+    }
+
+    close(host);
+    server.join();
+}
+
+// Request data length
+BENCHMARK(BM_DBusBridge)->Arg(0)->Arg(32)->UseRealTime();
+BENCHMARK(BM_HostTransport)->Arg(0)->Arg(32)->UseRealTime();
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+
+    try
+    {
+        mock::Bus bus(MOCK_BMC_FIXTURE);
+        mockBus = &bus;
+        benchmark::RunSpecifiedBenchmarks();
+    }
+    catch (const std::exception& e)
+    {
+        fprintf(stderr, "Setting up the mock bus failed: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,20 @@
+#include "transporthandler.hpp"
+#include "handler_benchmark.hpp"
+
+// Channel 1 is eth0 in scripts/channel-example.yaml. The request is the
+// channel, the parameter, the set selector and the block selector.
+BENCHMARK_CAPTURE(runCommand, GetLanIpAddress,
+                  NETFUN_TRANSPORT, IPMI_CMD_GET_LAN,
+                  std::vector<uint8_t>{0x01, LAN_PARM_IP, 0x00, 0x00});
+BENCHMARK_CAPTURE(runCommand, GetLanIpSource,
+                  NETFUN_TRANSPORT, IPMI_CMD_GET_LAN,
+                  std::vector<uint8_t>{0x01, LAN_PARM_IPSRC, 0x00, 0x00});
+BENCHMARK_CAPTURE(runCommand, GetLanMacAddress,
+                  NETFUN_TRANSPORT, IPMI_CMD_GET_LAN,
+                  std::vector<uint8_t>{0x01, LAN_PARM_MAC, 0x00, 0x00});
+BENCHMARK_CAPTURE(runCommand, GetLanSubnetMask,
+                  NETFUN_TRANSPORT, IPMI_CMD_GET_LAN,
+                  std::vector<uint8_t>{0x01, LAN_PARM_SUBNET, 0x00, 0x00});
+BENCHMARK_CAPTURE(runCommand, GetLanGateway,
+                  NETFUN_TRANSPORT, IPMI_CMD_GET_LAN,
+                  std::vector<uint8_t>{0x01, LAN_PARM_GATEWAY, 0x00, 0x00});
@@ -0,0 +1,113 @@
+#include "worker-pool.hpp"
+
+#include <poll.h>
+
+#include <chrono>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+using phosphor::ipmi::Priority;
+using phosphor::ipmi::WorkerPool;
+
+// Stands in for a handler blocked on a D-Bus round trip
+static void handler(std::chrono::microseconds roundTrip)
+{
+    std::this_thread::sleep_for(roundTrip);
+}
+
+// Waits for the completion fd the same way the sd_event loop does
+static void waitForCompletions(WorkerPool& pool)
+{
+    struct pollfd pfd = {pool.getCompletionFd(), POLLIN, 0};
+    poll(&pfd, 1, -1);
+}
+
+// A burst of requests handled one after another on the event loop
+static void BM_Serial(benchmark::State& state)
+{
+    const auto burst = state.range(0);
+    const std::chrono::microseconds roundTrip(state.range(1));
+
+    for (auto _ : state)
+    {
+        for (auto i = 0; i < burst; i++)
+        {
+            handler(roundTrip);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+}
+
+// The same burst handed to the worker pool, with the completions run from
+// the submitting thread like ipmid does
+static void BM_Pooled(benchmark::State& state)
+{
+    const auto burst = state.range(0);
+    const std::chrono::microseconds roundTrip(state.range(1));
+    WorkerPool pool(state.range(2), burst);
+
+    for (auto _ : state)
+    {
+        int64_t completed = 0;
+        for (auto i = 0; i < burst; i++)
+        {
+            pool.submit([roundTrip]() { handler(roundTrip); },
+                        [&completed]() { completed++; });
+        }
+        while (completed < burst)
+        {
+            waitForCompletions(pool);
+            pool.runCompletions();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+}
+
+// Time until a critical job completes when submitted right after a burst of
+// bulk jobs, the rest of the burst is drained untimed
+static void BM_CriticalBehindBulk(benchmark::State& state)
+{
+    const auto burst = state.range(0);
+    const std::chrono::microseconds roundTrip(state.range(1));
+    WorkerPool pool(state.range(2), burst + 1);
+
+    for (auto _ : state)
+    {
+        int64_t completed = 0;
+        bool critical = false;
+        for (auto i = 0; i < burst; i++)
+        {
+            pool.submit([roundTrip]() { handler(roundTrip); },
+                        [&completed]() { completed++; }, Priority::bulk);
+        }
+        pool.submit([]() {}, [&critical]() { critical = true; },
+                    Priority::critical);
+        while (!critical)
+        {
+            waitForCompletions(pool);
+            pool.runCompletions();
+        }
+
+        state.PauseTiming();
+        while (completed < burst)
+        {
+            waitForCompletions(pool);
+            pool.runCompletions();
+        }
+        state.ResumeTiming();
+    }
+}
+
+// Burst size, simulated D-Bus round trip (us)
+BENCHMARK(BM_Serial)->Args({16, 0})->Args({16, 100})->Args({16, 1000})
+    ->UseRealTime();
+// Burst size, simulated D-Bus round trip (us), worker threads
+BENCHMARK(BM_Pooled)->Args({16, 0, 2})->Args({16, 100, 2})
+    ->Args({16, 1000, 2})->Args({16, 1000, 4})->UseRealTime();
+// Bulk burst size, simulated D-Bus round trip (us), worker threads. Each
+// iteration also waits for the whole burst, so keep them few.
+BENCHMARK(BM_CriticalBehindBulk)->Args({16, 1000, 2})->Args({16, 1000, 4})
+    ->Iterations(100)->UseRealTime();
+
+BENCHMARK_MAIN();
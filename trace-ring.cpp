@@ -0,0 +1,99 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+#include "trace-ring.hpp"
+
+namespace phosphor
+{
+namespace ipmi
+{
+
+void TraceRing::enable(bool enable)
+{
+    if (enable && !records)
+    {
+        records = std::make_unique<Record[]>(capacity);
+    }
+    on.store(enable, std::memory_order_relaxed);
+}
+
+void TraceRing::record(Direction direction, uint8_t ipmiSeq, uint8_t netfn,
+                       uint8_t lun, uint8_t cmd, uint8_t cc,
+                       const void* payload, size_t len)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    auto seq = head.fetch_add(1, std::memory_order_relaxed) + 1;
+    auto& rec = records[(seq - 1) % capacity];
+
+    // The record is invalid while being rewritten, dump() skips it.
+    rec.seq = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+
+    rec.timestamp = ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+    rec.direction = static_cast<uint8_t>(direction);
+    rec.ipmiSeq = ipmiSeq;
+    rec.netfn = netfn;
+    rec.lun = lun;
+    rec.cmd = cmd;
+    rec.cc = cc;
+    rec.len = std::min<size_t>(len, UINT8_MAX);
+    rec.captured = std::min(len, maxPayload);
+    memcpy(rec.payload, payload, rec.captured);
+
+    std::atomic_thread_fence(std::memory_order_release);
+    rec.seq = seq;
+}
+
+int TraceRing::dump(const std::string& path) const
+{
+    std::vector<Record> snapshot;
+
+    if (records)
+    {
+        auto end = head.load(std::memory_order_relaxed);
+        auto begin = end > capacity ? end - capacity : 0;
+        snapshot.reserve(end - begin);
+
+        for (auto seq = begin + 1; seq <= end; seq++)
+        {
+            const auto& rec = records[(seq - 1) % capacity];
+            Record copy = rec;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // Skip records that were being rewritten while copied.
+            if (copy.seq == seq && rec.seq == seq)
+            {
+                snapshot.push_back(copy);
+            }
+        }
+    }
+
+    FILE* file = fopen(path.c_str(), "we");
+    if (file == nullptr)
+    {
+        return -errno;
+    }
+
+    FileHeader header = {{'I', 'P', 'M', 'T'}, 1, sizeof(Record),
+                         static_cast<uint32_t>(snapshot.size())};
+    int r = 0;
+    if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+        fwrite(snapshot.data(), sizeof(Record), snapshot.size(), file) !=
+            snapshot.size())
+    {
+        r = -errno;
+    }
+
+    if (fclose(file) != 0 && r == 0)
+    {
+        r = -errno;
+    }
+    return r;
+}
+
+} // namespace ipmi
+} // namespace phosphor
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <stdint.h>
+
+namespace phosphor
+{
+namespace ipmi
+{
+
+/** @class TraceRing
+ *  @brief In memory history of the last IPMI requests and responses.
+ *
+ *  @details Records are kept in binary form in a fixed size ring and only
+ *           formatted when the ring is dumped, so tracing can stay enabled
+ *           in production. While disabled, recording costs a single branch
+ *           and the ring holds no memory.
+ *
+ *           A dump file starts with a FileHeader followed by count Records,
+ *           oldest first. All fields are in host byte order.
+ */
+class TraceRing
+{
+    public:
+        /** @brief Number of records kept in the ring */
+        static constexpr size_t capacity = 1024;
+
+        /** @brief Payload bytes kept per record, longer ones are truncated */
+        static constexpr size_t maxPayload = 64;
+
+        enum class Direction : uint8_t
+        {
+            request = 0,
+            response = 1,
+        };
+
+        struct Record
+        {
+            uint64_t timestamp;     //!< CLOCK_MONOTONIC, in microseconds
+            uint64_t seq;           //!< Position in the trace, from 1
+            uint8_t direction;      //!< Direction
+            uint8_t ipmiSeq;        //!< Sequence number of the message
+            uint8_t netfn;
+            uint8_t lun;
+            uint8_t cmd;
+            uint8_t cc;             //!< Completion code, responses only
+            uint8_t len;            //!< Payload length on the wire
+            uint8_t captured;       //!< Payload bytes kept in payload
+            uint8_t payload[maxPayload];
+        } __attribute__((packed));
+
+        struct FileHeader
+        {
+            char magic[4];          //!< "IPMT"
+            uint16_t version;       //!< 1
+            uint16_t recordSize;    //!< sizeof(Record)
+            uint32_t count;         //!< Number of records that follow
+        } __attribute__((packed));
+
+        TraceRing() = default;
+        TraceRing(const TraceRing&) = delete;
+        TraceRing& operator=(const TraceRing&) = delete;
+        TraceRing(TraceRing&&) = delete;
+        TraceRing& operator=(TraceRing&&) = delete;
+        ~TraceRing() = default;
+
+        /** @brief Tells if records are being kept */
+        inline bool enabled() const
+        {
+            return on.load(std::memory_order_relaxed);
+        }
+
+        /** @brief Starts or stops keeping records. The ring is allocated
+         *         when first enabled and keeps its contents when disabled,
+         *         so it can still be dumped.
+         *
+         *  @param[in] enable - whether to keep records
+         */
+        void enable(bool enable);
+
+        /** @brief Adds a record, overwriting the oldest one when full.
+         *         Callers check enabled() first.
+         */
+        void record(Direction direction, uint8_t ipmiSeq, uint8_t netfn,
+                    uint8_t lun, uint8_t cmd, uint8_t cc,
+                    const void* payload, size_t len);
+
+        /** @brief Writes the records held in the ring to a file
+         *
+         *  @param[in] path - file to write, replaced if it exists
+         *
+         *  @return 0 on success, negative errno on failure
+         */
+        int dump(const std::string& path) const;
+
+    private:
+        /** @brief Record storage, allocated on first enable */
+        std::unique_ptr<Record[]> records;
+
+        /** @brief Number of records ever claimed */
+        std::atomic<uint64_t> head{0};
+
+        /** @brief Whether records are being kept */
+        std::atomic<bool> on{false};
+};
+
+} // namespace ipmi
+} // namespace phosphor
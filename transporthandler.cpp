@@ -85,9 +85,11 @@ ipmi_ret_t getNetworkData(uint8_t lan_param, uint8_t* data, int channel)
                                 ipmi::network::ROOT,
                                 ethIP);
 
-                        auto properties = ipmi::getAllDbusProperties(
+                        auto properties =
+                            ipmi::ManagedObjects::instance().properties(
                                 bus,
                                 ipObjectInfo.second,
+                                ipmi::network::ROOT,
                                 ipObjectInfo.first,
                                 ipmi::network::IP_INTERFACE);
 
@@ -167,9 +169,11 @@ ipmi_ret_t getNetworkData(uint8_t lan_param, uint8_t* data, int channel)
                         networkInterfacePath = networkInterfaceObject.first;
                     }
 
-                    auto variant = ipmi::getDbusProperty(
+                    auto variant =
+                        ipmi::ManagedObjects::instance().property(
                             bus,
                             ipmi::network::SERVICE,
+                            ipmi::network::ROOT,
                             networkInterfacePath,
                             ipmi::network::ETHERNET_INTERFACE,
                             "DHCPEnabled");
@@ -202,9 +206,11 @@ ipmi_ret_t getNetworkData(uint8_t lan_param, uint8_t* data, int channel)
                                 ipmi::network::ROOT,
                                 ipmi::network::IP_TYPE);
 
-                        auto properties = ipmi::getAllDbusProperties(
+                        auto properties =
+                            ipmi::ManagedObjects::instance().properties(
                                 bus,
                                 ipObjectInfo.second,
+                                ipmi::network::ROOT,
                                 ipObjectInfo.first,
                                 ipmi::network::IP_INTERFACE);
 
@@ -242,9 +248,11 @@ ipmi_ret_t getNetworkData(uint8_t lan_param, uint8_t* data, int channel)
                                 ipmi::network::SYSTEMCONFIG_INTERFACE,
                                 ipmi::network::ROOT);
 
-                        auto systemProperties = ipmi::getAllDbusProperties(
+                        auto systemProperties =
+                            ipmi::ManagedObjects::instance().properties(
                                 bus,
                                 systemObject.second,
+                                ipmi::network::ROOT,
                                 systemObject.first,
                                 ipmi::network::SYSTEMCONFIG_INTERFACE);
 
@@ -280,9 +288,11 @@ ipmi_ret_t getNetworkData(uint8_t lan_param, uint8_t* data, int channel)
                                              ipmi::network::ROOT,
                                              ethdevice);
 
-                    auto variant = ipmi::getDbusProperty(
+                    auto variant =
+                        ipmi::ManagedObjects::instance().property(
                                      bus,
                                      macObjectInfo.second,
+                                     ipmi::network::ROOT,
                                      macObjectInfo.first,
                                      ipmi::network::MAC_INTERFACE,
                                      "MACAddress");
@@ -532,10 +542,15 @@ ipmi_ret_t ipmi_transport_set_lan(ipmi_netfn_t netfn,
                                  entry("GATEWAY=%s", channelConf->gateway.c_str()),
                                  entry("VLAN=%d", channelConf->vlanID));
 
-                if (!networkTimer)
+                try
+                {
+                    createNetworkTimer();
+                }
+                catch (const std::exception& e)
                 {
-                  log<level::ERR>("Network timer is not instantiated");
-                  return IPMI_CC_UNSPECIFIED_ERROR;
+                    log<level::ERR>("Network timer is not instantiated",
+                                    entry("ERROR=%s", e.what()));
+                    return IPMI_CC_UNSPECIFIED_ERROR;
                 }
 
                 // start/restart the timer
@@ -815,9 +830,11 @@ void applyChanges(int channel)
             }
 
             // get the configured mode on the system.
-            auto enableDHCP = ipmi::getDbusProperty(
+            auto enableDHCP =
+                ipmi::ManagedObjects::instance().property(
                     bus,
                     ipmi::network::SERVICE,
+                    ipmi::network::ROOT,
                     networkInterfacePath,
                     ipmi::network::ETHERNET_INTERFACE,
                     "DHCPEnabled").get<bool>();
@@ -858,9 +875,11 @@ void applyChanges(int channel)
                 // if system is not having any ip object don't throw error,
                 try
                 {
-                    auto properties = ipmi::getAllDbusProperties(
+                    auto properties =
+                        ipmi::ManagedObjects::instance().properties(
                             bus,
                             ipObject.second,
+                            ipmi::network::ROOT,
                             ipObject.first,
                             ipmi::network::IP_INTERFACE);
 
@@ -880,9 +899,11 @@ void applyChanges(int channel)
                             entry("MATCH=%s", ethIp.c_str()));
                 }
 
-                auto systemProperties = ipmi::getAllDbusProperties(
+                auto systemProperties =
+                    ipmi::ManagedObjects::instance().properties(
                         bus,
                         systemObject.second,
+                        ipmi::network::ROOT,
                         systemObject.first,
                         ipmi::network::SYSTEMCONFIG_INTERFACE);
 
@@ -1032,16 +1053,14 @@ void createNetworkTimer()
 
 void register_netfn_transport_functions()
 {
-    // As this timer is only for transport handler
-    // so creating it here.
-    createNetworkTimer();
     // <Wildcard Command>
     ipmi_register_callback(NETFUN_TRANSPORT, IPMI_CMD_WILDCARD, NULL, ipmi_transport_wildcard,
                            PRIVILEGE_USER);
 
     // <Set LAN Configuration Parameters>
-    ipmi_register_callback(NETFUN_TRANSPORT, IPMI_CMD_SET_LAN, NULL, ipmi_transport_set_lan,
-                           PRIVILEGE_ADMIN);
+    ipmi_register_callback_flags(NETFUN_TRANSPORT, IPMI_CMD_SET_LAN, NULL,
+                                 ipmi_transport_set_lan, PRIVILEGE_ADMIN,
+                                 IPMI_CMD_FLAG_PRIORITY_BULK);
 
     // <Get LAN Configuration Parameters>
     ipmi_register_callback(NETFUN_TRANSPORT, IPMI_CMD_GET_LAN, NULL, ipmi_transport_get_lan,
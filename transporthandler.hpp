@@ -77,6 +77,12 @@ struct ChannelConfig_t* getChannelConfig(int channel);
  */
 void commitNetworkChanges();
 
+/** @brief Creates the timer which commits the network changes, if it does
+ *         not exist yet. It is only needed once a Set LAN command completes,
+ *         so it is created then rather than when the provider is loaded.
+ */
+void createNetworkTimer();
+
 /* @brief  Apply the network changes which is there in the
  *         network cache for a given channel which gets filled
  *         through setLan command. If some of the network
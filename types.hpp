@@ -2,11 +2,15 @@
 
 #include <stdint.h>
 
+#include <array>
+#include <chrono>
 #include <map>
 #include <string>
 
 #include <sdbusplus/server.hpp>
 
+#include "sensor-conversion.hpp"
+
 namespace ipmi
 {
 
@@ -142,6 +146,13 @@ inline Mutability operator&(Mutability lhs, Mutability rhs)
       static_cast<uint8_t>(lhs) & static_cast<uint8_t>(rhs));
 }
 
+struct Info;
+
+// Plain function pointers, the generated sensors hold no std::function
+using UpdateFunc = uint8_t (*)(const SetSensorReadingReq&, const Info&);
+using GetFunc = GetSensorResponse (*)(const Info&);
+using SensorNameFunc = SensorName (*)(const Info&);
+
 struct Info
 {
    EntityType entityType;
@@ -158,15 +169,54 @@ struct Info
    bool hasScale;
    Scale scale;
    Unit unit;
-   std::function<uint8_t(SetSensorReadingReq&, const Info&)> updateFunc;
-   std::function<GetSensorResponse(const Info&)> getFunc;
+   UpdateFunc updateFunc;
+   GetFunc getFunc;
    Mutability mutability;
-   std::function<SensorName(const Info&)> sensorNameFunc;
+   SensorNameFunc sensorNameFunc;
    DbusInterfaceMap propertyInterfaces;
+   //!< How long a reading is kept, 0 until the object signals a change
+   std::chrono::milliseconds maxAge;
+   //!< Converts the values of an analog sensor to readings
+   Conversion conversion;
 };
 
 using Id = uint8_t;
-using IdInfoMap = std::map<Id,Info>;
+
+/** @brief The generated sensors, indexed by sensor number
+ *
+ *  @details Only holds the addresses of the sensors, so the table itself is
+ *           constant initialized.
+ */
+struct IdInfoTable
+{
+    //!< The sensor of each number, nullptr for the numbers without one
+    std::array<const Info*, 256> infos;
+    //!< Number of sensors in the table
+    size_t count;
+
+    /** @brief Returns the sensor of a number, nullptr if there is none */
+    inline const Info* find(Id id) const
+    {
+        return infos[id];
+    }
+
+    /** @brief Returns the first number from id on that has a sensor, or
+     *         infos.size() if none has
+     */
+    inline size_t next(size_t id) const
+    {
+        while (id < infos.size() && infos[id] == nullptr)
+        {
+            id++;
+        }
+        return id;
+    }
+
+    inline size_t size() const
+    {
+        return count;
+    }
+};
 
 using PropertyMap = ipmi::PropertyMap;
 
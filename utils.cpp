@@ -6,12 +6,15 @@
 #include <arpa/inet.h>
 #include <dirent.h>
 #include <net/if.h>
+#include <string.h>
+#include <algorithm>
 
 namespace ipmi
 {
 
 using namespace phosphor::logging;
 using namespace sdbusplus::xyz::openbmc_project::Common::Error;
+namespace sdbusRule = sdbusplus::bus::match::rules;
 
 namespace network
 {
@@ -37,24 +40,30 @@ DbusObjectInfo getDbusObject(sdbusplus::bus::bus& bus,
     std::vector<DbusInterface> interfaces;
     interfaces.emplace_back(interface);
 
-    auto depth = 0;
+    auto objectTree = MapperCache::instance().lookup(
+        MapperCache::Method::getSubTree, serviceRoot, interfaces,
+        [&]()
+        {
+            auto depth = 0;
 
-    auto mapperCall = bus.new_method_call(MAPPER_BUS_NAME,
-                                          MAPPER_OBJ,
-                                          MAPPER_INTF,
-                                          "GetSubTree");
+            auto mapperCall = bus.new_method_call(MAPPER_BUS_NAME,
+                                                  MAPPER_OBJ,
+                                                  MAPPER_INTF,
+                                                  "GetSubTree");
 
-    mapperCall.append(serviceRoot, depth, interfaces);
+            mapperCall.append(serviceRoot, depth, interfaces);
 
-    auto mapperReply = bus.call(mapperCall);
-    if (mapperReply.is_method_error())
-    {
-        log<level::ERR>("Error in mapper call");
-        elog<InternalFailure>();
-    }
+            auto mapperReply = bus.call(mapperCall);
+            if (mapperReply.is_method_error())
+            {
+                log<level::ERR>("Error in mapper call");
+                elog<InternalFailure>();
+            }
 
-    ObjectTree objectTree;
-    mapperReply.read(objectTree);
+            ObjectTree objectTree;
+            mapperReply.read(objectTree);
+            return objectTree;
+        });
 
     if (objectTree.empty())
     {
@@ -250,6 +259,618 @@ void setDbusProperty(sdbusplus::bus::bus& bus,
 }
 
 
+/** @brief Returns whether path is root or below it */
+static bool within(const std::string& root, const std::string& path)
+{
+    return path.compare(0, root.size(), root) == 0 &&
+           (root == ROOT || path.size() == root.size() ||
+            path[root.size()] == '/');
+}
+
+constexpr std::chrono::seconds MapperCache::settleTime;
+
+MapperCache& MapperCache::instance()
+{
+    static MapperCache cache;
+    return cache;
+}
+
+void MapperCache::watch(sdbusplus::bus::bus& bus)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    if (watching)
+    {
+        return;
+    }
+
+    constexpr auto objMgrIntf = "org.freedesktop.DBus.ObjectManager";
+    for (auto member : {"InterfacesAdded", "InterfacesRemoved"})
+    {
+        matches.push_back(std::make_unique<sdbusplus::bus::match_t>(
+            bus,
+            sdbusRule::type::signal() +
+            sdbusRule::interface(objMgrIntf) +
+            sdbusRule::member(member),
+            interfacesChanged, this));
+    }
+    matches.push_back(std::make_unique<sdbusplus::bus::match_t>(
+        bus, sdbusRule::nameOwnerChanged(), nameOwnerChanged, this));
+    watching = true;
+}
+
+ObjectTree MapperCache::lookup(Method method, const std::string& path,
+                               const InterfaceList& interfaces,
+                               const std::function<ObjectTree()>& fetch)
+{
+    // The mapper doesn't care about the order of the interfaces
+    auto sorted = interfaces;
+    std::sort(sorted.begin(), sorted.end());
+    Key key{method, path, std::move(sorted)};
+
+    uint64_t since;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto found = entries.find(key);
+        if (found != entries.end())
+        {
+            hitCount++;
+            return found->second;
+        }
+        missCount++;
+        since = generation;
+    }
+
+    // Not locked during the call, other threads may look up meanwhile
+    auto answer = fetch();
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (watching && generation == since && entries.size() < maxEntries &&
+        std::chrono::steady_clock::now() >= settled)
+    {
+        entries.emplace(std::move(key), answer);
+    }
+    return answer;
+}
+
+void MapperCache::invalidate(const std::string& path)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    drop(path, {});
+}
+
+void MapperCache::drop(const std::string& path,
+                       const InterfaceList& interfaces)
+{
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        const auto& keyPath = std::get<std::string>(it->first);
+        const auto& filter = std::get<InterfaceList>(it->first);
+
+        bool covered = false;
+        switch (std::get<Method>(it->first))
+        {
+            case Method::getObject:
+                covered = (keyPath == path);
+                break;
+            case Method::getSubTree:
+                covered = within(keyPath, path);
+                break;
+            case Method::getAncestors:
+                covered = (keyPath != path && within(path, keyPath));
+                break;
+        }
+
+        // An answer filtered on interfaces only changes with those
+        if (covered && !interfaces.empty() && !filter.empty())
+        {
+            covered = std::any_of(interfaces.begin(), interfaces.end(),
+                                  [&filter](const std::string& interface)
+                                  {
+                                      return std::binary_search(
+                                                 filter.begin(), filter.end(),
+                                                 interface);
+                                  });
+        }
+
+        if (covered)
+        {
+            it = entries.erase(it);
+            droppedCount++;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // Answers being fetched may predate the change
+    generation++;
+}
+
+int MapperCache::interfacesChanged(sd_bus_message* m, void* userdata,
+                                   sd_bus_error* error)
+{
+    auto cache = static_cast<MapperCache*>(userdata);
+    bool added = strcmp(sd_bus_message_get_member(m), "InterfacesAdded") == 0;
+    const char* path = nullptr;
+    InterfaceList interfaces;
+
+    // Only the interface names are read, not the properties that come with
+    // them
+    int r = sd_bus_message_read(m, "o", &path);
+    if (r >= 0)
+    {
+        r = sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY,
+                                           added ? "{sa{sv}}" : "s");
+    }
+    while (r > 0)
+    {
+        const char* interface = nullptr;
+        if (added)
+        {
+            r = sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                               "sa{sv}");
+            if (r <= 0)
+            {
+                break;
+            }
+            r = sd_bus_message_read(m, "s", &interface);
+            if (r >= 0)
+            {
+                r = sd_bus_message_skip(m, "a{sv}");
+            }
+            if (r >= 0)
+            {
+                r = sd_bus_message_exit_container(m);
+            }
+        }
+        else
+        {
+            r = sd_bus_message_read(m, "s", &interface);
+        }
+        if (r > 0)
+        {
+            interfaces.emplace_back(interface);
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(cache->lock);
+
+    // The mapper handles the same signal, until it has an answer fetched
+    // now may still be the old one
+    cache->settled = std::chrono::steady_clock::now() + settleTime;
+    if (r < 0 || path == nullptr)
+    {
+        // Can't tell what changed
+        cache->droppedCount += cache->entries.size();
+        cache->entries.clear();
+        cache->generation++;
+        return 0;
+    }
+    cache->drop(path, interfaces);
+    return 0;
+}
+
+int MapperCache::nameOwnerChanged(sd_bus_message* m, void* userdata,
+                                  sd_bus_error* error)
+{
+    auto cache = static_cast<MapperCache*>(userdata);
+    const char *name, *oldOwner, *newOwner;
+    if (sd_bus_message_read(m, "sss", &name, &oldOwner, &newOwner) < 0)
+    {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> guard(cache->lock);
+    if (name[0] != ':' && newOwner[0] != '\0')
+    {
+        // A service appeared or changed hands, what it provides is only
+        // known once the mapper has introspected it
+        cache->droppedCount += cache->entries.size();
+        cache->entries.clear();
+        cache->generation++;
+        cache->settled = std::chrono::steady_clock::now() + settleTime;
+        return 0;
+    }
+    if (oldOwner[0] == '\0')
+    {
+        // A new connection, it has no objects yet
+        return 0;
+    }
+
+    // Gone, drop the answers naming it
+    for (auto it = cache->entries.begin(); it != cache->entries.end();)
+    {
+        bool names = std::any_of(
+            it->second.begin(), it->second.end(),
+            [name](const ObjectTree::value_type& object)
+            {
+                return object.second.find(name) != object.second.end();
+            });
+        if (names)
+        {
+            it = cache->entries.erase(it);
+            cache->droppedCount++;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    cache->generation++;
+    return 0;
+}
+
+ManagedObjects& ManagedObjects::instance()
+{
+    static ManagedObjects managed;
+    return managed;
+}
+
+void ManagedObjects::watch(sdbusplus::bus::bus& bus)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    watched = &bus;
+}
+
+bool ManagedObjects::read(
+    sdbusplus::bus::bus& bus, const std::string& service,
+    const std::string& root,
+    const std::function<void(const ObjectValueTree&)>& read)
+{
+    Key key{service, root};
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (watched == nullptr)
+        {
+            return false;
+        }
+        bool eventLoop = bus.get() == watched->get();
+        if (eventLoop)
+        {
+            // No match callback runs meanwhile on the event loop thread
+            retired.clear();
+        }
+
+        auto found = snapshots.find(key);
+        if (found != snapshots.end())
+        {
+            if (found->second.unmanaged)
+            {
+                return false;
+            }
+            hitCount++;
+            read(found->second.objects);
+            return true;
+        }
+        missCount++;
+        // The matches of a snapshot can only be added from the thread
+        // dispatching the watched bus, worker threads read the objects
+        if (!eventLoop || snapshots.size() >= maxSnapshots)
+        {
+            return false;
+        }
+    }
+
+    // Not locked during the calls. Signals are only dispatched by this
+    // thread, once the snapshot is in place.
+    std::string owner = service;
+    if (service[0] != ':')
+    {
+        auto method = bus.new_method_call("org.freedesktop.DBus",
+                                          "/org/freedesktop/DBus",
+                                          "org.freedesktop.DBus",
+                                          "GetNameOwner");
+        method.append(service);
+        auto reply = bus.call(method);
+        if (reply.is_method_error())
+        {
+            return false;
+        }
+        reply.read(owner);
+    }
+
+    // Subscribed to before the snapshot is taken, so that no change after
+    // it is missed
+    Snapshot snapshot;
+    snapshot.owner = owner;
+    snapshot.matches.push_back(std::make_unique<sdbusplus::bus::match_t>(
+        bus,
+        sdbusRule::nameOwnerChanged() + sdbusRule::argN(0, service),
+        std::bind(&ManagedObjects::nameOwnerChanged, this, key,
+                  std::placeholders::_1)));
+    snapshot.matches.push_back(std::make_unique<sdbusplus::bus::match_t>(
+        bus,
+        sdbusRule::interfacesAdded(root) + sdbusRule::sender(owner),
+        std::bind(&ManagedObjects::interfacesAdded, this, key,
+                  std::placeholders::_1)));
+    snapshot.matches.push_back(std::make_unique<sdbusplus::bus::match_t>(
+        bus,
+        sdbusRule::interfacesRemoved(root) + sdbusRule::sender(owner),
+        std::bind(&ManagedObjects::interfacesRemoved, this, key,
+                  std::placeholders::_1)));
+    snapshot.matches.push_back(std::make_unique<sdbusplus::bus::match_t>(
+        bus,
+        sdbusRule::type::signal() +
+        sdbusRule::member("PropertiesChanged") +
+        sdbusRule::interface(PROP_INTF) +
+        sdbusRule::sender(owner) +
+        sdbusRule::path_namespace(root),
+        std::bind(&ManagedObjects::propertiesChanged, this, key,
+                  std::placeholders::_1)));
+
+    auto method = bus.new_method_call(service.c_str(),
+                                      root.c_str(),
+                                      "org.freedesktop.DBus.ObjectManager",
+                                      "GetManagedObjects");
+    auto reply = bus.call(method);
+    bool managed = !reply.is_method_error();
+    if (managed)
+    {
+        reply.read(snapshot.objects);
+    }
+    else
+    {
+        log<level::INFO>("No object manager, reading the objects",
+                         entry("SERVICE=%s", service.c_str()),
+                         entry("PATH=%s", root.c_str()));
+        // Only kept until the service goes away
+        snapshot.unmanaged = true;
+        snapshot.matches.resize(1);
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    auto& kept = snapshots[key];
+    kept = std::move(snapshot);
+    if (!managed)
+    {
+        return false;
+    }
+    read(kept.objects);
+    return true;
+}
+
+ObjectValueTree ManagedObjects::objects(sdbusplus::bus::bus& bus,
+                                        const std::string& service,
+                                        const std::string& root,
+                                        const std::string& interface,
+                                        const std::string& subtree)
+{
+    ObjectValueTree found;
+    auto filter = [&](const ObjectValueTree& objects)
+    {
+        for (const auto& object : objects)
+        {
+            if ((subtree.empty() || within(subtree, object.first.str)) &&
+                (interface.empty() ||
+                 object.second.find(interface) != object.second.end()))
+            {
+                found.emplace(object);
+            }
+        }
+    };
+
+    if (!read(bus, service, root, filter))
+    {
+        filter(getManagedObjects(bus, service, root));
+    }
+    return found;
+}
+
+PropertyMap ManagedObjects::properties(sdbusplus::bus::bus& bus,
+                                       const std::string& service,
+                                       const std::string& root,
+                                       const std::string& objPath,
+                                       const std::string& interface)
+{
+    PropertyMap properties;
+    bool found = false;
+    auto get = [&](const ObjectValueTree& objects)
+    {
+        auto object = objects.find(objPath);
+        if (object != objects.end())
+        {
+            auto iface = object->second.find(interface);
+            if (iface != object->second.end())
+            {
+                properties = iface->second;
+                found = true;
+            }
+        }
+    };
+
+    // An object missing from the snapshot is asked, for the error it gives
+    if (within(root, objPath) && read(bus, service, root, get) && found)
+    {
+        return properties;
+    }
+    return getAllDbusProperties(bus, service, objPath, interface);
+}
+
+Value ManagedObjects::property(sdbusplus::bus::bus& bus,
+                               const std::string& service,
+                               const std::string& root,
+                               const std::string& objPath,
+                               const std::string& interface,
+                               const std::string& property)
+{
+    Value value;
+    bool found = false;
+    auto get = [&](const ObjectValueTree& objects)
+    {
+        auto object = objects.find(objPath);
+        if (object == objects.end())
+        {
+            return;
+        }
+        auto iface = object->second.find(interface);
+        if (iface == object->second.end())
+        {
+            return;
+        }
+        auto prop = iface->second.find(property);
+        if (prop != iface->second.end())
+        {
+            value = prop->second;
+            found = true;
+        }
+    };
+
+    if (within(root, objPath) && read(bus, service, root, get) && found)
+    {
+        return value;
+    }
+    return getDbusProperty(bus, service, objPath, interface, property);
+}
+
+void ManagedObjects::drop(const Key& key)
+{
+    auto found = snapshots.find(key);
+    if (found == snapshots.end())
+    {
+        return;
+    }
+    // Called from the callback of one of the matches, they are destroyed
+    // later
+    for (auto& match : found->second.matches)
+    {
+        retired.push_back(std::move(match));
+    }
+    snapshots.erase(found);
+    droppedCount++;
+}
+
+void ManagedObjects::interfacesAdded(const Key& key,
+                                     sdbusplus::message::message& msg)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    auto found = snapshots.find(key);
+    if (found == snapshots.end())
+    {
+        return;
+    }
+
+    sdbusplus::message::object_path path;
+    DbusInterfaceMap interfaces;
+    try
+    {
+        msg.read(path, interfaces);
+    }
+    catch (const std::exception& e)
+    {
+        // Can't tell what was added
+        drop(key);
+        return;
+    }
+
+    auto& object = found->second.objects[path];
+    for (const auto& interface : interfaces)
+    {
+        object[interface.first] = interface.second;
+    }
+}
+
+void ManagedObjects::interfacesRemoved(const Key& key,
+                                       sdbusplus::message::message& msg)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    auto found = snapshots.find(key);
+    if (found == snapshots.end())
+    {
+        return;
+    }
+
+    sdbusplus::message::object_path path;
+    std::vector<DbusInterface> interfaces;
+    try
+    {
+        msg.read(path, interfaces);
+    }
+    catch (const std::exception& e)
+    {
+        drop(key);
+        return;
+    }
+
+    auto& objects = found->second.objects;
+    auto object = objects.find(path);
+    if (object == objects.end())
+    {
+        return;
+    }
+    for (const auto& interface : interfaces)
+    {
+        object->second.erase(interface);
+    }
+    if (object->second.empty())
+    {
+        objects.erase(object);
+    }
+}
+
+void ManagedObjects::propertiesChanged(const Key& key,
+                                       sdbusplus::message::message& msg)
+{
+    std::string path = msg.get_path();
+    std::lock_guard<std::mutex> guard(lock);
+    auto found = snapshots.find(key);
+    if (found == snapshots.end())
+    {
+        return;
+    }
+
+    DbusInterface interface;
+    PropertyMap changed;
+    std::vector<DbusProperty> invalidated;
+    try
+    {
+        msg.read(interface, changed, invalidated);
+    }
+    catch (const std::exception& e)
+    {
+        drop(key);
+        return;
+    }
+
+    // Invalidated properties are only known by asking, the snapshot is
+    // taken again instead
+    if (!invalidated.empty())
+    {
+        drop(key);
+        return;
+    }
+
+    // An interface not added yet comes with InterfacesAdded
+    auto object = found->second.objects.find(path);
+    if (object != found->second.objects.end())
+    {
+        auto iface = object->second.find(interface);
+        if (iface != object->second.end())
+        {
+            for (const auto& property : changed)
+            {
+                iface->second[property.first] = property.second;
+            }
+        }
+    }
+}
+
+void ManagedObjects::nameOwnerChanged(const Key& key,
+                                      sdbusplus::message::message& msg)
+{
+    std::string name, oldOwner, newOwner;
+    msg.read(name, oldOwner, newOwner);
+    if (oldOwner.empty())
+    {
+        // The name was just acquired, no snapshot was taken from it
+        return;
+    }
+
+    // The service went away, or its well-known name changed hands
+    std::lock_guard<std::mutex> guard(lock);
+    drop(key);
+}
+
 ServiceCache::ServiceCache(const std::string& intf, const std::string& path)
     : intf(intf), path(path), cachedService(std::experimental::nullopt),
       cachedBusName(std::experimental::nullopt)
@@ -277,6 +898,7 @@ void ServiceCache::invalidate()
 {
     cachedBusName = std::experimental::nullopt;
     cachedService = std::experimental::nullopt;
+    MapperCache::instance().invalidate(path);
 }
 
 sdbusplus::message::message ServiceCache::newMethodCall(
@@ -295,30 +917,39 @@ std::string getService(sdbusplus::bus::bus& bus,
                        const std::string& intf,
                        const std::string& path)
 {
-    auto mapperCall = bus.new_method_call("xyz.openbmc_project.ObjectMapper",
-                                          "/xyz/openbmc_project/object_mapper",
-                                          "xyz.openbmc_project.ObjectMapper",
-                                          "GetObject");
+    auto object = MapperCache::instance().lookup(
+        MapperCache::Method::getObject, path, {intf},
+        [&]()
+        {
+            auto mapperCall = bus.new_method_call(
+                                  "xyz.openbmc_project.ObjectMapper",
+                                  "/xyz/openbmc_project/object_mapper",
+                                  "xyz.openbmc_project.ObjectMapper",
+                                  "GetObject");
 
-    mapperCall.append(path);
-    mapperCall.append(std::vector<std::string>({intf}));
+            mapperCall.append(path);
+            mapperCall.append(std::vector<std::string>({intf}));
 
-    auto mapperResponseMsg = bus.call(mapperCall);
+            auto mapperResponseMsg = bus.call(mapperCall);
 
-    if (mapperResponseMsg.is_method_error())
-    {
-        throw std::runtime_error("ERROR in mapper call");
-    }
+            if (mapperResponseMsg.is_method_error())
+            {
+                throw std::runtime_error("ERROR in mapper call");
+            }
 
-    std::map<std::string, std::vector<std::string>> mapperResponse;
-    mapperResponseMsg.read(mapperResponse);
+            std::map<std::string, std::vector<std::string>> mapperResponse;
+            mapperResponseMsg.read(mapperResponse);
 
-    if (mapperResponse.begin() == mapperResponse.end())
-    {
-        throw std::runtime_error("ERROR in reading the mapper response");
-    }
+            if (mapperResponse.begin() == mapperResponse.end())
+            {
+                throw std::runtime_error(
+                    "ERROR in reading the mapper response");
+            }
+
+            return ObjectTree{{path, std::move(mapperResponse)}};
+        });
 
-    return mapperResponse.begin()->first;
+    return object.begin()->second.begin()->first;
 }
 
 ipmi::ObjectTree getAllDbusObjects(sdbusplus::bus::bus& bus,
@@ -329,27 +960,33 @@ ipmi::ObjectTree getAllDbusObjects(sdbusplus::bus::bus& bus,
     std::vector<std::string> interfaces;
     interfaces.emplace_back(interface);
 
-    auto depth = 0;
+    auto objectTree = MapperCache::instance().lookup(
+        MapperCache::Method::getSubTree, serviceRoot, interfaces,
+        [&]()
+        {
+            auto depth = 0;
 
-    auto mapperCall = bus.new_method_call(MAPPER_BUS_NAME,
-                                          MAPPER_OBJ,
-                                          MAPPER_INTF,
-                                          "GetSubTree");
+            auto mapperCall = bus.new_method_call(MAPPER_BUS_NAME,
+                                                  MAPPER_OBJ,
+                                                  MAPPER_INTF,
+                                                  "GetSubTree");
 
-    mapperCall.append(serviceRoot, depth, interfaces);
+            mapperCall.append(serviceRoot, depth, interfaces);
 
-    auto mapperReply = bus.call(mapperCall);
-    if (mapperReply.is_method_error())
-    {
-        log<level::ERR>("Error in mapper call",
-                        entry("SERVICEROOT=%s",serviceRoot.c_str()),
-                        entry("INTERFACE=%s", interface.c_str()));
+            auto mapperReply = bus.call(mapperCall);
+            if (mapperReply.is_method_error())
+            {
+                log<level::ERR>("Error in mapper call",
+                                entry("SERVICEROOT=%s",serviceRoot.c_str()),
+                                entry("INTERFACE=%s", interface.c_str()));
 
-        elog<InternalFailure>();
-    }
+                elog<InternalFailure>();
+            }
 
-    ObjectTree objectTree;
-    mapperReply.read(objectTree);
+            ObjectTree objectTree;
+            mapperReply.read(objectTree);
+            return objectTree;
+        });
 
     for (auto it = objectTree.begin(); it != objectTree.end();)
     {
@@ -405,25 +1042,31 @@ ObjectTree getAllAncestors(sdbusplus::bus::bus& bus,
         return intfStr;
     };
 
-    auto mapperCall = bus.new_method_call(MAPPER_BUS_NAME,
-                                          MAPPER_OBJ,
-                                          MAPPER_INTF,
-                                          "GetAncestors");
-    mapperCall.append(path, interfaces);
-
-    auto mapperReply = bus.call(mapperCall);
-    if (mapperReply.is_method_error())
-    {
-        log<level::ERR>("Error in mapper call",
-                        entry("PATH=%s", path.c_str()),
-                        entry("INTERFACES=%s",
-                              convertToString(interfaces).c_str()));
-
-        elog<InternalFailure>();
-    }
-
-    ObjectTree objectTree;
-    mapperReply.read(objectTree);
+    auto objectTree = MapperCache::instance().lookup(
+        MapperCache::Method::getAncestors, path, interfaces,
+        [&]()
+        {
+            auto mapperCall = bus.new_method_call(MAPPER_BUS_NAME,
+                                                  MAPPER_OBJ,
+                                                  MAPPER_INTF,
+                                                  "GetAncestors");
+            mapperCall.append(path, interfaces);
+
+            auto mapperReply = bus.call(mapperCall);
+            if (mapperReply.is_method_error())
+            {
+                log<level::ERR>("Error in mapper call",
+                                entry("PATH=%s", path.c_str()),
+                                entry("INTERFACES=%s",
+                                      convertToString(interfaces).c_str()));
+
+                elog<InternalFailure>();
+            }
+
+            ObjectTree objectTree;
+            mapperReply.read(objectTree);
+            return objectTree;
+        });
 
     if (objectTree.empty())
     {
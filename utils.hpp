@@ -1,5 +1,12 @@
 #pragma once
+#include <atomic>
+#include <chrono>
 #include <experimental/optional>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <sdbusplus/bus/match.hpp>
 #include <sdbusplus/server.hpp>
 
 #include "types.hpp"
@@ -21,13 +28,273 @@ constexpr auto METHOD_GET = "Get";
 constexpr auto METHOD_GET_ALL = "GetAll";
 constexpr auto METHOD_SET = "Set";
 
+/** @class MapperCache
+ *  @brief Answers of the object mapper, shared by ipmid and the providers.
+ *
+ *  @details GetObject and GetAncestors answers are kept per object path and
+ *           interface set, GetSubTree ones per subtree root and interface
+ *           set. Once watch() has subscribed to the signals telling the
+ *           mapper's view changed, entries are dropped precisely: when an
+ *           object they cover gains or loses one of their interfaces
+ *           (InterfacesAdded, InterfacesRemoved), or when a service they
+ *           name goes away (NameOwnerChanged). A new well-known name drops
+ *           everything, as the services it provides aren't known yet.
+ *           Nothing is kept for settleTime after any of these signals, the
+ *           mapper handles them too and may answer from its old view until
+ *           it has. Until watch() is called nothing is kept at all.
+ *
+ *           Lookups may be made from worker threads, so the cache is
+ *           locked, and an answer fetched while entries were dropped isn't
+ *           kept. utils.cpp is built into ipmid and the providers alike,
+ *           ipmid's instance() is the one they all resolve to.
+ */
+class MapperCache
+{
+    public:
+        /** @brief Upper bound on the number of answers kept */
+        static constexpr size_t maxEntries = 512;
+
+        /** @brief How long answers aren't kept after the mapper's view
+         *         changed */
+        static constexpr std::chrono::seconds settleTime{2};
+
+        /** @brief Mapper method an answer comes from */
+        enum class Method
+        {
+            getObject,
+            getSubTree,
+            getAncestors,
+        };
+
+        /** @brief Returns the cache of the process */
+        static MapperCache& instance();
+
+        /** @brief Subscribes to the signals keeping the cache current, on a
+         *         bus dispatched by the event loop
+         *
+         *  @param[in] bus - DBUS Bus Object
+         */
+        void watch(sdbusplus::bus::bus& bus);
+
+        /** @brief Returns the kept answer to a mapper call, or makes the call
+         *
+         *  @param[in] method - mapper method called
+         *  @param[in] path - object path, or subtree root for GetSubTree
+         *  @param[in] interfaces - interfaces the call filters on
+         *  @param[in] fetch - makes the call, throws when it fails. A
+         *                     GetObject answer is returned as the object
+         *                     mapped to its services.
+         *
+         *  @return the answer
+         */
+        ObjectTree lookup(Method method, const std::string& path,
+                          const InterfaceList& interfaces,
+                          const std::function<ObjectTree()>& fetch);
+
+        /** @brief Drops the answers covering an object, for callers that
+         *         found the service they were given is gone
+         *
+         *  @param[in] path - object path
+         */
+        void invalidate(const std::string& path);
+
+        inline uint64_t hits() const
+        {
+            return hitCount;
+        }
+
+        inline uint64_t misses() const
+        {
+            return missCount;
+        }
+
+        /** @brief Returns the number of answers dropped */
+        inline uint64_t dropped() const
+        {
+            return droppedCount;
+        }
+
+    private:
+        using Key = std::tuple<Method, std::string, InterfaceList>;
+
+        /** @brief Drops the answers an object's interfaces changing affects,
+         *         all interfaces if none are given. Called locked.
+         */
+        void drop(const std::string& path, const InterfaceList& interfaces);
+
+        static int interfacesChanged(sd_bus_message* m, void* userdata,
+                                     sd_bus_error* error);
+        static int nameOwnerChanged(sd_bus_message* m, void* userdata,
+                                    sd_bus_error* error);
+
+        std::mutex lock;
+        std::map<Key, ObjectTree> entries;
+        std::vector<std::unique_ptr<sdbusplus::bus::match_t>> matches;
+        bool watching = false;
+        std::chrono::steady_clock::time_point settled;
+        uint64_t generation = 0;
+        std::atomic<uint64_t> hitCount{0};
+        std::atomic<uint64_t> missCount{0};
+        std::atomic<uint64_t> droppedCount{0};
+};
+
+/** @class ManagedObjects
+ *  @brief Snapshots of the objects services manage, read instead of calling
+ *         GetAll on each object.
+ *
+ *  @details A snapshot is the GetManagedObjects answer of the ObjectManager
+ *           of a service, taken the first time an object below it is read.
+ *           Each snapshot subscribes to the InterfacesAdded,
+ *           InterfacesRemoved and PropertiesChanged signals its service
+ *           sends below its ObjectManager, which keep it current, and to the
+ *           NameOwnerChanged signal of the service, which drops it. Signals
+ *           of other services or paths don't wake ipmid. Until watch() is
+ *           called, reads go to the objects.
+ *
+ *           Snapshots are only taken on the thread dispatching the watched
+ *           bus, where their matches can be added. Worker threads read the
+ *           snapshots taken, under a lock, and the objects otherwise.
+ */
+class ManagedObjects
+{
+    public:
+        /** @brief Upper bound on the number of snapshots kept */
+        static constexpr size_t maxSnapshots = 16;
+
+        /** @brief Returns the snapshots of the process */
+        static ManagedObjects& instance();
+
+        /** @brief Starts taking snapshots, their matches are added to a
+         *         bus dispatched by the event loop
+         *
+         *  @param[in] bus - DBUS Bus Object
+         */
+        void watch(sdbusplus::bus::bus& bus);
+
+        /** @brief Gets the objects of a service implementing an interface
+         *
+         *  @param[in] bus - DBUS Bus Object
+         *  @param[in] service - Dbus service name
+         *  @param[in] root - path of the service's ObjectManager
+         *  @param[in] interface - only objects implementing it, any if empty
+         *  @param[in] subtree - only objects at or below it, all if empty
+         *
+         *  @return the objects with their interfaces and properties
+         */
+        ObjectValueTree objects(sdbusplus::bus::bus& bus,
+                                const std::string& service,
+                                const std::string& root,
+                                const std::string& interface = {},
+                                const std::string& subtree = {});
+
+        /** @brief Gets all the properties of an object's interface, like
+         *         getAllDbusProperties() does.
+         *
+         *  @param[in] bus - DBUS Bus Object
+         *  @param[in] service - Dbus service name
+         *  @param[in] root - path of the service's ObjectManager
+         *  @param[in] objPath - Dbus object path, at or below root
+         *  @param[in] interface - Dbus interface
+         *
+         *  @return the map of name value pair
+         */
+        PropertyMap properties(sdbusplus::bus::bus& bus,
+                               const std::string& service,
+                               const std::string& root,
+                               const std::string& objPath,
+                               const std::string& interface);
+
+        /** @brief Gets a property of an object's interface, like
+         *         getDbusProperty() does.
+         *
+         *  @param[in] bus - DBUS Bus Object
+         *  @param[in] service - Dbus service name
+         *  @param[in] root - path of the service's ObjectManager
+         *  @param[in] objPath - Dbus object path, at or below root
+         *  @param[in] interface - Dbus interface
+         *  @param[in] property - name of the property
+         *
+         *  @return the value of the property
+         */
+        Value property(sdbusplus::bus::bus& bus,
+                       const std::string& service,
+                       const std::string& root,
+                       const std::string& objPath,
+                       const std::string& interface,
+                       const std::string& property);
+
+        inline uint64_t hits() const
+        {
+            return hitCount;
+        }
+
+        inline uint64_t misses() const
+        {
+            return missCount;
+        }
+
+        /** @brief Returns the number of snapshots dropped */
+        inline uint64_t dropped() const
+        {
+            return droppedCount;
+        }
+
+    private:
+        /** @brief Keyed by service name and ObjectManager path */
+        using Key = std::pair<std::string, std::string>;
+
+        struct Snapshot
+        {
+            //!< Unique name of the service when the snapshot was taken
+            std::string owner;
+            ObjectValueTree objects;
+            //!< The service has no ObjectManager there, read the objects
+            bool unmanaged = false;
+            //!< The signals keeping it current
+            std::vector<std::unique_ptr<sdbusplus::bus::match_t>> matches;
+        };
+
+        /** @brief Calls read with the snapshot, taking it if need be
+         *
+         *  @return false if there is no snapshot to read, and the objects
+         *          must be read instead
+         */
+        bool read(sdbusplus::bus::bus& bus, const std::string& service,
+                  const std::string& root,
+                  const std::function<void(const ObjectValueTree&)>& read);
+
+        /** @brief Drops a snapshot. Called locked, from the callbacks of
+         *         its matches.
+         */
+        void drop(const Key& key);
+
+        void interfacesAdded(const Key& key,
+                             sdbusplus::message::message& msg);
+        void interfacesRemoved(const Key& key,
+                               sdbusplus::message::message& msg);
+        void propertiesChanged(const Key& key,
+                               sdbusplus::message::message& msg);
+        void nameOwnerChanged(const Key& key,
+                              sdbusplus::message::message& msg);
+
+        std::mutex lock;
+        std::map<Key, Snapshot> snapshots;
+        //!< Bus the matches are added to, set by watch()
+        sdbusplus::bus::bus* watched = nullptr;
+        //!< Matches of dropped snapshots, destroyed outside their callbacks
+        std::vector<std::unique_ptr<sdbusplus::bus::match_t>> retired;
+        std::atomic<uint64_t> hitCount{0};
+        std::atomic<uint64_t> missCount{0};
+        std::atomic<uint64_t> droppedCount{0};
+};
+
 /** @class ServiceCache
  *  @brief Caches lookups of service names from the object mapper.
  *  @details Most ipmi commands need to talk to other dbus daemons to perform
  *           their intended actions on the BMC. This usually means they will
  *           first look up the service name providing the interface they
- *           require. This class reduces the number of such calls by caching
- *           the lookup for a specific service.
+ *           require. This class keeps the service of a specific object at
+ *           hand, on top of the MapperCache the lookups go through.
  */
 class ServiceCache {
     public:
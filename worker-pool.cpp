@@ -0,0 +1,183 @@
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <system_error>
+#include "worker-pool.hpp"
+
+namespace phosphor
+{
+namespace ipmi
+{
+
+WorkerPool::WorkerPool(size_t threads, size_t maxQueued,
+                       ThreadHook threadInit, ThreadHook threadExit) :
+    maxQueued(maxQueued),
+    threadInit(threadInit),
+    threadExit(threadExit),
+    maxBulkRunning(threads > 1 ? threads - 1 : threads)
+{
+    completionFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (completionFd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "Creating the completion eventfd failed");
+    }
+
+    for (size_t i = 0; i < threads; i++)
+    {
+        workers.emplace_back(&WorkerPool::run, this);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        stopping = true;
+    }
+    jobsCond.notify_all();
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    close(completionFd);
+}
+
+bool WorkerPool::submit(Work&& work, Completion&& completion,
+                        Priority priority)
+{
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        // Critical jobs are queued even when the queue is full of others,
+        // up to maxQueued of their own
+        auto& queue = jobs[static_cast<size_t>(priority)];
+        if ((priority == Priority::critical) ? queue.size() >= maxQueued :
+                                               jobCount >= maxQueued)
+        {
+            return false;
+        }
+        queue.push({std::move(work), std::move(completion)});
+        jobCount++;
+    }
+    // A worker woken for a bulk job may not be allowed to take it, wake
+    // them all so that one that may does.
+    jobsCond.notify_all();
+    return true;
+}
+
+size_t WorkerPool::runCompletions()
+{
+    // Reset the eventfd counter before draining, so a completion queued
+    // while draining signals the fd again.
+    uint64_t count;
+    while (read(completionFd, &count, sizeof(count)) < 0 && errno == EINTR)
+    {
+    }
+
+    std::queue<Completion> ready;
+    {
+        std::lock_guard<std::mutex> lock(completionsMutex);
+        std::swap(ready, completions);
+    }
+
+    auto ran = ready.size();
+    while (!ready.empty())
+    {
+        ready.front()();
+        ready.pop();
+    }
+    return ran;
+}
+
+size_t WorkerPool::queued()
+{
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    return jobCount;
+}
+
+std::queue<WorkerPool::Job>* WorkerPool::nextQueue()
+{
+    for (auto& queue : jobs)
+    {
+        if (queue.empty())
+        {
+            continue;
+        }
+        if (&queue == &jobs[static_cast<size_t>(Priority::bulk)] &&
+            bulkRunning >= maxBulkRunning)
+        {
+            break;
+        }
+        return &queue;
+    }
+    return nullptr;
+}
+
+void WorkerPool::run()
+{
+    if (threadInit)
+    {
+        threadInit();
+    }
+
+    for (;;)
+    {
+        Job job;
+        bool bulk = false;
+        {
+            std::unique_lock<std::mutex> lock(jobsMutex);
+            std::queue<Job>* queue = nullptr;
+            jobsCond.wait(lock, [this, &queue]
+            {
+                queue = nextQueue();
+                return queue != nullptr || (stopping && jobCount == 0);
+            });
+            if (queue == nullptr)
+            {
+                break;
+            }
+            job = std::move(queue->front());
+            queue->pop();
+            jobCount--;
+            bulk = (queue == &jobs[static_cast<size_t>(Priority::bulk)]);
+            if (bulk)
+            {
+                bulkRunning++;
+            }
+        }
+
+        job.work();
+        // Release whatever the work captured on this thread, so that the
+        // completion holds the last reference to any shared state.
+        job.work = nullptr;
+
+        if (bulk)
+        {
+            {
+                std::lock_guard<std::mutex> lock(jobsMutex);
+                bulkRunning--;
+            }
+            jobsCond.notify_all();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(completionsMutex);
+            completions.push(std::move(job.completion));
+        }
+
+        uint64_t one = 1;
+        while (write(completionFd, &one, sizeof(one)) < 0 && errno == EINTR)
+        {
+        }
+    }
+
+    if (threadExit)
+    {
+        threadExit();
+    }
+}
+
+} // namespace ipmi
+} // namespace phosphor
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace phosphor
+{
+namespace ipmi
+{
+
+/** @brief Scheduling class of a job or a request, most urgent first */
+enum class Priority
+{
+    critical,
+    normal,
+    bulk,
+};
+
+/** @class WorkerPool
+ *  @brief Runs jobs on a fixed set of worker threads and hands their
+ *         completions back to the thread that owns the event loop.
+ *
+ *  @details A job is split in two: the work, which runs on a worker thread,
+ *           and the completion, which is queued once the work is done and
+ *           runs on whichever thread calls runCompletions(). The completion
+ *           fd becomes readable whenever completions are pending, so it can
+ *           be watched from an sd_event loop.
+ *
+ *           Workers take critical jobs first, then normal ones, then bulk
+ *           ones. With more than one worker, bulk jobs never occupy all of
+ *           them, so that one is left for more urgent jobs.
+ */
+class WorkerPool
+{
+    public:
+        using Work = std::function<void()>;
+        using Completion = std::function<void()>;
+        using ThreadHook = std::function<void()>;
+
+        WorkerPool() = delete;
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+        WorkerPool(WorkerPool&&) = delete;
+        WorkerPool& operator=(WorkerPool&&) = delete;
+
+        /** @brief Starts the worker threads
+         *
+         *  @param[in] threads - number of worker threads
+         *  @param[in] maxQueued - number of jobs that may be waiting for a
+         *                         worker before submit() refuses new ones
+         *  @param[in] threadInit - optional hook run on each worker thread
+         *                          before it takes its first job
+         *  @param[in] threadExit - optional hook run on each worker thread
+         *                          before it exits
+         *
+         *  @error std::system_error thrown if the completion fd can't be
+         *         created
+         */
+        WorkerPool(size_t threads, size_t maxQueued,
+                   ThreadHook threadInit = nullptr,
+                   ThreadHook threadExit = nullptr);
+
+        /** @brief Finishes the queued jobs and joins the worker threads.
+         *         Completions that have not been run are discarded.
+         */
+        ~WorkerPool();
+
+        /** @brief Queues a job for the worker threads
+         *
+         *  @param[in] work - runs on a worker thread
+         *  @param[in] completion - runs from runCompletions() once work is
+         *                          done
+         *  @param[in] priority - scheduling class of the job, critical jobs
+         *                        are queued even when the queue is full,
+         *                        as long as fewer than maxQueued critical
+         *                        ones are waiting
+         *
+         *  @return false if the job queue is full and the job was dropped
+         */
+        bool submit(Work&& work, Completion&& completion,
+                    Priority priority = Priority::normal);
+
+        /** @brief Runs all the completions that are pending.
+         *         Must be called from the thread owning the completion fd.
+         *
+         *  @return number of completions that were run
+         */
+        size_t runCompletions();
+
+        /** @brief Returns an fd that is readable while completions are
+         *         pending
+         */
+        inline int getCompletionFd() const
+        {
+            return completionFd;
+        }
+
+        /** @brief Returns the number of jobs waiting for a worker */
+        size_t queued();
+
+    private:
+        /** @brief Job as queued for the worker threads */
+        struct Job
+        {
+            Work work;
+            Completion completion;
+        };
+
+        /** @brief Worker thread main loop */
+        void run();
+
+        /** @brief Returns the queue of the most urgent job a worker may
+         *         take, nullptr if there is none. Called with jobsMutex held.
+         */
+        std::queue<Job>* nextQueue();
+
+        /** @brief Maximum number of jobs waiting for a worker */
+        const size_t maxQueued;
+
+        /** @brief Optional per worker thread hooks */
+        ThreadHook threadInit;
+        ThreadHook threadExit;
+
+        /** @brief Jobs waiting for a worker per Priority, the number of
+         *         them and of bulk jobs running, protected by jobsMutex
+         */
+        std::array<std::queue<Job>, 3> jobs;
+        size_t jobCount = 0;
+        size_t bulkRunning = 0;
+        size_t maxBulkRunning;
+        std::mutex jobsMutex;
+        std::condition_variable jobsCond;
+        bool stopping = false;
+
+        /** @brief Finished jobs, protected by completionsMutex */
+        std::queue<Completion> completions;
+        std::mutex completionsMutex;
+
+        /** @brief eventfd signalled when completions are queued */
+        int completionFd = -1;
+
+        /** @brief The worker threads */
+        std::vector<std::thread> workers;
+};
+
+} // namespace ipmi
+} // namespace phosphor